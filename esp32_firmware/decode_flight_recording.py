@@ -0,0 +1,129 @@
+"""Decode a flight recorder capture (GET /api/recorder/download) to CSV.
+
+    python decode_flight_recording.py capture.gfr [-o capture.csv]
+
+One row per control cycle, in physical units: time relative to the trigger
+record, IMU in m/s^2, deg/s and deg C, angles and PID terms in degrees,
+servo pulses in microseconds. The layout is FlightCaptureHeader followed by
+FlightRecords (src/Domain/FlightRecorder.h), little-endian.
+"""
+import argparse
+import csv
+import struct
+import sys
+
+HEADER = struct.Struct("<4sHHIIB3xIff")
+RECORD = struct.Struct("<IHBB3h3hh3h3h3h3h3h3h3H")
+MAGIC = b"GFR1"
+VERSION = 1
+TRIGGERS = ["manual", "error", "saturation"]
+AXES = ["yaw", "pitch", "roll"]
+
+FLAG_VALID = 0x01
+FLAG_AUTO = 0x02
+FLAG_OVERRUN = 0x04
+FLAG_TRIGGER = 0x08
+FLAG_SATURATED = 0x10
+
+
+def read_capture(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    if len(data) < HEADER.size:
+        raise ValueError("file is shorter than the header")
+    magic, version, record_size, count, trigger_index, cause, rate_hz, accel_lsb, gyro_lsb = \
+        HEADER.unpack_from(data, 0)
+    if magic != MAGIC:
+        raise ValueError(f"not a flight recorder capture (magic {magic!r})")
+    if version != VERSION or record_size != RECORD.size:
+        raise ValueError(f"unsupported capture version {version}, record size {record_size}")
+
+    available = (len(data) - HEADER.size) // RECORD.size
+    if available < count:
+        # The download stops early when the recorder is re-armed meanwhile
+        print(f"warning: {count} records announced, {available} present", file=sys.stderr)
+        count = available
+
+    header = {
+        "count": count,
+        "trigger_index": trigger_index,
+        "cause": TRIGGERS[cause] if cause < len(TRIGGERS) else str(cause),
+        "rate_hz": rate_hz,
+        "accel_lsb_per_g": accel_lsb,
+        "gyro_lsb_per_dps": gyro_lsb,
+    }
+    records = [RECORD.unpack_from(data, HEADER.size + i * RECORD.size) for i in range(count)]
+    return header, records
+
+
+def rows(header, records):
+    accel_scale = 9.80665 / header["accel_lsb_per_g"]
+    gyro_scale = 1.0 / header["gyro_lsb_per_dps"]
+    trigger = header["trigger_index"]
+    t0 = records[trigger][0] if trigger < len(records) else (records[0][0] if records else 0)
+
+    for r in records:
+        time_us, dt_us, samples, flags = r[0:4]
+        accel, gyro, temp = r[4:7], r[7:10], r[10]
+        attitude, setpoint = r[11:14], r[14:17]
+        p, i, d, ff = r[17:20], r[20:23], r[23:26], r[26:29]
+        servo = r[29:32]
+        row = {
+            # uint32 microseconds wrap; the signed difference stays right
+            "t_s": ((time_us - t0 + 2**31) % 2**32 - 2**31) / 1e6,
+            "dt_ms": dt_us / 1000.0,
+            "samples": samples,
+            "valid": int(bool(flags & FLAG_VALID)),
+            "auto": int(bool(flags & FLAG_AUTO)),
+            "overrun": int(bool(flags & FLAG_OVERRUN)),
+            "trigger": int(bool(flags & FLAG_TRIGGER)),
+            "temp_c": temp / 100.0,
+        }
+        for n, axis in enumerate("xyz"):
+            row[f"accel_{axis}"] = accel[n] * accel_scale
+        for n, axis in enumerate("xyz"):
+            row[f"gyro_{axis}_dps"] = gyro[n] * gyro_scale
+        for n, axis in enumerate(AXES):
+            row[f"{axis}_attitude"] = attitude[n] / 100.0
+            row[f"{axis}_setpoint"] = setpoint[n] / 100.0
+            row[f"{axis}_p"] = p[n] / 100.0
+            row[f"{axis}_i"] = i[n] / 100.0
+            row[f"{axis}_d"] = d[n] / 100.0
+            row[f"{axis}_ff"] = ff[n] / 100.0
+            row[f"{axis}_saturated"] = int(bool(flags & (FLAG_SATURATED << n)))
+            row[f"{axis}_servo_us"] = servo[n] / 4.0
+        yield row
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode a flight recorder capture to CSV")
+    parser.add_argument("capture", help="file saved from /api/recorder/download")
+    parser.add_argument("-o", "--output", help="CSV file to write (default: stdout)")
+    args = parser.parse_args()
+
+    try:
+        header, records = read_capture(args.capture)
+    except (OSError, ValueError) as e:
+        print(f"Error: {e}", file=sys.stderr)
+        return 1
+
+    seconds = len(records) / header["rate_hz"] if header["rate_hz"] else 0
+    print(f"{len(records)} records ({seconds:.2f} s at {header['rate_hz']} Hz), "
+          f"{header['cause']} trigger at record {header['trigger_index']}", file=sys.stderr)
+
+    out = open(args.output, "w", newline="") if args.output else sys.stdout
+    try:
+        writer = None
+        for row in rows(header, records):
+            if writer is None:
+                writer = csv.DictWriter(out, fieldnames=list(row.keys()))
+                writer.writeheader()
+            writer.writerow(row)
+    finally:
+        if args.output:
+            out.close()
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
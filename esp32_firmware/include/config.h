@@ -24,6 +24,32 @@
 // Pin order matches MPU6050 module: VCC(3V3), GND, SDA(GPIO10), SCL(GPIO11)
 #define MPU6050_SDA 10
 #define MPU6050_SCL 11
+#define MPU6050_INT 9          // Data-ready interrupt (-1 to poll the FIFO count instead)
+#define MPU6050_I2C_CLOCK 400000
+#define MPU6050_SAMPLE_RATE_DIV 0 // Output rate = 1 kHz / (1 + div) with the DLPF enabled
+#define MPU6050_DLPF_CFG 3     // 44 Hz accel / 42 Hz gyro bandwidth, ~4.9 ms delay
+#define MPU6050_RING_SIZE 32   // Raw frames buffered between control cycles
+
+// IMU calibration, applied to every sample before the estimator (see
+// ImuCorrector). Samples are judged still or moving in windows; the first
+// still windows after boot set the gyro bias, later ones track it. Accel
+// offset/scale and a gyro temperature polynomial come from config ("imu").
+#define IMU_REST_WINDOW_S 0.5f
+#define IMU_REST_GYRO_STD_RAD_S 0.01f    // ~0.6 deg/s; IMU noise is ~0.0015
+#define IMU_REST_ACCEL_STD_MS2 0.2f
+#define IMU_REST_GRAVITY_TOL_MS2 0.8f    // Mean accel norm vs 1 g; loose enough for an uncalibrated accel
+#define IMU_BOOT_BIAS_WINDOWS 2          // Still windows averaged at boot
+#define IMU_BOOT_TIMEOUT_S 3.0f          // Stabilization waits at most this long for them
+#define IMU_BIAS_TRACK_TAU_S 20.0f       // Bias tracking time constant at rest after boot
+#define IMU_BIAS_MAX_STEP_RAD_S 0.005f   // Still windows further from the bias are ignored
+#define IMU_TEMP_BIN_MIN_C 10.0f         // Temperature bins for the polynomial fit: 16 x 3 C
+#define IMU_TEMP_BIN_WIDTH_C 3.0f
+#define IMU_TEMP_FIT_MIN_WINDOWS 4       // Still windows a bin needs to take part in the fit
+#define IMU_TEMP_FIT_MIN_SPAN_C 5.0f
+#define IMU_ACCEL_MAX_OFFSET_MS2 2.0f    // Accepted calibration range
+#define IMU_ACCEL_MIN_SCALE 0.8f
+#define IMU_ACCEL_MAX_SCALE 1.25f
+#define IMU_GYRO_MAX_BIAS_RAD_S 0.5f     // Polynomial value anywhere in its range
 
 // RGB LED Configuration (ESP32-S3-N16R8 onboard LED)
 #define RGB_LED_PIN 48
@@ -39,19 +65,218 @@
 #define SERVO_MAX_ANGLE 180
 #define SERVO_CENTER 90
 
+// Servo pulse output on LEDC. S3 timers are at most 14 bits wide: a duty step
+// is 1.2 us at 50 Hz and 0.18 us at 333 Hz (about 0.1 / 0.02 deg)
+#define SERVO_LEDC_CHANNEL_BASE 0     // Channels BASE..BASE+2 = yaw, pitch, roll
+#define SERVO_LEDC_RESOLUTION_BITS 14
+#define SERVO_REFRESH_HZ 50           // Default; analog servos need 50 Hz
+#define SERVO_MIN_REFRESH_HZ 50
+#define SERVO_MAX_REFRESH_HZ 333      // Digital servos only
+#define SERVO_PULSE_MIN_US 500        // Default pulse at SERVO_MIN_ANGLE
+#define SERVO_PULSE_MAX_US 2500       // Default pulse at SERVO_MAX_ANGLE
+#define SERVO_PULSE_LIMIT_MIN_US 400  // Accepted endpoint/calibration range, also bounds raw jogging
+#define SERVO_PULSE_LIMIT_MAX_US 2600
+#define SERVO_PULSE_MIN_SPAN_US 500   // Endpoints closer than this are rejected
+
+// Guided servo calibration: points captured per servo, spread evenly over
+// SERVO_MIN_ANGLE..SERVO_MAX_ANGLE (at most ServoCalibration::MAX_POINTS)
+#define SERVO_CAL_POINTS 7
+
+// Servo output filter bank, per axis under servo.<axis>.filter: low-pass
+// (off / first order / biquad), notch and slew-rate limit. Set in Hz and
+// deg/s and redesigned for the measured loop period, so the response does
+// not change with CONTROL_LOOP_RATE_HZ. The default first-order cutoff is the
+// former smoothing of 0.1 per 20 ms step: -ln(0.9) / (2 pi 0.02 s).
+#define SERVO_FILTER_LOWPASS_HZ 0.8384f
+#define SERVO_FILTER_LOWPASS_Q 0.7071f   // Biquad default (Butterworth)
+#define SERVO_FILTER_NOTCH_Q 2.0f        // Default when a notch is first set
+#define SERVO_FILTER_MIN_HZ 0.05f        // Accepted cutoff/notch range; also held below 0.45x the loop rate
+#define SERVO_FILTER_MAX_HZ 100.0f
+#define SERVO_FILTER_MIN_Q 0.3f
+#define SERVO_FILTER_MAX_Q 20.0f
+#define SERVO_FILTER_MAX_SLEW_DPS 2000.0f
+#define SERVO_FILTER_DT_TOLERANCE 0.02f  // Redesign once the averaged loop period moves this far
+
+// Trajectory limits for timed moves and keyframe trajectories. A move keeps
+// its requested timing unless it would exceed one of these; then the whole
+// move is slowed uniformly until it fits. Keep velocity below the servos'
+// own slew rate (~350 deg/s for MG996R-class servos).
+#define TRAJ_MAX_VELOCITY_YAW 180.0f   // deg/s
+#define TRAJ_MAX_VELOCITY_PITCH 240.0f
+#define TRAJ_MAX_VELOCITY_ROLL 240.0f
+#define TRAJ_MAX_ACCEL_YAW 720.0f      // deg/s^2
+#define TRAJ_MAX_ACCEL_PITCH 1200.0f
+#define TRAJ_MAX_ACCEL_ROLL 1200.0f
+#define TRAJ_MAX_JERK_YAW 6000.0f      // deg/s^3
+#define TRAJ_MAX_JERK_PITCH 12000.0f
+#define TRAJ_MAX_JERK_ROLL 12000.0f
+#define TRAJECTORY_JSON_CAPACITY 2048 // POST /api/trajectory body, up to 16 keyframes
+
+// Stored motion sequences (/sequences.bin), loaded into a fixed pool at boot
+#define SEQUENCE_POOL_SIZE 8
+#define SEQUENCE_NAME_MAX 15          // Characters, not counting the terminator
+#define SEQUENCE_MAX_TIME_S 655.35f   // Keyframe times are stored in 10 ms units (uint16)
+
+// Self-test, run by the control loop: per axis a settle and a step from
+// SERVO_CENTER with the camera response recorded, then the range sweep
+#define SELF_TEST_STEP_DEG 20.0f
+#define SELF_TEST_SETTLE_S 1.0f        // Before each step; the baseline is its last 0.2 s
+#define SELF_TEST_STEP_S 1.5f          // Recorded after each step; the final value is its last 0.2 s
+#define SELF_TEST_RANGE_HOLD_S 0.5f    // At each end of the range, and for the return
+#define SELF_TEST_SETTLE_BAND_PCT 5.0f // Settling time: until within this % of the step
+
+// Attitude Estimator (auto mode reference)
+#define ESTIMATOR_COMPLEMENTARY 0
+#define ESTIMATOR_MAHONY 1
+#define ESTIMATOR_DEFAULT ESTIMATOR_MAHONY
+#define ESTIMATOR_TAU 0.5f        // Complementary filter crossover (seconds)
+#define MAHONY_KP 1.0f
+#define MAHONY_KI 0.02f
+
 // Auto Mode PID Parameters
 #define KP 2.0
 #define KI 0.5
-#define KD 1.0
+#define KD 0.1
+// Per-axis defaults. The axes carry different loads (yaw moves the whole
+// stack), so each can be tuned on its own via /api/config.
+#define KP_YAW KP
+#define KI_YAW KI
+#define KD_YAW KD
+#define KP_PITCH KP
+#define KI_PITCH KI
+#define KD_PITCH KD
+#define KP_ROLL KP
+#define KI_ROLL KI
+#define KD_ROLL KD
+
+// Relay-feedback autotune (auto mode, one axis at a time). The relay switches
+// the axis's correction between +/- AUTOTUNE_RELAY_DEG; with the default
+// output filter the camera then oscillates by about a degree.
+#define AUTOTUNE_RELAY_DEG 4.0f
+#define AUTOTUNE_HYSTERESIS_DEG 0.2f   // Above the attitude estimate's noise
+#define AUTOTUNE_MAX_ERROR_DEG 10.0f   // Larger error stops the run
+#define AUTOTUNE_AXIS_TIMEOUT_S 15.0f
+#define AUTOTUNE_SETTLE_S 1.0f         // Normal control before each axis
+#define AUTOTUNE_DISCARD_CYCLES 2
+#define AUTOTUNE_MEASURE_CYCLES 4
+#define AUTOTUNE_PERIOD_TOLERANCE 0.15f
+#define AUTOTUNE_DEFAULT_RULE AUTOTUNE_RULE_TYREUS_LUYBEN // The auto loop integrates; the Tu/2 rules overshoot on it
+
+// PID shaping for auto mode (see PIDController). Compare against the unshaped
+// loop with the host benchmark: .pio/build/native/program --benchmark
+// Only the feed-forward is on: it cuts the residual of base motion by about
+// a quarter without slowing steps, and the loop goes unstable from about
+// 0.45. The auto loop adds each correction to the servo position, so it
+// integrates: a setpoint weight below 1 leaves a P term at rest that the
+// integral has to work off, and 0.8 stretched settling from 0.28 s to 2.2 s
+// for a 3.6% overshoot cut. The derivative filter and rate limit did not
+// reduce chatter in the simulator either, so they are off too.
+#define PID_DERIVATIVE_TAU 0.0f     // s, derivative low-pass; 0 = off
+#define PID_SETPOINT_WEIGHT 1.0f    // Proportional setpoint weight; 1 = off
+#define PID_FEEDFORWARD_GAIN 0.3f   // Fraction of the gyro base rate fed forward
+#define PID_OUTPUT_RATE_LIMIT 0.0f  // deg/s of correction change; 0 = off
 
 // WebServer Configuration
 #define HTTP_PORT 80
 #define WEBSOCKET_PORT 8080
 
 // Update Rates (milliseconds)
-#define SENSOR_UPDATE_RATE 10
-#define SERVO_UPDATE_RATE 20
-#define WEBSOCKET_UPDATE_RATE 100
+#define WEBSOCKET_UPDATE_RATE 100 // Default JSON status interval for a new client
+
+// WebSocket Subscriptions
+// Each client picks its format, rate and field set with the "hello" command.
+#define WS_MAX_CLIENTS 8                 // Matches AsyncWebSocket's DEFAULT_MAX_WS_CLIENTS
+#define WS_JSON_MAX_RATE_HZ 20
+#define TELEMETRY_DEFAULT_RATE_HZ 50     // Binary telemetry
+#define TELEMETRY_MAX_RATE_HZ 100
+
+// Field sets a client can subscribe to
+#define WS_FIELD_POSITION 0x01
+#define WS_FIELD_ATTITUDE 0x02
+#define WS_FIELD_SENSORS  0x04
+#define WS_FIELD_HARDWARE 0x08
+#define WS_FIELD_ALL      0x0F
+
+// Backpressure: frames are skipped, never queued, for a client whose TCP
+// send buffer is full; a client that keeps skipping gets a lower rate
+#define WS_FRAME_OVERHEAD 8              // WebSocket frame header bytes
+#define WS_BACKOFF_SKIPS 3               // Consecutive skips before halving the rate
+#define WS_RECOVER_SENDS 10              // Consecutive sends before doubling it back
+#define WS_MAX_INTERVAL_MS 1000          // Back-off floor: 1 Hz
+#define TELEMETRY_SLOW_SECTION_MS 1000   // How often text sections (BLE event) are included
+
+// Pooled WebSocket payload buffers (no payload allocation per broadcast)
+#define WS_BUFFER_POOL_SIZE 16           // Frames in flight, one buffer per client per queued frame
+#define WS_BUFFER_SIZE_CLASS 64          // JSON buffer lengths are rounded up to this many bytes
+#define TELEMETRY_FRAME_SIZE_CLASS 16    // Same for binary frames, which are much smaller
+
+// Real-Time Control Task
+// Sense -> estimate -> PID -> actuate runs in a dedicated task woken by a
+// hardware timer. Rate is clamped to CONTROL_LOOP_MAX_RATE_HZ.
+#define CONTROL_LOOP_RATE_HZ 500
+#define CONTROL_LOOP_MAX_RATE_HZ 1000
+#define CONTROL_TASK_CORE 1        // Keep off core 0 (WiFi/BLE stacks)
+#define CONTROL_TASK_PRIORITY 20   // Above loopTask (1) and AsyncTCP (3)
+// Bytes. Holds a batch of raw IMU frames, ControlParams copies and the
+// self-test, autotune and recorder paths; /api/perf reports what is left.
+#define CONTROL_TASK_STACK 8192
+#define CONTROL_TIMER_NUM 0        // Hardware timer group/index used as the tick source
+
+// Control parameters are published to the control task through a ring of
+// immutable snapshots (see ConfigManager::getControlParams)
+#define CONTROL_PARAM_SLOTS 4
+
+// Config Persistence
+// Config changes apply in RAM at once; a background task writes them to flash
+// (temp file + rename, plus a CRC-checked binary backup) once edits settle.
+#define CONFIG_SAVE_IDLE_MS 1000         // Write after this long without further changes
+#define CONFIG_SAVE_MAX_DELAY_MS 10000   // ...or once the oldest unsaved change is this old
+#define CONFIG_SAVE_MIN_INTERVAL_MS 5000 // Never write more often than this
+#define CONFIG_SAVE_POLL_MS 100          // Re-check period while changes are pending
+#define CONFIG_TASK_CORE 0
+#define CONFIG_TASK_PRIORITY 1           // Same as loopTask, below AsyncTCP
+#define CONFIG_TASK_STACK 10240          // JSON document + LittleFS calls
+#define CONFIG_JSON_CAPACITY 4096        // config.json / /api/config documents
+
+// Performance Instrumentation
+#define PERF_BROADCAST_INTERVAL_MS 1000 // WebSocket "perf" message period
+#define PERF_JITTER_BUDGET_PCT 10       // Tick jitter above this % of the period counts as missed
+#define KERNEL_BENCH_ITERATIONS 1000    // POST /api/perf/kernel default
+#define KERNEL_BENCH_MAX_ITERATIONS 20000
+#define KERNEL_BENCH_TASK_CORE 0
+#define KERNEL_BENCH_TASK_PRIORITY 1    // Same as loopTask, below AsyncTCP
+#define KERNEL_BENCH_TASK_STACK 4096
+
+// Flight Recorder
+// Every control cycle is written as a 64-byte record into a ring in PSRAM
+// (see FlightRecorder); a trigger freezes it for GET /api/recorder/download.
+// Without PSRAM the recorder is left out.
+#define FLIGHT_RECORDER_RECORDS 65536       // Power of two; 4 MB, 131 s at 500 Hz
+#define FLIGHT_RECORDER_ARM_AT_BOOT true    // With the defaults below
+#define FLIGHT_RECORDER_TRIGGERS 0x06       // Bit per FlightTrigger: error and saturation
+#define FLIGHT_RECORDER_PRE_TRIGGER_PCT 75  // Share of the capture from before the trigger
+#define FLIGHT_RECORDER_ERROR_DEG 15.0f     // Auto-mode tracking error that fires the error trigger
+#define FLIGHT_RECORDER_SATURATION_MS 200   // Pinned correction that fires the saturation trigger
+#define FLIGHT_RECORDER_CHUNK_RECORDS 16    // Records copied per download chunk
+
+// Logging
+// Run-time messages are queued as compact records (see EventLog) and written
+// out by a low-priority task: to Serial, to /ws/log, and from LOG_FILE_LEVEL
+// up to a LittleFS file.
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL LOG_LEVEL_INFO // Calls below this LogLevel are compiled out
+#endif
+#define LOG_RING_RECORDS 128             // Power of two; further messages are dropped and counted
+#define LOG_MAX_ARGS 6
+#define LOG_LINE_LENGTH 160              // Formatted line, longer ones are cut
+#define LOG_DRAIN_INTERVAL_MS 20
+#define LOG_TASK_CORE 0
+#define LOG_TASK_PRIORITY 1              // Same as loopTask, below AsyncTCP
+#define LOG_TASK_STACK 4096
+#define LOG_FILE_LEVEL LOG_LEVEL_WARN    // Lower levels stay off flash
+#define LOG_FILE_PATH "/log.txt"
+#define LOG_FILE_OLD_PATH "/log.old.txt" // The previous file once LOG_FILE_MAX_BYTES is reached
+#define LOG_FILE_MAX_BYTES 32768
 
 // Phone Gyro Rate Control
 // Gyro input is rad/s from the phone; firmware converts to deg/s and applies gain.
@@ -0,0 +1,80 @@
+#include "GimbalPlant.h"
+#include <math.h>
+#include "config.h"
+
+namespace {
+const float DEG_TO_RAD_F = 0.01745329f;
+const float TWO_PI_F = 6.2831853f;
+
+// Defaults roughly match MG996R-class servos (0.17 s/60 deg, ~1 N*m) carrying
+// a small camera: yaw moves the whole stack, pitch only the camera.
+const AxisPlantParams DEFAULT_AXIS[SIM_AXES] = {
+    {350.0f, 6e-4f, 0.60f, 0.020f, 1.0f}, // Yaw
+    {350.0f, 2e-4f, 0.60f, 0.012f, 1.0f}, // Pitch
+    {350.0f, 3e-4f, 0.60f, 0.015f, 1.0f}, // Roll
+};
+}
+
+GimbalPlant::GimbalPlant() : _time(0) {
+    for (int i = 0; i < SIM_AXES; i++) {
+        _params[i] = DEFAULT_AXIS[i];
+        _base[i] = {0, 0, 0};
+        _command[i] = SERVO_CENTER;
+        _reference[i] = SERVO_CENTER;
+        _angle[i] = SERVO_CENTER;
+        _rate[i] = 0;
+    }
+}
+
+void GimbalPlant::setAxisParams(int axis, const AxisPlantParams& params) {
+    _params[axis] = params;
+}
+
+void GimbalPlant::setBaseMotion(int axis, const BaseMotion& motion) {
+    _base[axis] = motion;
+}
+
+void GimbalPlant::setServoCommand(int axis, float angle) {
+    _command[axis] = fminf(fmaxf(angle, SERVO_MIN_ANGLE), SERVO_MAX_ANGLE);
+}
+
+void GimbalPlant::step(float dt) {
+    for (int i = 0; i < SIM_AXES; i++) {
+        const AxisPlantParams& p = _params[i];
+
+        // Servo electronics slew the internal reference toward the command
+        float maxStep = p.slewRate * dt;
+        float delta = _command[i] - _reference[i];
+        _reference[i] += fminf(fmaxf(delta, -maxStep), maxStep);
+
+        // Torque-limited position loop acting on the axis inertia
+        float errorRad = (_reference[i] - _angle[i]) * DEG_TO_RAD_F;
+        float rateRad = _rate[i] * DEG_TO_RAD_F;
+        float torque = p.stiffness * errorRad - p.damping * rateRad;
+        torque = fminf(fmaxf(torque, -p.maxTorque), p.maxTorque);
+
+        // Semi-implicit Euler keeps the stiff loop stable at 1 kHz
+        rateRad += (torque / p.inertia) * dt;
+        _rate[i] = rateRad / DEG_TO_RAD_F;
+        _angle[i] += _rate[i] * dt;
+    }
+    _time += dt;
+}
+
+float GimbalPlant::baseAngle(int axis) const {
+    const BaseMotion& m = _base[axis];
+    return m.offset + m.amplitude * sinf(TWO_PI_F * m.frequency * _time);
+}
+
+float GimbalPlant::baseRate(int axis) const {
+    const BaseMotion& m = _base[axis];
+    return m.amplitude * TWO_PI_F * m.frequency * cosf(TWO_PI_F * m.frequency * _time);
+}
+
+float GimbalPlant::cameraAngle(int axis) const {
+    return baseAngle(axis) + (_angle[axis] - SERVO_CENTER);
+}
+
+float GimbalPlant::cameraRate(int axis) const {
+    return baseRate(axis) + _rate[axis];
+}
@@ -0,0 +1,54 @@
+#pragma once
+// Simulated 3-axis gimbal plant for closed-loop testing on the host.
+//
+// Each axis is a hobby servo driving a rotational inertia: the servo's
+// internal reference chases the PWM command at a limited slew rate, and a
+// stiff, torque-limited position loop pulls the loaded shaft after it.
+// The camera sits on top of a moving base, so its attitude relative to the
+// horizon is base angle + (servo angle - SERVO_CENTER). Axes are treated as
+// decoupled (small-angle geometry).
+
+enum SimAxis { SIM_YAW = 0, SIM_PITCH = 1, SIM_ROLL = 2, SIM_AXES = 3 };
+
+struct AxisPlantParams {
+    float slewRate;     // deg/s, servo no-load speed
+    float inertia;      // kg*m^2, load seen by the servo
+    float stiffness;    // N*m/rad, servo position loop gain
+    float damping;      // N*m*s/rad
+    float maxTorque;    // N*m, stall torque
+};
+
+struct BaseMotion {
+    float offset;       // deg
+    float amplitude;    // deg
+    float frequency;    // Hz
+};
+
+class GimbalPlant {
+public:
+    GimbalPlant();
+    void setAxisParams(int axis, const AxisPlantParams& params);
+    void setBaseMotion(int axis, const BaseMotion& motion);
+
+    // Commanded angle in the 0-180 servo range
+    void setServoCommand(int axis, float angle);
+    void step(float dt);
+
+    float time() const { return _time; }
+    float servoAngle(int axis) const { return _angle[axis]; }
+    float servoRate(int axis) const { return _rate[axis]; }
+    float baseAngle(int axis) const;
+    float baseRate(int axis) const;
+    // Camera attitude relative to the horizon (deg) and its rate (deg/s)
+    float cameraAngle(int axis) const;
+    float cameraRate(int axis) const;
+
+private:
+    AxisPlantParams _params[SIM_AXES];
+    BaseMotion _base[SIM_AXES];
+    float _command[SIM_AXES];
+    float _reference[SIM_AXES]; // Servo's internal slew-limited setpoint
+    float _angle[SIM_AXES];
+    float _rate[SIM_AXES];
+    float _time;
+};
@@ -0,0 +1,111 @@
+// In-memory ConfigManager for the host simulator: same interface as
+// src/Services/ConfigManager.h, without LittleFS or JSON persistence.
+#include "../src/Services/ConfigManager.h"
+
+ConfigManager::ConfigManager() {
+    _mutex = xSemaphoreCreateMutex();
+    _ioMutex = xSemaphoreCreateMutex();
+    _persistTask = nullptr;
+    _dirty = false;
+    _dirtySinceMs = 0;
+    _lastChangeMs = 0;
+    _lastFlushMs = 0;
+    memset(&_persistStats, 0, sizeof(_persistStats));
+    _controlVersion.store(0, std::memory_order_relaxed);
+    _controlParams.store(&_controlSlots[0], std::memory_order_release);
+    resetToDefaults();
+}
+
+void ConfigManager::resetToDefaults() {
+    config.wifi_ssid = WIFI_SSID;
+    config.wifi_password = WIFI_PASSWORD;
+    config.hotspot_ssid = HOTSPOT_SSID;
+    config.hotspot_password = HOTSPOT_PASSWORD;
+    config.mode = MODE_MANUAL;
+    config.gains[AXIS_YAW] = {KP_YAW, KI_YAW, KD_YAW};
+    config.gains[AXIS_PITCH] = {KP_PITCH, KI_PITCH, KD_PITCH};
+    config.gains[AXIS_ROLL] = {KP_ROLL, KI_ROLL, KD_ROLL};
+    memset(&config.gainSchedule, 0, sizeof(config.gainSchedule));
+    for (int axis = 0; axis < AXIS_COUNT; axis++) {
+        config.servo_endpoints[axis] = {SERVO_PULSE_MIN_US, SERVO_PULSE_MAX_US};
+        config.servo_calibration[axis].count = 0;
+        config.output_filter[axis] = {OUTPUT_LOWPASS_FIRST_ORDER, SERVO_FILTER_LOWPASS_HZ, SERVO_FILTER_LOWPASS_Q,
+                                      0.0f, SERVO_FILTER_NOTCH_Q, 0.0f};
+    }
+    config.servo_refresh_hz = SERVO_REFRESH_HZ;
+    config.estimator = ESTIMATOR_DEFAULT;
+    config.imu_calibration = defaultImuCalibration();
+    config.yaw_offset = 0;
+    config.pitch_offset = 0;
+    config.roll_offset = 0;
+    config.flat_ref_yaw = -1.0;
+    config.flat_ref_pitch = -1.0;
+    config.flat_ref_roll = -1.0;
+    _publishControlParams();
+}
+
+bool ConfigManager::begin() {
+    return true;
+}
+
+bool ConfigManager::loadConfig() {
+    return true;
+}
+
+bool ConfigManager::saveConfig() {
+    return true;
+}
+
+bool ConfigManager::flush() {
+    return true;
+}
+
+AppConfig ConfigManager::getConfig() {
+    return config;
+}
+
+void ConfigManager::updateConfig(const AppConfig& newConfig) {
+    config = newConfig;
+    _publishControlParams();
+    _persistStats.requested++;
+}
+
+ConfigPersistStats ConfigManager::getPersistStats() {
+    return _persistStats;
+}
+
+ControlParams ConfigManager::getControlParams() const {
+    ControlParams copy;
+    // A slot is only rewritten after the pointer has moved past it, so a
+    // copy that overlapped a write retries on the newer, complete slot
+    while (!_controlParams.load(std::memory_order_acquire)->tryRead(copy)) {
+    }
+    return copy;
+}
+
+void ConfigManager::_publishControlParams() {
+    uint32_t version = _controlVersion.load(std::memory_order_relaxed) + 1;
+    ControlParams params;
+    memset(&params, 0, sizeof(params));
+    params.version = version;
+    params.mode = config.mode;
+    memcpy(params.gains, config.gains, sizeof(params.gains));
+    params.gainSchedule = config.gainSchedule;
+    params.estimator = config.estimator;
+    params.imu_calibration = config.imu_calibration;
+    memcpy(params.servo_endpoints, config.servo_endpoints, sizeof(params.servo_endpoints));
+    memcpy(params.servo_calibration, config.servo_calibration, sizeof(params.servo_calibration));
+    memcpy(params.output_filter, config.output_filter, sizeof(params.output_filter));
+    params.servo_refresh_hz = config.servo_refresh_hz;
+    params.yaw_offset = config.yaw_offset;
+    params.pitch_offset = config.pitch_offset;
+    params.roll_offset = config.roll_offset;
+    params.flat_ref_yaw = config.flat_ref_yaw;
+    params.flat_ref_pitch = config.flat_ref_pitch;
+    params.flat_ref_roll = config.flat_ref_roll;
+
+    SeqLock<ControlParams>& slot = _controlSlots[version % CONTROL_PARAM_SLOTS];
+    slot.write(params);
+    _controlParams.store(&slot, std::memory_order_release);
+    _controlVersion.store(version, std::memory_order_release);
+}
@@ -0,0 +1,91 @@
+#include "SimImu.h"
+#include <math.h>
+
+namespace {
+const float DEG_TO_RAD_F = 0.01745329f;
+const float GRAVITY = 9.80665f;
+const float ACCEL_LSB = GRAVITY / 4096.0f;          // +/-8 g
+const float GYRO_LSB = DEG_TO_RAD_F / 65.5f;        // +/-500 deg/s
+
+float quantize(float value, float lsb) {
+    float counts = roundf(value / lsb);
+    counts = fminf(fmaxf(counts, -32768.0f), 32767.0f);
+    return counts * lsb;
+}
+}
+
+SimImu::SimImu(uint32_t seed)
+    : _params(defaultErrorParams()), _rng(seed), _normal(0.0f, 1.0f),
+      _biasDrift{0, 0, 0}, _temperature(0) {
+    _temperature = _params.tempStart;
+}
+
+ImuErrorParams SimImu::defaultErrorParams() {
+    // Typical MPU6050 breakout with the DLPF at ~44 Hz
+    ImuErrorParams p;
+    p.accelNoise = 0.04f;
+    for (int i = 0; i < 3; i++) {
+        p.accelOffset[i] = 0.0f; // Ideal unless a scenario sets them
+        p.accelScale[i] = 1.0f;
+    }
+    p.gyroNoise = 0.0015f;
+    p.gyroBias[0] = 0.010f;
+    p.gyroBias[1] = -0.008f;
+    p.gyroBias[2] = 0.012f;
+    p.gyroBiasWalk = 0.0005f;
+    p.gyroTempCoeff = 0.0003f;
+    p.tempStart = 25.0f;
+    p.tempRampPerMin = 2.0f;
+    return p;
+}
+
+ImuErrorParams SimImu::idealErrorParams() {
+    ImuErrorParams p = {};
+    for (int i = 0; i < 3; i++) p.accelScale[i] = 1.0f;
+    p.tempStart = 25.0f;
+    return p;
+}
+
+void SimImu::setErrorParams(const ImuErrorParams& params) {
+    _params = params;
+    _temperature = params.tempStart;
+    _biasDrift[0] = _biasDrift[1] = _biasDrift[2] = 0;
+}
+
+ImuSample SimImu::sample(const GimbalPlant& plant, float dt) {
+    _temperature += _params.tempRampPerMin / 60.0f * dt;
+    float tempBias = _params.gyroTempCoeff * (_temperature - 25.0f);
+
+    float walk = _params.gyroBiasWalk * sqrtf(dt);
+    for (int i = 0; i < 3; i++) {
+        _biasDrift[i] += walk * _normal(_rng);
+    }
+
+    float roll = plant.cameraAngle(SIM_ROLL) * DEG_TO_RAD_F;
+    float pitch = plant.cameraAngle(SIM_PITCH) * DEG_TO_RAD_F;
+
+    ImuSample s;
+    // Specific force of gravity in body axes
+    s.accelX = -sinf(pitch) * GRAVITY * _params.accelScale[0] + _params.accelOffset[0]
+             + _params.accelNoise * _normal(_rng);
+    s.accelY = sinf(roll) * cosf(pitch) * GRAVITY * _params.accelScale[1] + _params.accelOffset[1]
+             + _params.accelNoise * _normal(_rng);
+    s.accelZ = cosf(roll) * cosf(pitch) * GRAVITY * _params.accelScale[2] + _params.accelOffset[2]
+             + _params.accelNoise * _normal(_rng);
+
+    // Body rates (small-angle: equal to the Euler rates)
+    s.gyroX = plant.cameraRate(SIM_ROLL) * DEG_TO_RAD_F
+            + _params.gyroBias[0] + _biasDrift[0] + tempBias + _params.gyroNoise * _normal(_rng);
+    s.gyroY = plant.cameraRate(SIM_PITCH) * DEG_TO_RAD_F
+            + _params.gyroBias[1] + _biasDrift[1] + tempBias + _params.gyroNoise * _normal(_rng);
+    s.gyroZ = plant.cameraRate(SIM_YAW) * DEG_TO_RAD_F
+            + _params.gyroBias[2] + _biasDrift[2] + tempBias + _params.gyroNoise * _normal(_rng);
+
+    s.accelX = quantize(s.accelX, ACCEL_LSB);
+    s.accelY = quantize(s.accelY, ACCEL_LSB);
+    s.accelZ = quantize(s.accelZ, ACCEL_LSB);
+    s.gyroX = quantize(s.gyroX, GYRO_LSB);
+    s.gyroY = quantize(s.gyroY, GYRO_LSB);
+    s.gyroZ = quantize(s.gyroZ, GYRO_LSB);
+    return s;
+}
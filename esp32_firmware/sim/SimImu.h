@@ -0,0 +1,40 @@
+#pragma once
+// Synthetic MPU6050 mounted on the camera platform.
+// Produces the same units as SensorManager (m/s^2, rad/s), quantized to the
+// +/-8 g and +/-500 deg/s LSBs, with white noise, a constant gyro bias, a
+// random-walk bias drift, a temperature-dependent bias term and per-axis
+// accelerometer offset and scale errors.
+#include <random>
+#include "GimbalPlant.h"
+#include "../src/Domain/AttitudeEstimator.h"
+
+struct ImuErrorParams {
+    float accelNoise;        // m/s^2 RMS per sample
+    float accelOffset[3];    // m/s^2, body x/y/z
+    float accelScale[3];     // Measured / true
+    float gyroNoise;         // rad/s RMS per sample
+    float gyroBias[3];       // rad/s, body x/y/z
+    float gyroBiasWalk;      // rad/s per sqrt(s)
+    float gyroTempCoeff;     // rad/s per deg C away from 25 C
+    float tempStart;         // deg C
+    float tempRampPerMin;    // deg C per minute (warm-up)
+};
+
+class SimImu {
+public:
+    explicit SimImu(uint32_t seed = 1);
+    void setErrorParams(const ImuErrorParams& params);
+    static ImuErrorParams defaultErrorParams();
+    static ImuErrorParams idealErrorParams();
+
+    // Sample the plant's camera attitude; dt is the time since the last sample
+    ImuSample sample(const GimbalPlant& plant, float dt);
+    float temperature() const { return _temperature; }
+
+private:
+    ImuErrorParams _params;
+    std::mt19937 _rng;
+    std::normal_distribution<float> _normal;
+    float _biasDrift[3];
+    float _temperature;
+};
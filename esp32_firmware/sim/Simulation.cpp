@@ -0,0 +1,105 @@
+#include "Simulation.h"
+
+Simulation::Simulation(uint32_t seed, int controlRateHz)
+    : _gimbal(_config),
+      _configVersion(0),
+      _recorder(nullptr),
+      _imu(seed),
+      _ticksPerControl(1),
+      _tick(0),
+      _nextFrameTime(0)
+{
+    int ticks = (int)(1.0f / (PHYSICS_DT * controlRateHz) + 0.5f);
+    _ticksPerControl = ticks < 1 ? 1 : ticks;
+    _estimator.setComplementaryTimeConstant(ESTIMATOR_TAU);
+    _estimator.setMahonyGains(MAHONY_KP, MAHONY_KI);
+    const ImuRestSettings rest = {IMU_REST_WINDOW_S, IMU_REST_GYRO_STD_RAD_S, IMU_REST_ACCEL_STD_MS2,
+                                  IMU_REST_GRAVITY_TOL_MS2, IMU_BOOT_BIAS_WINDOWS, IMU_BOOT_TIMEOUT_S,
+                                  IMU_BIAS_TRACK_TAU_S, IMU_BIAS_MAX_STEP_RAD_S};
+    _imuCorrector.configure(rest, IMU_TEMP_BIN_MIN_C, IMU_TEMP_BIN_WIDTH_C);
+    for (int axis = 0; axis < SIM_AXES; axis++) {
+        _servoNonlinearity[axis] = {0, 0};
+    }
+}
+
+void Simulation::begin() {
+    _gimbal.begin();
+}
+
+void Simulation::run(float seconds, const std::function<void(Simulation&)>& onControlTick) {
+    int steps = (int)(seconds / PHYSICS_DT + 0.5f);
+    for (int i = 0; i < steps; i++) {
+        latchServoPulses();
+        _plant.step(PHYSICS_DT);
+        simAdvanceMicros((uint64_t)(PHYSICS_DT * 1e6f));
+        _pending.push_back(_imu.sample(_plant, PHYSICS_DT));
+
+        if (++_tick >= _ticksPerControl) {
+            _tick = 0;
+            controlTick();
+            if (onControlTick) onControlTick(*this);
+        }
+    }
+}
+
+void Simulation::controlTick() {
+    if (_config.getControlVersion() != _configVersion) {
+        ControlParams params = _config.getControlParams();
+        _configVersion = params.version;
+        int type = params.estimator;
+        _estimator.setType(type == ESTIMATOR_COMPLEMENTARY ? EstimatorType::COMPLEMENTARY : EstimatorType::MAHONY);
+        _imuCorrector.setCalibration(params.imu_calibration);
+    }
+    FlightRecord* record = _recorder ? _recorder->prepare() : nullptr;
+    if (record) {
+        float dt = _ticksPerControl * PHYSICS_DT;
+        memset(record, 0, sizeof(*record));
+        record->timeUs = (uint32_t)(_plant.time() * 1e6f + 0.5f);
+        record->dtUs = (uint16_t)(dt * 1e6f + 0.5f);
+        record->samples = (uint8_t)_pending.size();
+        record->temperature = toFlightCentis(_imu.temperature());
+        if (!_pending.empty()) {
+            // Back to raw counts, before the corrector touches the sample
+            const ImuSample& s = _pending.back();
+            const float accelScale = ACCEL_LSB_PER_G / 9.80665f;
+            const float gyroScale = GYRO_LSB_PER_DPS * 57.29578f;
+            const float accel[3] = {s.accelX, s.accelY, s.accelZ};
+            const float gyro[3] = {s.gyroX, s.gyroY, s.gyroZ};
+            for (int i = 0; i < 3; i++) {
+                record->accel[i] = (int16_t)lroundf(fmaxf(fminf(accel[i] * accelScale, 32767.0f), -32768.0f));
+                record->gyro[i] = (int16_t)lroundf(fmaxf(fminf(gyro[i] * gyroScale, 32767.0f), -32768.0f));
+            }
+        }
+    }
+
+    if (!_pending.empty()) {
+        _imuCorrector.beginCycle(_imu.temperature());
+    }
+    for (ImuSample& sample : _pending) {
+        _imuCorrector.apply(sample, PHYSICS_DT);
+        _estimator.update(sample, PHYSICS_DT);
+    }
+    _pending.clear();
+
+    AttitudeEstimate estimate = _estimator.getEstimate();
+    estimate.valid = estimate.valid && _imuCorrector.settled();
+    _gimbal.update(_ticksPerControl * PHYSICS_DT, estimate, record);
+    if (_recorder) _recorder->commit();
+}
+
+void Simulation::latchServoPulses() {
+    if (_plant.time() < _nextFrameTime) {
+        return;
+    }
+    const int pins[SIM_AXES] = {SERVO_PIN_YAW, SERVO_PIN_PITCH, SERVO_PIN_ROLL};
+    for (int axis = 0; axis < SIM_AXES; axis++) {
+        float us = simPulseUs(pins[axis]);
+        if (us <= 0) continue;
+        float u = (us - SERVO_US_AT_MIN) / (SERVO_US_AT_MAX - SERVO_US_AT_MIN);
+        const ServoNonlinearity& n = _servoNonlinearity[axis];
+        float angle = u * 180.0f + n.bowDeg * sinf((float)M_PI * u) + n.waveDeg * sinf(2.0f * (float)M_PI * u);
+        _plant.setServoCommand(axis, angle);
+    }
+    uint32_t hz = simRefreshHz(SERVO_PIN_YAW);
+    _nextFrameTime += 1.0f / (hz ? hz : SERVO_REFRESH_HZ);
+}
@@ -0,0 +1,75 @@
+#pragma once
+// Closed-loop harness: the real GimbalController, PIDController and
+// AttitudeEstimator from src/Domain driving the simulated plant and IMU.
+//
+// Physics and the IMU run at 1 kHz (the MPU6050 FIFO rate). Every
+// 1000 / controlRateHz ticks the queued IMU samples go through the
+// ImuCorrector and the estimator and GimbalController::update() runs,
+// mirroring ControlTask.
+// The servos only see a new pulse once per PWM frame (the LEDC refresh
+// rate), so a 50 Hz output adds up to 20 ms of actuation delay.
+#include <functional>
+#include <vector>
+#include "GimbalPlant.h"
+#include "SimImu.h"
+#include "../src/Services/ConfigManager.h"
+#include "../src/Domain/GimbalController.h"
+#include "../src/Domain/AttitudeEstimator.h"
+#include "../src/Domain/ImuCalibration.h"
+#include "../src/Domain/FlightRecorder.h"
+
+// Deviation of a servo from the ideal linear pulse-to-angle mapping:
+// bowDeg * sin(pi * u) + waveDeg * sin(2 * pi * u), u = 0..1 across the pulse
+// range. Endpoints stay exact; keep pi * bow + 2 * pi * wave below 180 so the
+// servo stays monotone.
+struct ServoNonlinearity {
+    float bowDeg;
+    float waveDeg;
+};
+
+class Simulation {
+public:
+    static constexpr float PHYSICS_DT = 0.001f;
+    // The simulated servos' own pulse-to-angle mapping (an ideal servo)
+    static constexpr float SERVO_US_AT_MIN = 500.0f;
+    static constexpr float SERVO_US_AT_MAX = 2500.0f;
+    // Raw IMU scales written to flight records, as MPU6050Fifo configures the chip
+    static constexpr float ACCEL_LSB_PER_G = 4096.0f;
+    static constexpr float GYRO_LSB_PER_DPS = 65.5f;
+
+    // controlRateHz divides 1000; other rates are rounded to a whole number of ticks
+    explicit Simulation(uint32_t seed = 1, int controlRateHz = CONTROL_LOOP_RATE_HZ);
+    void begin();
+    void setServoNonlinearity(int axis, const ServoNonlinearity& n) { _servoNonlinearity[axis] = n; }
+    // Fed every control cycle, as ControlTask feeds its own; null to stop
+    void setFlightRecorder(FlightRecorder* recorder) { _recorder = recorder; }
+
+    // Advance by `seconds`; onControlTick runs after every control update
+    void run(float seconds, const std::function<void(Simulation&)>& onControlTick = nullptr);
+
+    float time() const { return _plant.time(); }
+    ConfigManager& config() { return _config; }
+    GimbalController& gimbal() { return _gimbal; }
+    GimbalPlant& plant() { return _plant; }
+    SimImu& imu() { return _imu; }
+    AttitudeEstimator& estimator() { return _estimator; }
+    const ImuCorrector& imuCorrector() const { return _imuCorrector; }
+
+private:
+    ConfigManager _config;
+    GimbalController _gimbal;
+    AttitudeEstimator _estimator;
+    ImuCorrector _imuCorrector;
+    uint32_t _configVersion;
+    FlightRecorder* _recorder;
+    GimbalPlant _plant;
+    SimImu _imu;
+    std::vector<ImuSample> _pending;
+    int _ticksPerControl;
+    int _tick;
+    float _nextFrameTime; // Start of the next PWM frame, s
+    ServoNonlinearity _servoNonlinearity[SIM_AXES];
+
+    void controlTick();
+    void latchServoPulses();
+};
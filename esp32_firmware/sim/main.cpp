@@ -0,0 +1,1147 @@
+// Host-side closed-loop scenarios for the gimbal control code.
+//
+//   pio run -e native && .pio/build/native/program [scenario] [--trace]
+//   .pio/build/native/program --benchmark
+//   .pio/build/native/program --kernel-bench
+//
+// Each scenario drives the real Domain code against the simulated plant and
+// checks settling time, overshoot and tracking error against limits. The
+// process exits non-zero if any limit is exceeded, so it can gate changes.
+// --trace writes <scenario>.csv (time, measured, reference) for plotting.
+// --benchmark compares the auto loop with and without PID shaping instead.
+// --kernel-bench times the AxisKernel control cycle against the scalar path.
+//
+// Limits record the current controller's behaviour with some margin, so a
+// change that makes things worse fails. Tighten them as the control improves.
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Simulation.h"
+#include "../src/Domain/EventLog.h"
+#include "../src/Domain/KernelBenchmark.h"
+
+namespace {
+
+struct Sample {
+    float t;
+    float value;
+    float reference;
+};
+
+struct Check {
+    const char* metric;
+    float value;
+    float limit; // Pass when value <= limit
+};
+
+struct StepMetrics {
+    float riseTime;     // 10% -> 90%, seconds
+    float settlingTime; // Into and staying within the band, seconds after the step
+    float overshootPct;
+    float finalError;
+};
+
+bool g_trace = false;
+double g_simulatedSeconds = 0;
+
+StepMetrics analyzeStep(const std::vector<Sample>& trace, float t0, float y0, float y1, float band) {
+    StepMetrics m = {0, 0, 0, 0};
+    float span = y1 - y0;
+    float t10 = -1, t90 = -1, peak = 0;
+    float lastOutside = t0;
+
+    for (const Sample& s : trace) {
+        if (s.t < t0) continue;
+        float progress = (s.value - y0) / span;
+        if (t10 < 0 && progress >= 0.1f) t10 = s.t;
+        if (t90 < 0 && progress >= 0.9f) t90 = s.t;
+        if (progress - 1.0f > peak) peak = progress - 1.0f;
+        if (fabsf(s.value - y1) > band) lastOutside = s.t;
+    }
+
+    m.riseTime = (t10 >= 0 && t90 >= 0) ? t90 - t10 : INFINITY;
+    m.settlingTime = lastOutside - t0;
+    m.overshootPct = peak * 100.0f;
+    m.finalError = trace.empty() ? INFINITY : fabsf(trace.back().value - y1);
+    return m;
+}
+
+float rms(const std::vector<Sample>& trace, float fromTime) {
+    double sum = 0;
+    int n = 0;
+    for (const Sample& s : trace) {
+        if (s.t < fromTime) continue;
+        float e = s.value - s.reference;
+        sum += e * e;
+        n++;
+    }
+    return n ? (float)sqrt(sum / n) : INFINITY;
+}
+
+void writeTrace(const char* name, const std::vector<Sample>& trace) {
+    if (!g_trace) return;
+    std::string path = std::string(name) + ".csv";
+    FILE* f = fopen(path.c_str(), "w");
+    if (!f) return;
+    fprintf(f, "t,value,reference\n");
+    for (const Sample& s : trace) {
+        fprintf(f, "%.4f,%.4f,%.4f\n", s.t, s.value, s.reference);
+    }
+    fclose(f);
+}
+
+// --- Auto-mode runs, parameterized by PID shaping for the benchmark ---
+
+// Shaping features all off: derivative on the raw measurement, no limits
+const PIDShaping UNSHAPED = {0.0f, 1.0f, 0.0f, 0.0f, false};
+
+struct AutoStepResult {
+    StepMetrics step;
+    float trackingRms;
+};
+
+AutoStepResult simulateAutoStep(const PIDShaping* shaping, std::vector<Sample>& trace) {
+    Simulation sim;
+    sim.begin();
+    if (shaping) sim.gimbal().setPidShaping(*shaping);
+    sim.gimbal().setMode(MODE_AUTO);
+    sim.gimbal().setAutoTarget(90, 90, 90);
+    sim.run(3.0f);
+
+    float t0 = sim.time();
+    sim.gimbal().setAutoTarget(90, 100, 90);
+    sim.run(4.0f, [&](Simulation& s) {
+        trace.push_back({s.time(), SERVO_CENTER + s.plant().cameraAngle(SIM_PITCH), 100});
+    });
+    g_simulatedSeconds += sim.time();
+
+    AutoStepResult result;
+    result.step = analyzeStep(trace, t0, 90, 100, 1.0f);
+    result.trackingRms = rms(trace, t0 + 1.0f);
+    return result;
+}
+
+// Residual camera motion under base motion, as a fraction of the base RMS
+void simulateDisturbance(const PIDShaping* shaping, std::vector<Sample>& pitch, std::vector<Sample>& roll,
+                         float& pitchRatio, float& rollRatio) {
+    Simulation sim;
+    sim.begin();
+    if (shaping) sim.gimbal().setPidShaping(*shaping);
+    sim.plant().setBaseMotion(SIM_PITCH, {0, 5.0f, 0.5f});
+    sim.plant().setBaseMotion(SIM_ROLL, {0, 5.0f, 0.3f});
+    sim.gimbal().setMode(MODE_AUTO);
+    sim.gimbal().setAutoTarget(90, 90, 90);
+
+    sim.run(12.0f, [&](Simulation& s) {
+        pitch.push_back({s.time(), s.plant().cameraAngle(SIM_PITCH), 0});
+        roll.push_back({s.time(), s.plant().cameraAngle(SIM_ROLL), 0});
+    });
+    g_simulatedSeconds += sim.time();
+
+    // Unstabilized RMS of a 5 deg sine is 3.54 deg
+    const float baseRms = 5.0f / sqrtf(2.0f);
+    pitchRatio = rms(pitch, 2.0f) / baseRms;
+    rollRatio = rms(roll, 2.0f) / baseRms;
+}
+
+// Servo chatter while holding level on a still base: RMS servo speed driven
+// purely by IMU noise, deg/s
+float simulateHoldChatter(const PIDShaping* shaping) {
+    Simulation sim;
+    sim.begin();
+    if (shaping) sim.gimbal().setPidShaping(*shaping);
+    sim.gimbal().setMode(MODE_AUTO);
+    sim.gimbal().setAutoTarget(90, 90, 90);
+    sim.run(3.0f);
+
+    double sum = 0;
+    int n = 0;
+    sim.run(5.0f, [&](Simulation& s) {
+        for (int axis = 0; axis < SIM_AXES; axis++) {
+            float rate = s.plant().servoRate(axis);
+            sum += rate * rate;
+            n++;
+        }
+    });
+    g_simulatedSeconds += sim.time();
+    return n ? (float)sqrt(sum / n) : INFINITY;
+}
+
+// --- Scenarios ---
+
+std::vector<Check> manualStep() {
+    Simulation sim;
+    sim.begin();
+    sim.run(0.5f);
+
+    std::vector<Sample> trace;
+    float t0 = sim.time();
+    sim.gimbal().setManualPosition(90, 120, 90);
+    sim.run(3.0f, [&](Simulation& s) {
+        trace.push_back({s.time(), s.plant().servoAngle(SIM_PITCH), 120});
+    });
+    g_simulatedSeconds += sim.time();
+    writeTrace("manual_step", trace);
+
+    StepMetrics m = analyzeStep(trace, t0, 90, 120, 0.5f);
+    return {
+        {"rise_time_s", m.riseTime, 0.6f},
+        {"settling_time_s", m.settlingTime, 1.0f},
+        {"overshoot_pct", m.overshootPct, 5.0f},
+        {"final_error_deg", m.finalError, 0.2f},
+    };
+}
+
+std::vector<Check> timedMove() {
+    Simulation sim;
+    sim.begin();
+    sim.run(0.5f);
+
+    const float duration = 2.0f;
+    GimbalPosition endPos = {120, 60, 100};
+    std::vector<Sample> trace;
+    float t0 = sim.time();
+    sim.gimbal().startTimedMove(duration * 1000.0f, endPos);
+    float worstLag = 0, worstTracking = 0;
+    sim.run(duration + 2.0f, [&](Simulation& s) {
+        // Minimum-jerk S-curve the trajectory engine plans for one keyframe
+        float u = fminf((s.time() - t0) / duration, 1.0f);
+        float reference = 90 + (endPos.yaw - 90) * u * u * u * (10 + u * (-15 + 6 * u));
+        float yaw = s.plant().servoAngle(SIM_YAW);
+        trace.push_back({s.time(), yaw, reference});
+        worstTracking = fmaxf(worstTracking, fabsf(yaw - reference));
+        if (s.time() - t0 >= duration && s.time() - t0 < duration + 0.02f) {
+            worstLag = fabsf(yaw - endPos.yaw);
+        }
+    });
+    g_simulatedSeconds += sim.time();
+    writeTrace("timed_move", trace);
+
+    StepMetrics m = analyzeStep(trace, t0, 90, endPos.yaw, 0.5f);
+    return {
+        {"error_at_duration_deg", worstLag, 0.5f},
+        {"tracking_max_deg", worstTracking, 2.0f},
+        {"completion_time_s", m.settlingTime, duration + 0.1f},
+        {"final_error_deg", m.finalError, 0.2f},
+    };
+}
+
+// Spline through keyframes without stopping, then a move requested faster
+// than the trajectory limits allow
+std::vector<Check> trajectorySpline() {
+    Simulation sim;
+    sim.begin();
+    sim.run(0.5f);
+
+    const TrajectoryKeyframe keyframes[] = {
+        {1.5f, {110, 70, 90}},
+        {3.0f, {130, 100, 100}},
+        {4.0f, {100, 110, 80}},
+        {6.0f, {90, 90, 90}},
+    };
+    const int count = sizeof(keyframes) / sizeof(keyframes[0]);
+    float planned = 0;
+    float t0 = sim.time();
+    sim.gimbal().startTrajectory(keyframes, count, TRAJ_SPLINE, &planned);
+
+    std::vector<Sample> trace;
+    int next = 0;
+    float keyframeError = 0;
+    sim.run(planned + 0.5f, [&](Simulation& s) {
+        trace.push_back({s.time(), s.plant().servoAngle(SIM_YAW), 0});
+        if (next < count && s.time() - t0 >= keyframes[next].time) {
+            for (int axis = 0; axis < AXIS_COUNT; axis++) {
+                keyframeError = fmaxf(keyframeError, fabsf(s.plant().servoAngle(axis) - keyframes[next].position[axis]));
+            }
+            next++;
+        }
+    });
+    writeTrace("trajectory_spline", trace);
+
+    // 90 deg in 0.2 s is far beyond TRAJ_MAX_*_YAW: unless the move is
+    // slowed, the servo runs at its own slew limit, about twice the limit
+    float limited = 0;
+    TrajectoryKeyframe fast = {0.2f, {180, 90, 90}};
+    sim.gimbal().startTrajectory(&fast, 1, TRAJ_SCURVE, &limited);
+    float peakRate = 0;
+    sim.run(limited + 0.5f, [&](Simulation& s) {
+        peakRate = fmaxf(peakRate, fabsf(s.plant().servoRate(SIM_YAW)));
+    });
+    g_simulatedSeconds += sim.time();
+
+    return {
+        {"duration_error_s", fabsf(planned - keyframes[count - 1].time), 0.001f},
+        {"keyframe_error_deg", keyframeError, 1.0f},
+        {"limited_peak_rate_ratio", peakRate / TRAJ_MAX_VELOCITY_YAW, 1.1f},
+    };
+}
+
+// The hold before the step is truly level now that the gyro bias is removed
+// (the Mahony filter alone sat about bias / Kp = 0.45 deg off), so the whole
+// 10 deg is travelled and the setpoint-weight tail sets the settling time
+std::vector<Check> autoStep() {
+    std::vector<Sample> trace;
+    AutoStepResult r = simulateAutoStep(nullptr, trace);
+    writeTrace("auto_step", trace);
+
+    return {
+        {"settling_time_s", r.step.settlingTime, 2.5f},
+        {"overshoot_pct", r.step.overshootPct, 5.0f},
+        {"tracking_rms_deg", r.trackingRms, 1.1f},
+    };
+}
+
+std::vector<Check> autoDisturbance() {
+    std::vector<Sample> pitch, roll;
+    float pitchRatio, rollRatio;
+    simulateDisturbance(nullptr, pitch, roll, pitchRatio, rollRatio);
+    writeTrace("auto_disturbance", pitch);
+
+    return {
+        {"pitch_residual_ratio", pitchRatio, 0.3f},
+        {"roll_residual_ratio", rollRatio, 0.3f},
+    };
+}
+
+std::vector<Check> autoHold() {
+    return {
+        {"servo_rate_rms_dps", simulateHoldChatter(nullptr), 3.0f},
+    };
+}
+
+// Live per-axis gain change with an error-keyed schedule while holding
+// against a static base tilt: the hold must not jerk or go unstable
+std::vector<Check> autoGainSwitch() {
+    Simulation sim;
+    sim.begin();
+    sim.plant().setBaseMotion(SIM_PITCH, {8.0f, 0, 0});
+    sim.plant().setBaseMotion(SIM_ROLL, {-5.0f, 0, 0});
+    sim.gimbal().setMode(MODE_AUTO);
+    sim.gimbal().setAutoTarget(90, 90, 90);
+    sim.run(4.0f);
+
+    float before = 0;
+    sim.run(1.0f, [&](Simulation& s) {
+        before = fmaxf(before, fabsf(s.plant().cameraAngle(SIM_PITCH)));
+    });
+
+    AppConfig config = sim.config().getConfig();
+    config.gains[AXIS_PITCH] = {2.5f, 0.8f, 0.1f};
+    config.gains[AXIS_ROLL] = {1.5f, 0.3f, 0.05f};
+    config.gainSchedule.count = 2;
+    config.gainSchedule.points[0] = {0.5f, 0.5f, 1.0f, 1.0f};
+    config.gainSchedule.points[1] = {5.0f, 1.5f, 1.0f, 1.0f};
+    sim.config().updateConfig(config);
+
+    float after = 0;
+    std::vector<Sample> trace;
+    sim.run(2.0f, [&](Simulation& s) {
+        after = fmaxf(after, fabsf(s.plant().cameraAngle(SIM_PITCH)));
+        after = fmaxf(after, fabsf(s.plant().cameraAngle(SIM_ROLL)));
+        trace.push_back({s.time(), s.plant().cameraAngle(SIM_PITCH), 0});
+    });
+    g_simulatedSeconds += sim.time();
+    writeTrace("auto_gain_switch", trace);
+
+    return {
+        {"hold_error_before_deg", before, 1.5f},
+        {"max_error_after_deg", after, 1.0f},
+    };
+}
+
+// 10 and 20 deg auto steps on the default gains with the auto_gain_switch
+// schedule, which raises kp with the error. The schedule must not leave
+// anything in the integral that the loop then works off as overshoot.
+std::vector<Check> autoStepScheduled() {
+    float overshoot[2];
+    const float steps[2] = {10.0f, 20.0f};
+    for (int n = 0; n < 2; n++) {
+        Simulation sim;
+        AppConfig config = sim.config().getConfig();
+        config.gainSchedule.count = 2;
+        config.gainSchedule.points[0] = {0.5f, 0.5f, 1.0f, 1.0f};
+        config.gainSchedule.points[1] = {5.0f, 1.5f, 1.0f, 1.0f};
+        sim.config().updateConfig(config);
+        sim.begin();
+        sim.gimbal().setMode(MODE_AUTO);
+        sim.gimbal().setAutoTarget(90, 90, 90);
+        sim.run(3.0f);
+
+        std::vector<Sample> trace;
+        float t0 = sim.time();
+        float target = 90 + steps[n];
+        sim.gimbal().setAutoTarget(90, target, 90);
+        sim.run(4.0f, [&](Simulation& s) {
+            trace.push_back({s.time(), SERVO_CENTER + s.plant().cameraAngle(SIM_PITCH), target});
+        });
+        g_simulatedSeconds += sim.time();
+        if (n == 0) writeTrace("auto_step_scheduled", trace);
+        overshoot[n] = analyzeStep(trace, t0, 90, target, 1.0f).overshootPct;
+    }
+
+    return {
+        {"overshoot_10deg_pct", overshoot[0], 10.0f},
+        {"overshoot_20deg_pct", overshoot[1], 10.0f},
+    };
+}
+
+// A schedule that doubles kp while the pitch loop holds 20 deg above level.
+// With setpoint weighting the P term is not zero there, so the kp change has
+// to be taken over by the integral or the camera jumps.
+std::vector<Check> autoGainBumpless() {
+    const PIDShaping weighted = {0.0f, 0.8f, 0.0f, 0.0f, true};
+    Simulation sim;
+    sim.begin();
+    sim.gimbal().setPidShaping(weighted);
+    sim.gimbal().setMode(MODE_AUTO);
+    sim.gimbal().setAutoTarget(90, 110, 90);
+    sim.run(10.0f);
+    float held = sim.plant().cameraAngle(SIM_PITCH);
+
+    AppConfig config = sim.config().getConfig();
+    config.gainSchedule.count = 1;
+    config.gainSchedule.points[0] = {0.0f, 2.0f, 1.0f, 1.0f};
+    sim.config().updateConfig(config);
+
+    float jump = 0;
+    std::vector<Sample> trace;
+    sim.run(0.5f, [&](Simulation& s) {
+        jump = fmaxf(jump, fabsf(s.plant().cameraAngle(SIM_PITCH) - held));
+        trace.push_back({s.time(), s.plant().cameraAngle(SIM_PITCH), held});
+    });
+    g_simulatedSeconds += sim.time();
+    writeTrace("auto_gain_bumpless", trace);
+
+    return {
+        {"hold_error_deg", fabsf(held - 20.0f), 0.5f},
+        {"camera_jump_deg", jump, 0.2f},
+    };
+}
+
+// Guided calibration of a bowed, asymmetric pitch servo. The operator is
+// simulated: at each prompted angle it nudges the pulse by the remaining
+// error until the servo sits there, then captures.
+std::vector<Check> servoCalibration() {
+    Simulation sim;
+    sim.setServoNonlinearity(SIM_PITCH, {8.0f, 4.0f});
+    sim.begin();
+
+    // Between the calibration points, where interpolation has to do the work
+    const float probes[] = {15, 45, 75, 105, 135, 165};
+    auto worstError = [&]() {
+        float worst = 0;
+        for (float angle : probes) {
+            sim.gimbal().setManualPosition(90, angle, 90);
+            sim.run(1.5f);
+            worst = fmaxf(worst, fabsf(sim.plant().servoAngle(SIM_PITCH) - angle));
+        }
+        return worst;
+    };
+    float before = worstError();
+
+    const float usPerDeg = (Simulation::SERVO_US_AT_MAX - Simulation::SERVO_US_AT_MIN) / 180.0f;
+    CalibrationCapture result = sim.gimbal().startServoCalibration(AXIS_PITCH) ? CAL_CAPTURE_NEXT : CAL_CAPTURE_INACTIVE;
+    while (result == CAL_CAPTURE_NEXT) {
+        ServoCalibrationStatus status = sim.gimbal().getServoCalibrationStatus();
+        float pulse = status.pulseUs;
+        for (int i = 0; i < 10; i++) {
+            sim.gimbal().jogServoCalibration(pulse);
+            sim.run(1.0f);
+            float error = status.targetAngle - sim.plant().servoAngle(SIM_PITCH);
+            if (fabsf(error) < 0.05f) break;
+            pulse += error * usPerDeg;
+        }
+        result = sim.gimbal().captureServoCalibrationPoint();
+    }
+
+    float after = worstError();
+    g_simulatedSeconds += sim.time();
+
+    return {
+        {"calibration_incomplete", result == CAL_CAPTURE_DONE ? 0.0f : 1.0f, 0.0f},
+        {"calibrated_error_deg", after, 0.5f},
+        {"residual_ratio", after / before, 0.1f}, // Of the uncalibrated error
+    };
+}
+
+// Filtered pitch position after a 30 deg manual step, every 4 ms. The first
+// cycle that sees the command outputs where the filter is one period after
+// the step, so time counts from one period before it.
+std::vector<float> filteredStep(int controlRateHz, const OutputFilterConfig& filter) {
+    Simulation sim(1, controlRateHz);
+    AppConfig config = sim.config().getConfig();
+    for (int axis = 0; axis < AXIS_COUNT; axis++) config.output_filter[axis] = filter;
+    sim.config().updateConfig(config);
+    sim.begin();
+    sim.run(0.5f);
+
+    std::vector<float> trace;
+    float t0 = -1;
+    sim.gimbal().setManualPosition(90, 120, 90);
+    sim.run(2.0f, [&](Simulation& s) {
+        if (t0 < 0) t0 = s.time() - 1.0f / controlRateHz;
+        if (lroundf((s.time() - t0) * 1000.0f) % 4 == 0) trace.push_back(s.gimbal().getCurrentPosition().pitch);
+    });
+    g_simulatedSeconds += sim.time();
+    return trace;
+}
+
+float maxDifference(const std::vector<float>& a, const std::vector<float>& b) {
+    float worst = 0;
+    for (size_t i = 0; i < a.size() && i < b.size(); i++) worst = fmaxf(worst, fabsf(a[i] - b[i]));
+    return worst;
+}
+
+// Output filter bank: the same step at 500 Hz and 1 kHz loop rates, a notch
+// against a setpoint oscillating at its frequency, and the slew limit
+std::vector<Check> outputFilter() {
+    const OutputFilterConfig firstOrder = {OUTPUT_LOWPASS_FIRST_ORDER, SERVO_FILTER_LOWPASS_HZ, SERVO_FILTER_LOWPASS_Q, 0, SERVO_FILTER_NOTCH_Q, 0};
+    const OutputFilterConfig biquad = {OUTPUT_LOWPASS_BIQUAD, 3.0f, 0.7071f, 12.0f, 2.0f, 0};
+    float firstOrderMismatch = maxDifference(filteredStep(500, firstOrder), filteredStep(1000, firstOrder));
+    float biquadMismatch = maxDifference(filteredStep(500, biquad), filteredStep(1000, biquad));
+
+    const float notchHz = 8.0f;
+    const OutputFilterConfig notch = {OUTPUT_LOWPASS_OFF, SERVO_FILTER_LOWPASS_HZ, SERVO_FILTER_LOWPASS_Q, notchHz, 2.0f, 0};
+    Simulation sim;
+    AppConfig config = sim.config().getConfig();
+    config.output_filter[AXIS_PITCH] = notch;
+    sim.config().updateConfig(config);
+    sim.begin();
+    float lo = INFINITY, hi = -INFINITY;
+    sim.run(3.0f, [&](Simulation& s) {
+        float t = s.time();
+        s.gimbal().setManualPosition(90, 90 + 5.0f * sinf(2.0f * (float)M_PI * notchHz * t), 90);
+        if (t < 1.0f) return;
+        float pitch = s.gimbal().getCurrentPosition().pitch;
+        lo = fminf(lo, pitch);
+        hi = fmaxf(hi, pitch);
+    });
+    g_simulatedSeconds += sim.time();
+
+    const float slew = 90.0f;
+    Simulation slewSim;
+    config = slewSim.config().getConfig();
+    config.output_filter[AXIS_PITCH] = {OUTPUT_LOWPASS_OFF, SERVO_FILTER_LOWPASS_HZ, SERVO_FILTER_LOWPASS_Q, 0, SERVO_FILTER_NOTCH_Q, slew};
+    slewSim.config().updateConfig(config);
+    slewSim.begin();
+    slewSim.run(0.5f);
+    float peakRate = 0;
+    float previous = slewSim.gimbal().getCurrentPosition().pitch;
+    slewSim.gimbal().setManualPosition(90, 150, 90);
+    slewSim.run(1.0f, [&](Simulation& s) {
+        float pitch = s.gimbal().getCurrentPosition().pitch;
+        peakRate = fmaxf(peakRate, fabsf(pitch - previous) * CONTROL_LOOP_RATE_HZ);
+        previous = pitch;
+    });
+    g_simulatedSeconds += slewSim.time();
+
+    return {
+        {"rate_mismatch_1st_deg", firstOrderMismatch, 0.05f},
+        {"rate_mismatch_biquad_deg", biquadMismatch, 0.25f}, // Bilinear: half a period of hold delay
+        {"notch_residual_ratio", (hi - lo) / 2.0f / 5.0f, 0.1f},
+        {"slew_peak_ratio", peakRate / slew, 1.01f},
+    };
+}
+
+// Self-test in the control loop: the step response it measures through the
+// IMU against the servo angles the plant actually went through
+std::vector<Check> selfTest() {
+    Simulation sim;
+    sim.begin();
+    sim.run(1.0f);
+
+    float duration = sim.gimbal().startSelfTest();
+    std::vector<Sample> servo[AXIS_COUNT];
+    float stepStart[AXIS_COUNT] = {-1, -1, -1};
+    sim.run(duration + 0.5f, [&](Simulation& s) {
+        SelfTestStatus status = s.gimbal().getSelfTestStatus();
+        if (!status.active || status.phase != SELF_TEST_STEP) return;
+        // The tick that enters the step phase commands the step
+        if (stepStart[status.axis] < 0) stepStart[status.axis] = s.time();
+        servo[status.axis].push_back({s.time(), s.plant().servoAngle(status.axis), SERVO_CENTER + SELF_TEST_STEP_DEG});
+    });
+    g_simulatedSeconds += sim.time();
+    writeTrace("self_test", servo[AXIS_PITCH]);
+
+    SelfTestStatus status = sim.gimbal().getSelfTestStatus();
+    float worstGain = 0, worstRise = 0, worstSettling = 0;
+    for (int i = 0; i < AXIS_COUNT; i++) {
+        const AxisStepResult& r = status.result.axes[i];
+        if (!r.measured || !r.responded) return {{"axes_unmeasured", 1, 0}};
+        StepMetrics truth = analyzeStep(servo[i], stepStart[i], SERVO_CENTER, SERVO_CENTER + SELF_TEST_STEP_DEG,
+                                        SELF_TEST_STEP_DEG * SELF_TEST_SETTLE_BAND_PCT / 100.0f);
+        worstGain = fmaxf(worstGain, fabsf(r.gain - 1.0f));
+        worstRise = fmaxf(worstRise, fabsf(r.riseTime - truth.riseTime));
+        worstSettling = fmaxf(worstSettling, fabsf(r.settlingTime - truth.settlingTime));
+    }
+    float home = fabsf(sim.gimbal().getCurrentPosition().pitch - SERVO_CENTER);
+
+    return {
+        {"incomplete", status.result.complete ? 0.0f : 1.0f, 0.0f},
+        {"gain_error", worstGain, 0.1f},
+        {"rise_error_s", worstRise, 0.05f},
+        {"settling_error_s", worstSettling, 0.1f},
+        {"home_error_deg", home, 0.1f},
+    };
+}
+
+// Relay autotune of every axis on a still base, then the default rule's
+// gains accepted and checked on an auto step and against base motion. The
+// loop integrates (the correction moves the filtered position), so the
+// Ziegler-Nichols family of rules rings here; Tyreus-Luyben does not.
+std::vector<Check> autotune() {
+    Simulation sim;
+    sim.begin();
+    sim.gimbal().setMode(MODE_AUTO);
+    sim.gimbal().setAutoTarget(90, 90, 90);
+    sim.run(2.0f);
+
+    const bool axes[AXIS_COUNT] = {true, true, true};
+    bool started = sim.gimbal().startAutotune(axes);
+    float worstError = 0;
+    while (started && sim.gimbal().getAutotuneStatus().active && sim.time() < 60.0f) {
+        sim.run(0.1f, [&](Simulation& s) {
+            worstError = fmaxf(worstError, fabsf(s.plant().cameraAngle(SIM_PITCH)));
+            worstError = fmaxf(worstError, fabsf(s.plant().cameraAngle(SIM_ROLL)));
+        });
+    }
+    AutotuneStatus status = sim.gimbal().getAutotuneStatus();
+    int done = 0;
+    for (int i = 0; i < AXIS_COUNT; i++) done += status.axes[i].status == AUTOTUNE_DONE;
+    sim.gimbal().acceptAutotune(AUTOTUNE_DEFAULT_RULE);
+    sim.run(2.0f);
+
+    std::vector<Sample> trace;
+    float t0 = sim.time();
+    sim.gimbal().setAutoTarget(90, 100, 90);
+    sim.run(4.0f, [&](Simulation& s) {
+        trace.push_back({s.time(), SERVO_CENTER + s.plant().cameraAngle(SIM_PITCH), 100});
+    });
+    StepMetrics step = analyzeStep(trace, t0, 90, 100, 1.0f);
+    writeTrace("autotune", trace);
+
+    sim.gimbal().setAutoTarget(90, 90, 90);
+    sim.plant().setBaseMotion(SIM_PITCH, {0, 5.0f, 0.5f});
+    sim.plant().setBaseMotion(SIM_ROLL, {0, 5.0f, 0.3f});
+    std::vector<Sample> pitch;
+    float t1 = sim.time();
+    sim.run(12.0f, [&](Simulation& s) {
+        pitch.push_back({s.time(), s.plant().cameraAngle(SIM_PITCH), 0});
+    });
+    g_simulatedSeconds += sim.time();
+
+    return {
+        {"axes_not_tuned", (float)(AXIS_COUNT - done), 0.0f},
+        {"relay_error_max_deg", worstError, 3.0f},
+        {"step_settling_time_s", step.settlingTime, 1.5f},
+        // Without setpoint weighting (PID_SETPOINT_WEIGHT 1) the full P term
+        // acts on the step
+        {"step_overshoot_pct", step.overshootPct, 20.0f},
+        {"pitch_residual_ratio", rms(pitch, t1 + 2.0f) / (5.0f / sqrtf(2.0f)), 0.3f},
+    };
+}
+
+std::vector<Check> estimatorDrift() {
+    Simulation sim;
+    sim.begin();
+    sim.plant().setBaseMotion(SIM_PITCH, {8.0f, 0, 0});
+    sim.plant().setBaseMotion(SIM_ROLL, {-5.0f, 0, 0});
+
+    float worst = 0;
+    std::vector<Sample> trace;
+    sim.run(120.0f, [&](Simulation& s) {
+        AttitudeEstimate e = s.estimator().getEstimate();
+        if (!e.valid || s.time() < 1.0f) return;
+        float errPitch = fabsf(e.pitch - s.plant().cameraAngle(SIM_PITCH));
+        float errRoll = fabsf(e.roll - s.plant().cameraAngle(SIM_ROLL));
+        worst = fmaxf(worst, fmaxf(errPitch, errRoll));
+        trace.push_back({s.time(), e.pitch, s.plant().cameraAngle(SIM_PITCH)});
+    });
+    g_simulatedSeconds += sim.time();
+    writeTrace("estimator_drift", trace);
+
+    return {
+        {"max_tilt_error_deg", worst, 1.5f},
+    };
+}
+
+// Camera yaw creep over a minute of auto-mode hold while the IMU warms up
+// by 10 C, with the bias random walk off so only temperature moves it
+float simulateYawCreep(const ImuCalibration& cal) {
+    Simulation sim;
+    ImuErrorParams imu = SimImu::defaultErrorParams();
+    imu.gyroBiasWalk = 0;
+    imu.tempRampPerMin = 10.0f;
+    sim.imu().setErrorParams(imu);
+    AppConfig config = sim.config().getConfig();
+    config.imu_calibration = cal;
+    sim.config().updateConfig(config);
+    sim.begin();
+    sim.gimbal().setMode(MODE_AUTO);
+    sim.gimbal().setAutoTarget(90, 90, 90);
+    sim.run(2.0f);
+    float start = sim.plant().cameraAngle(SIM_YAW);
+    sim.run(60.0f);
+    g_simulatedSeconds += sim.time();
+    return fabsf(sim.plant().cameraAngle(SIM_YAW) - start);
+}
+
+// Tilt estimate error on a level base, after the estimator has converged
+float simulateLevelTilt(const ImuErrorParams& imu, const ImuCalibration& cal) {
+    Simulation sim;
+    sim.imu().setErrorParams(imu);
+    AppConfig config = sim.config().getConfig();
+    config.imu_calibration = cal;
+    sim.config().updateConfig(config);
+    sim.begin();
+    sim.run(5.0f);
+    g_simulatedSeconds += sim.time();
+    AttitudeEstimate e = sim.estimator().getEstimate();
+    return fmaxf(fabsf(e.pitch - sim.plant().cameraAngle(SIM_PITCH)),
+                 fabsf(e.roll - sim.plant().cameraAngle(SIM_ROLL)));
+}
+
+// Gyro bias captured at boot and tracked at rest through a fast warm-up, the
+// temperature polynomial fitted from the rest bins and used in auto mode,
+// then a six-position accelerometer calibration against offset/scale errors
+std::vector<Check> imuCalibration() {
+    const float RAD_TO_DEG_F = 57.29578f;
+    Simulation sim;
+    ImuErrorParams imu = SimImu::defaultErrorParams();
+    imu.gyroBiasWalk = 0;
+    imu.tempRampPerMin = 10.0f;
+    sim.imu().setErrorParams(imu);
+    sim.begin();
+
+    // True bias at the current temperature vs what the corrector removes
+    auto biasError = [&](Simulation& s) {
+        float tempBias = imu.gyroTempCoeff * (s.imu().temperature() - 25.0f);
+        const ImuCorrectorStatus& st = s.imuCorrector().status();
+        float worst = 0;
+        for (int i = 0; i < 3; i++) worst = fmaxf(worst, fabsf(st.bias[i] - (imu.gyroBias[i] + tempBias)));
+        return worst * RAD_TO_DEG_F;
+    };
+    sim.run(1.5f);
+    bool locked = sim.imuCorrector().status().biasLocked;
+    float bootError = biasError(sim);
+
+    float trackError = 0, yawStart = 0;
+    sim.run(118.5f, [&](Simulation& s) {
+        if (s.time() < 60.0f) return;
+        if (yawStart == 0) yawStart = s.estimator().getEstimate().yaw;
+        trackError = fmaxf(trackError, biasError(s));
+    });
+    float restDrift = fabsf(sim.estimator().getEstimate().yaw - yawStart) / 60.0f;
+
+    ImuCalibration cal = defaultImuCalibration();
+    int bins = fitGyroTempPolynomial(sim.imuCorrector().status().table, IMU_TEMP_FIT_MIN_WINDOWS,
+                                     IMU_TEMP_FIT_MIN_SPAN_C, cal);
+    float slopeError = fabsf(cal.gyroTemp[2][1] - imu.gyroTempCoeff) / imu.gyroTempCoeff;
+    float creep = simulateYawCreep(cal);
+    float creepUncompensated = simulateYawCreep(defaultImuCalibration());
+
+    // Six faces: each base orientation puts one body axis up or down
+    Simulation accelSim;
+    ImuErrorParams accelImu = SimImu::defaultErrorParams();
+    const float offset[3] = {0.3f, -0.2f, 0.4f};
+    const float scale[3] = {1.02f, 0.98f, 1.01f};
+    memcpy(accelImu.accelOffset, offset, sizeof(offset));
+    memcpy(accelImu.accelScale, scale, sizeof(scale));
+    accelSim.imu().setErrorParams(accelImu);
+    accelSim.begin();
+    const float faces[ACCEL_FACE_COUNT][2] = { // {pitch, roll} of the base
+        {-90, 0}, {90, 0}, {0, 90}, {0, -90}, {0, 0}, {0, 180},
+    };
+    AccelCalibrationSession session;
+    session.start();
+    CalibrationCapture result = CAL_CAPTURE_INACTIVE;
+    for (int f = 0; f < ACCEL_FACE_COUNT; f++) {
+        accelSim.plant().setBaseMotion(SIM_PITCH, {faces[f][0], 0, 0});
+        accelSim.plant().setBaseMotion(SIM_ROLL, {faces[f][1], 0, 0});
+        accelSim.run(1.5f);
+        const ImuCorrectorStatus& st = accelSim.imuCorrector().status();
+        if (st.atRest) result = session.capture(st.restAccel);
+    }
+    ImuCalibration accelCal = defaultImuCalibration();
+    bool solved = result == CAL_CAPTURE_DONE && session.solve(accelCal);
+    float offsetError = 0, scaleError = 0;
+    for (int i = 0; i < 3; i++) {
+        offsetError = fmaxf(offsetError, fabsf(accelCal.accelOffset[i] - offset[i]));
+        scaleError = fmaxf(scaleError, fabsf(accelCal.accelScale[i] * scale[i] - 1.0f) * 100.0f);
+    }
+
+    g_simulatedSeconds += sim.time() + accelSim.time();
+    float tilt = simulateLevelTilt(accelImu, accelCal);
+    float tiltUncalibrated = simulateLevelTilt(accelImu, defaultImuCalibration());
+
+    return {
+        {"boot_not_locked", locked ? 0.0f : 1.0f, 0.0f},
+        {"boot_bias_error_dps", bootError, 0.05f},
+        {"tracked_bias_error_dps", trackError, 0.1f},
+        {"rest_yaw_drift_dps", restDrift, 0.1f}, // Tracking lag behind the 10 C/min warm-up
+        {"temp_fit_failed", bins > 0 ? 0.0f : 1.0f, 0.0f},
+        {"temp_slope_error", slopeError, 0.1f},
+        {"auto_yaw_creep_deg", creep, 1.0f},
+        {"creep_ratio", creepUncompensated > 0 ? creep / creepUncompensated : 1.0f, 0.2f},
+        {"accel_unsolved", solved ? 0.0f : 1.0f, 0.0f},
+        {"accel_offset_error_ms2", offsetError, 0.05f},
+        {"accel_scale_error_pct", scaleError, 0.5f},
+        {"level_tilt_error_deg", tilt, 0.3f},
+        {"tilt_error_ratio", tiltUncalibrated > 0 ? tilt / tiltUncalibrated : 1.0f, 0.2f},
+    };
+}
+
+// Saturation-triggered capture of an auto hold pushed past the servo range,
+// checked record by record against what the loop actually did, then a manual
+// trigger and the download path. --trace also writes flight_recorder.gfr,
+// the download format, for decode_flight_recording.py.
+std::vector<Check> flightRecorder() {
+    const uint32_t CAPACITY = 4096; // 8.2 s at 500 Hz
+    std::vector<FlightRecord> buffer(CAPACITY);
+    FlightRecorder recorder;
+    recorder.begin(buffer.data(), CAPACITY);
+
+    Simulation sim;
+    sim.setFlightRecorder(&recorder);
+    sim.begin();
+    const uint16_t SATURATION_CYCLES = 50;
+    recorder.arm({1 << FLIGHT_TRIGGER_SATURATION, 50, SATURATION_CYCLES, 10.0f});
+    sim.gimbal().setMode(MODE_AUTO);
+    sim.gimbal().setAutoTarget(90, 90, 90);
+
+    // What the loop did each cycle, keyed by the record timestamp
+    struct Truth {
+        float pitch;
+        float pulseUs;
+    };
+    std::map<uint32_t, Truth> truth;
+    auto observe = [&](Simulation& s) {
+        uint32_t us = (uint32_t)(s.time() * 1e6f + 0.5f);
+        truth[us] = {s.gimbal().getAttitude().pitch, simPulseUs(SERVO_PIN_PITCH)};
+    };
+    sim.run(5.0f, observe);
+    // 100 deg of base pitch is past the servo's reach: the correction pins
+    sim.plant().setBaseMotion(SIM_PITCH, {100.0f, 0, 0});
+    while (recorder.status().state != FLIGHT_CAPTURED && sim.time() < 15.0f) {
+        sim.run(0.1f, observe);
+    }
+    FlightRecorderStatus status = recorder.status();
+
+    std::vector<FlightRecord> capture(status.count);
+    size_t copied = 0;
+    while (copied < capture.size()) {
+        size_t n = recorder.read(status.generation, copied, &capture[copied], 7); // Odd chunks, as a download would
+        if (n == 0) break;
+        copied += n;
+    }
+
+    int gaps = 0, unmatched = 0;
+    float attitudeError = 0, pulseError = 0;
+    int firstSaturated = -1;
+    for (size_t i = 0; i < copied; i++) {
+        const FlightRecord& r = capture[i];
+        if (i > 0 && abs((int)(r.timeUs - capture[i - 1].timeUs) - r.dtUs) > 2) gaps++;
+        auto it = truth.find(r.timeUs);
+        if (it == truth.end()) {
+            unmatched++;
+            continue;
+        }
+        attitudeError = fmaxf(attitudeError, fabsf(r.attitude[AXIS_PITCH] / 100.0f - it->second.pitch));
+        pulseError = fmaxf(pulseError, fabsf(r.servoQuarterUs[AXIS_PITCH] / 4.0f - it->second.pulseUs));
+        bool saturated = r.flags & (FLIGHT_FLAG_SATURATED << AXIS_PITCH);
+        if (!saturated) firstSaturated = -1;
+        else if (firstSaturated < 0) firstSaturated = (int)i;
+        if (r.flags & FLIGHT_FLAG_TRIGGER) break;
+    }
+    float triggerDelay = firstSaturated < 0 ? INFINITY
+        : fabsf((float)((int)status.triggerIndex - firstSaturated + 1 - SATURATION_CYCLES));
+    bool triggerFlagged = status.triggerIndex < copied && (capture[status.triggerIndex].flags & FLIGHT_FLAG_TRIGGER);
+
+    if (g_trace && copied == status.count) {
+        FILE* f = fopen("flight_recorder.gfr", "wb");
+        if (f) {
+            FlightCaptureHeader header = makeFlightCaptureHeader(status, CONTROL_LOOP_RATE_HZ,
+                                                                 Simulation::ACCEL_LSB_PER_G,
+                                                                 Simulation::GYRO_LSB_PER_DPS);
+            fwrite(&header, sizeof(header), 1, f);
+            fwrite(capture.data(), sizeof(FlightRecord), copied, f);
+            fclose(f);
+        }
+    }
+
+    // Manual trigger with everything kept from before it freezes at once;
+    // re-arming invalidates the old capture for readers
+    recorder.arm({0, 100, 1, 10.0f});
+    sim.run(1.0f);
+    recorder.trigger();
+    sim.run(0.1f);
+    FlightRecorderStatus manual = recorder.status();
+    FlightRecord stale;
+    size_t staleRecords = recorder.read(status.generation, 0, &stale, 1);
+    bool manualOk = manual.state == FLIGHT_CAPTURED && manual.cause == FLIGHT_TRIGGER_MANUAL &&
+                    manual.triggerIndex == manual.count - 1;
+    g_simulatedSeconds += sim.time();
+
+    return {
+        {"not_captured", status.state == FLIGHT_CAPTURED && status.cause == FLIGHT_TRIGGER_SATURATION ? 0.0f : 1.0f, 0.0f},
+        {"records_missing", (float)(CAPACITY - copied), 0.0f},
+        {"trigger_delay_cycles", triggerDelay, 0.0f},
+        {"trigger_not_flagged", triggerFlagged ? 0.0f : 1.0f, 0.0f},
+        {"timestamp_gaps", (float)gaps, 0.0f},
+        {"unmatched_records", (float)unmatched, 0.0f},
+        {"attitude_error_deg", attitudeError, 0.006f}, // 0.01 deg resolution
+        {"pulse_error_us", pulseError, 1.25f},         // Commanded vs. LEDC output: one 14-bit count at 50 Hz
+        {"manual_not_captured", manualOk ? 0.0f : 1.0f, 0.0f},
+        {"stale_read_records", (float)staleRecords, 0.0f},
+    };
+}
+
+// Deferred log: four producer threads against one consumer on a ring, every
+// record accounted for as delivered intact and in order or counted as
+// dropped; the ring's exact capacity; the formatter against printf; and a
+// controller call site landing in the firmware's log.
+std::vector<Check> eventLogScenario() {
+    const int PRODUCERS = 4;
+    const int PER_PRODUCER = 50000;
+    std::unique_ptr<EventLog> log(new EventLog());
+    std::atomic<int> running(PRODUCERS);
+    std::vector<std::thread> producers;
+    for (int p = 0; p < PRODUCERS; p++) {
+        producers.emplace_back([&, p]() {
+            for (int n = 0; n < PER_PRODUCER; n++) {
+                // The floats are derived from n, so a torn record shows up
+                const LogArg args[] = {logArg(AXIS_NAMES[p % AXIS_COUNT]), logArg((float)n),
+                                       logArg((float)n * 2.0f), logArg((float)(p + 1)), logArg(p)};
+                log->write(LOG_LEVEL_INFO, LOG_SELF_TEST_AXIS, args, 5);
+            }
+            running--;
+        });
+    }
+    int received = 0, torn = 0, outOfOrder = 0;
+    std::vector<int> last(PRODUCERS, -1);
+    LogRecord record;
+    for (;;) {
+        bool done = running.load() == 0; // Checked before the read, so nothing is left behind
+        if (!log->read(record)) {
+            if (done) break;
+            std::this_thread::yield();
+            continue;
+        }
+        received++;
+        int p = record.args[4].i;
+        int n = (int)record.args[1].f;
+        if (record.message != LOG_SELF_TEST_AXIS || record.argCount != 5 || p < 0 || p >= PRODUCERS ||
+            record.args[0].s != AXIS_NAMES[p % AXIS_COUNT] || record.args[2].f != n * 2.0f ||
+            record.args[3].f != (float)(p + 1)) {
+            torn++;
+            continue;
+        }
+        if (n <= last[p]) outOfOrder++;
+        last[p] = n;
+    }
+    for (std::thread& t : producers) t.join();
+    int lost = PRODUCERS * PER_PRODUCER - received - (int)log->getDroppedCount();
+
+    // Without a consumer exactly CAPACITY records fit
+    std::unique_ptr<EventLog> full(new EventLog());
+    for (uint32_t i = 0; i <= EventLog::CAPACITY; i++) {
+        full->write(LOG_LEVEL_WARN, LOG_WIFI_LOST, nullptr, 0);
+    }
+    bool capacityOk = full->getWrittenCount() == EventLog::CAPACITY && full->getDroppedCount() == 1;
+
+    // Formatting, including a missing argument and a mismatched one
+    struct FormatCase {
+        LogMessage message;
+        std::vector<LogArg> args;
+        const char* expected;
+    };
+    const FormatCase cases[] = {
+        {LOG_SELF_TEST_AXIS, {logArg("roll"), logArg(1.234f), logArg(50.4f), logArg(0.25f), logArg(12.25f)},
+         "  roll  gain 1.23  rise 50 ms  settle 0 ms  overshoot 12.2%"},
+        {LOG_SERVO_CALIBRATION_STORED, {logArg(2), logArg(7u)}, "Servo calibration stored for axis 2 (7 points)"},
+        {LOG_AUTOTUNE_STORED, {logArg("no_overshoot")}, "Autotune gains (no_overshoot) stored for ? axes"},
+        {LOG_BLE_MODE, {logArg("x")}, "BLE mode change: ?"},
+        {LOG_DROPPED, {logArg(3u)}, "3 log message(s) dropped"},
+    };
+    int formatMismatches = 0;
+    for (const FormatCase& c : cases) {
+        LogRecord r = {};
+        r.message = c.message;
+        r.argCount = (uint8_t)c.args.size();
+        memcpy(r.args, c.args.data(), c.args.size() * sizeof(LogArg));
+        char text[LOG_LINE_LENGTH];
+        formatLogMessage(r, text, sizeof(text));
+        if (strcmp(text, c.expected) != 0) {
+            printf("  format: \"%s\", expected \"%s\"\n", text, c.expected);
+            formatMismatches++;
+        }
+    }
+    LogRecord longRecord = {};
+    longRecord.message = LOG_ACCEL_CALIBRATION_STORED;
+    longRecord.argCount = 6;
+    for (int i = 0; i < 6; i++) longRecord.args[i] = logArg(-12345.678f);
+    char shortLine[32];
+    size_t shortLength = formatLogLine(longRecord, shortLine, sizeof(shortLine));
+    if (shortLength != sizeof(shortLine) - 1 || strlen(shortLine) != shortLength) formatMismatches++;
+
+    // A controller call site goes through the firmware's log
+    while (eventLog.read(record)) {}
+    Simulation sim;
+    sim.begin();
+    sim.gimbal().setManualPosition(80, 95, 100);
+    sim.run(1.0f);
+    sim.gimbal().setFlatReference();
+    const float target[AXIS_COUNT] = {80, 95, 100};
+    bool callSiteOk = eventLog.read(record) && record.message == LOG_FLAT_REFERENCE &&
+                      record.level == LOG_LEVEL_INFO && record.argCount == AXIS_COUNT;
+    for (int i = 0; callSiteOk && i < AXIS_COUNT; i++) {
+        callSiteOk = fabsf(record.args[i].f - target[i]) < 0.1f;
+    }
+    g_simulatedSeconds += sim.time();
+
+    return {
+        {"lost_records", (float)lost, 0.0f},
+        {"torn_records", (float)torn, 0.0f},
+        {"out_of_order", (float)outOfOrder, 0.0f},
+        {"capacity_mismatch", capacityOk ? 0.0f : 1.0f, 0.0f},
+        {"format_mismatches", (float)formatMismatches, 0.0f},
+        {"call_site_missing", callSiteOk ? 0.0f : 1.0f, 0.0f},
+    };
+}
+
+struct Scenario {
+    const char* name;
+    std::vector<Check> (*run)();
+};
+
+const Scenario SCENARIOS[] = {
+    {"manual_step", manualStep},
+    {"timed_move", timedMove},
+    {"trajectory_spline", trajectorySpline},
+    {"auto_step", autoStep},
+    {"auto_disturbance", autoDisturbance},
+    {"auto_hold", autoHold},
+    {"auto_gain_switch", autoGainSwitch},
+    {"auto_gain_bumpless", autoGainBumpless},
+    {"auto_step_scheduled", autoStepScheduled},
+    {"servo_calibration", servoCalibration},
+    {"output_filter", outputFilter},
+    {"self_test", selfTest},
+    {"autotune", autotune},
+    {"estimator_drift", estimatorDrift},
+    {"imu_calibration", imuCalibration},
+    {"flight_recorder", flightRecorder},
+    {"event_log", eventLogScenario},
+};
+
+// Side-by-side step response, disturbance rejection and noise chatter of the
+// auto loop with and without PID shaping. Informational, always exits 0.
+int runBenchmark() {
+    const PIDShaping shaped = {PID_DERIVATIVE_TAU, PID_SETPOINT_WEIGHT, PID_FEEDFORWARD_GAIN,
+                               PID_OUTPUT_RATE_LIMIT, true};
+    const PIDShaping* variants[] = {&UNSHAPED, &shaped};
+    float values[2][7];
+
+    for (int v = 0; v < 2; v++) {
+        std::vector<Sample> trace, pitch, roll;
+        AutoStepResult step = simulateAutoStep(variants[v], trace);
+        float pitchRatio, rollRatio;
+        simulateDisturbance(variants[v], pitch, roll, pitchRatio, rollRatio);
+        values[v][0] = step.step.riseTime;
+        values[v][1] = step.step.settlingTime;
+        values[v][2] = step.step.overshootPct;
+        values[v][3] = step.trackingRms;
+        values[v][4] = pitchRatio;
+        values[v][5] = rollRatio;
+        values[v][6] = simulateHoldChatter(variants[v]);
+    }
+
+    const char* metrics[] = {
+        "step_rise_time_s", "step_settling_time_s", "step_overshoot_pct", "step_tracking_rms_deg",
+        "pitch_residual_ratio", "roll_residual_ratio", "hold_servo_rate_rms_dps",
+    };
+    printf("PID shaping: derivative tau %.3f s, setpoint weight %.2f, feed-forward %.2f, rate limit %.0f deg/s\n\n",
+           shaped.derivativeTau, shaped.setpointWeight, shaped.feedForwardGain, shaped.outputRateLimit);
+    printf("%-26s %10s %10s %9s\n", "metric", "unshaped", "shaped", "change");
+    for (int i = 0; i < 7; i++) {
+        float change = values[0][i] != 0 ? (values[1][i] - values[0][i]) / values[0][i] * 100.0f : 0.0f;
+        printf("%-26s %10.3f %10.3f %8.1f%%\n", metrics[i], values[0][i], values[1][i], change);
+    }
+    return 0;
+}
+
+uint32_t hostNanos() {
+    return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Host timing of one auto cycle through AxisKernel vs the scalar
+// PIDController path. Absolute numbers are for this machine only; run
+// GET /api/perf/kernel for ESP32-S3 cycles. Exits non-zero if the two paths
+// disagree.
+int runKernelBenchmark() {
+    const PIDShaping shaping = {PID_DERIVATIVE_TAU, PID_SETPOINT_WEIGHT, PID_FEEDFORWARD_GAIN,
+                                PID_OUTPUT_RATE_LIMIT, true};
+    const PidGains gains[AXIS_COUNT] = {
+        {KP_YAW, KI_YAW, KD_YAW}, {KP_PITCH, KI_PITCH, KD_PITCH}, {KP_ROLL, KI_ROLL, KD_ROLL},
+    };
+    const float dt = 1.0f / CONTROL_LOOP_RATE_HZ;
+    KernelBenchmarkResult r = ::runKernelBenchmark(shaping, gains, dt, 200000, hostNanos);
+
+    printf("%-22s %10s\n", "path", "ns/cycle");
+    printf("%-22s %10.1f\n", "scalar (PIDController)", r.scalarTicks);
+    printf("%-22s %10.1f\n", "AxisKernel", r.kernelTicks);
+    printf("\nspeedup %.2fx over %u cycles, max difference %.2e deg\n",
+           r.kernelTicks > 0 ? r.scalarTicks / r.kernelTicks : 0.0f, r.iterations, r.maxDifference);
+    return r.maxDifference < 1e-3f ? 0 : 1;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const char* only = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--trace") == 0) {
+            g_trace = true;
+        } else if (strcmp(argv[i], "--benchmark") == 0) {
+            return runBenchmark();
+        } else if (strcmp(argv[i], "--kernel-bench") == 0) {
+            return runKernelBenchmark();
+        } else {
+            only = argv[i];
+        }
+    }
+
+    auto wallStart = std::chrono::steady_clock::now();
+    int failures = 0;
+    int ran = 0;
+
+    printf("%-18s %-24s %10s %10s\n", "scenario", "metric", "value", "limit");
+    for (const Scenario& scenario : SCENARIOS) {
+        if (only && strcmp(only, scenario.name) != 0) continue;
+        ran++;
+        for (const Check& c : scenario.run()) {
+            bool pass = c.value <= c.limit;
+            if (!pass) failures++;
+            printf("%-18s %-24s %10.3f %10.3f  %s\n",
+                   scenario.name, c.metric, c.value, c.limit, pass ? "ok" : "FAIL");
+        }
+    }
+
+    if (ran == 0) {
+        fprintf(stderr, "Unknown scenario '%s'\n", only);
+        return 2;
+    }
+
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    printf("\nSimulated %.1f s in %.3f s (%.0fx real time), %d failure(s)\n",
+           g_simulatedSeconds, wall, wall > 0 ? g_simulatedSeconds / wall : 0.0, failures);
+    return failures ? 1 : 0;
+}
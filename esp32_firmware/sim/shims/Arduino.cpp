@@ -0,0 +1,50 @@
+#include <Arduino.h>
+#include <map>
+
+SimSerial Serial;
+
+static uint64_t s_micros = 0;
+struct LedcChannel {
+    uint32_t freq = 0;
+    uint8_t bits = 0;
+    uint32_t duty = 0;
+    bool written = false;
+};
+static std::map<int, LedcChannel> s_ledc;
+static std::map<int, int> s_channelByPin;
+
+uint64_t simMicros() { return s_micros; }
+void simAdvanceMicros(uint64_t us) { s_micros += us; }
+
+uint32_t ledcSetup(uint8_t channel, uint32_t freq, uint8_t resolutionBits) {
+    s_ledc[channel].freq = freq;
+    s_ledc[channel].bits = resolutionBits;
+    return freq;
+}
+
+void ledcAttachPin(uint8_t pin, uint8_t channel) {
+    s_channelByPin[pin] = channel;
+}
+
+void ledcWrite(uint8_t channel, uint32_t duty) {
+    s_ledc[channel].duty = duty;
+    s_ledc[channel].written = true;
+}
+
+static const LedcChannel* channelForPin(int pin) {
+    auto it = s_channelByPin.find(pin);
+    if (it == s_channelByPin.end()) return nullptr;
+    auto ch = s_ledc.find(it->second);
+    return ch == s_ledc.end() ? nullptr : &ch->second;
+}
+
+float simPulseUs(int pin) {
+    const LedcChannel* ch = channelForPin(pin);
+    if (!ch || !ch->written || ch->freq == 0) return 0;
+    return ch->duty * 1e6f / ((float)ch->freq * (float)(1UL << ch->bits));
+}
+
+uint32_t simRefreshHz(int pin) {
+    const LedcChannel* ch = channelForPin(pin);
+    return ch ? ch->freq : 0;
+}
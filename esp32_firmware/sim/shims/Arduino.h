@@ -0,0 +1,79 @@
+#pragma once
+// Host shim for the subset of the Arduino/ESP32 API used by src/Domain and
+// ServoOutput.
+// Time comes from the simulator clock, so millis()/micros() advance only when
+// the simulation steps, and FreeRTOS mutexes are no-ops (single-threaded).
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#define IRAM_ATTR
+
+// --- Simulator clock ---
+uint64_t simMicros();
+void simAdvanceMicros(uint64_t us);
+
+inline unsigned long millis() { return (unsigned long)(simMicros() / 1000); }
+inline unsigned long micros() { return (unsigned long)simMicros(); }
+inline void delay(unsigned long ms) { simAdvanceMicros((uint64_t)ms * 1000); }
+
+// --- String ---
+class String {
+public:
+    String() {}
+    String(const char* s) : _s(s ? s : "") {}
+    String(const std::string& s) : _s(s) {}
+    const char* c_str() const { return _s.c_str(); }
+    unsigned int length() const { return (unsigned int)_s.size(); }
+    bool isEmpty() const { return _s.empty(); }
+    bool operator==(const char* s) const { return _s == s; }
+    bool operator!=(const char* s) const { return _s != s; }
+private:
+    std::string _s;
+};
+
+// --- Serial (quiet unless SIM_VERBOSE is set) ---
+class SimSerial {
+public:
+    void begin(unsigned long) {}
+    template <typename... Args>
+    void printf(const char* fmt, Args... args) {
+#ifdef SIM_VERBOSE
+        ::printf(fmt, args...);
+#else
+        (void)fmt;
+#endif
+    }
+    void print(const char* s) { printf("%s", s); }
+    void println(const char* s = "") { printf("%s\n", s); }
+};
+extern SimSerial Serial;
+
+// --- FreeRTOS ---
+typedef void* SemaphoreHandle_t;
+typedef void* TaskHandle_t;
+typedef int BaseType_t;
+typedef uint32_t TickType_t;
+#define portMAX_DELAY 0xFFFFFFFFu
+#define pdTRUE 1
+#define pdFALSE 0
+
+inline SemaphoreHandle_t xSemaphoreCreateMutex() { return (SemaphoreHandle_t)1; }
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t, TickType_t) { return pdTRUE; }
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t) { return pdTRUE; }
+
+// --- LEDC ---
+// Records each channel's timing and duty per attached pin so the simulator
+// can read back the pulse the servo would see
+uint32_t ledcSetup(uint8_t channel, uint32_t freq, uint8_t resolutionBits);
+void ledcAttachPin(uint8_t pin, uint8_t channel);
+void ledcWrite(uint8_t channel, uint32_t duty);
+
+// Last pulse on a pin in microseconds (0 if nothing was written) and the
+// channel's refresh rate in Hz
+float simPulseUs(int pin);
+uint32_t simRefreshHz(int pin);
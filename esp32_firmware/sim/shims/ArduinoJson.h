@@ -0,0 +1,6 @@
+#pragma once
+// Declarations only on the host: ConfigManager.h includes it, but the
+// simulator links SimConfigManager.cpp instead of the LittleFS/JSON
+// implementation, so the JSON helpers are never defined or called.
+class JsonObject;
+class JsonObjectConst;
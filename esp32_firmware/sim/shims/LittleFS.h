@@ -0,0 +1,2 @@
+#pragma once
+// Empty on the host: see ArduinoJson.h shim.
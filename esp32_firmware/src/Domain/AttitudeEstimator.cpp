@@ -0,0 +1,200 @@
+#include "AttitudeEstimator.h"
+#include <math.h>
+
+namespace {
+const float RAD_TO_DEG_F = 57.2957795f;
+const float GRAVITY = 9.80665f;
+
+// Accelerometer correction is skipped while the measured specific force is
+// far from 1 g (the sensor is being shaken or accelerated)
+const float ACCEL_GATE_MIN = 0.75f * GRAVITY;
+const float ACCEL_GATE_MAX = 1.25f * GRAVITY;
+
+const float DEFAULT_TAU = 0.5f;       // Complementary crossover, seconds
+const float DEFAULT_MAHONY_KP = 1.0f;
+const float DEFAULT_MAHONY_KI = 0.02f;
+
+float wrapPi(float angle) {
+    while (angle > (float)M_PI) angle -= 2.0f * (float)M_PI;
+    while (angle < -(float)M_PI) angle += 2.0f * (float)M_PI;
+    return angle;
+}
+}
+
+AttitudeEstimator::AttitudeEstimator(EstimatorType type)
+    : _type(type),
+      _initialized(false),
+      _tau(DEFAULT_TAU),
+      _roll(0), _pitch(0), _yaw(0),
+      _rateX(0), _rateY(0), _rateZ(0),
+      _kp(DEFAULT_MAHONY_KP), _ki(DEFAULT_MAHONY_KI),
+      _q0(1), _q1(0), _q2(0), _q3(0),
+      _integralX(0), _integralY(0), _integralZ(0)
+{}
+
+void AttitudeEstimator::setType(EstimatorType type) {
+    if (type == _type) return;
+    _type = type;
+
+    // Carry the current attitude over so switching filters causes no jump
+    if (_type == EstimatorType::MAHONY) {
+        seedQuaternion();
+    }
+}
+
+void AttitudeEstimator::seedQuaternion() {
+    float cr = cosf(_roll * 0.5f), sr = sinf(_roll * 0.5f);
+    float cp = cosf(_pitch * 0.5f), sp = sinf(_pitch * 0.5f);
+    float cy = cosf(_yaw * 0.5f), sy = sinf(_yaw * 0.5f);
+    _q0 = cr * cp * cy + sr * sp * sy;
+    _q1 = sr * cp * cy - cr * sp * sy;
+    _q2 = cr * sp * cy + sr * cp * sy;
+    _q3 = cr * cp * sy - sr * sp * cy;
+    _integralX = _integralY = _integralZ = 0;
+}
+
+void AttitudeEstimator::setComplementaryTimeConstant(float tau) {
+    if (tau > 0) _tau = tau;
+}
+
+void AttitudeEstimator::setMahonyGains(float kp, float ki) {
+    _kp = kp;
+    _ki = ki;
+}
+
+void AttitudeEstimator::reset() {
+    _initialized = false;
+    _roll = _pitch = _yaw = 0;
+    _rateX = _rateY = _rateZ = 0;
+    _q0 = 1;
+    _q1 = _q2 = _q3 = 0;
+    _integralX = _integralY = _integralZ = 0;
+}
+
+bool AttitudeEstimator::accelUsable(const ImuSample& s) const {
+    float norm = sqrtf(s.accelX * s.accelX + s.accelY * s.accelY + s.accelZ * s.accelZ);
+    return norm > ACCEL_GATE_MIN && norm < ACCEL_GATE_MAX;
+}
+
+void AttitudeEstimator::initFromAccel(const ImuSample& s) {
+    _roll = atan2f(s.accelY, s.accelZ);
+    _pitch = atan2f(-s.accelX, sqrtf(s.accelY * s.accelY + s.accelZ * s.accelZ));
+    _yaw = 0;
+    _initialized = true;
+    seedQuaternion();
+}
+
+void AttitudeEstimator::update(const ImuSample& sample, float dt) {
+    if (dt <= 0) return;
+
+    _rateX = sample.gyroX;
+    _rateY = sample.gyroY;
+    _rateZ = sample.gyroZ;
+
+    if (!_initialized) {
+        // Start from the accelerometer tilt instead of converging from level
+        if (accelUsable(sample)) {
+            initFromAccel(sample);
+        }
+        return;
+    }
+
+    if (_type == EstimatorType::MAHONY) {
+        updateMahony(sample, dt);
+    } else {
+        updateComplementary(sample, dt);
+    }
+}
+
+void AttitudeEstimator::updateComplementary(const ImuSample& s, float dt) {
+    // Body rates to Euler rates (ZYX)
+    float sinRoll = sinf(_roll), cosRoll = cosf(_roll);
+    float cosPitch = cosf(_pitch);
+    if (fabsf(cosPitch) < 1e-3f) cosPitch = cosPitch < 0 ? -1e-3f : 1e-3f;
+
+    float qs = s.gyroY * sinRoll + s.gyroZ * cosRoll;
+    float rollRate = s.gyroX + qs * (sinf(_pitch) / cosPitch);
+    float pitchRate = s.gyroY * cosRoll - s.gyroZ * sinRoll;
+    float yawRate = qs / cosPitch;
+
+    _roll = wrapPi(_roll + rollRate * dt);
+    _pitch += pitchRate * dt;
+    _yaw = wrapPi(_yaw + yawRate * dt);
+
+    if (accelUsable(s)) {
+        float accRoll = atan2f(s.accelY, s.accelZ);
+        float accPitch = atan2f(-s.accelX, sqrtf(s.accelY * s.accelY + s.accelZ * s.accelZ));
+        float k = dt / (_tau + dt);
+        _roll = wrapPi(_roll + k * wrapPi(accRoll - _roll));
+        _pitch += k * (accPitch - _pitch);
+    }
+}
+
+void AttitudeEstimator::updateMahony(const ImuSample& s, float dt) {
+    float gx = s.gyroX, gy = s.gyroY, gz = s.gyroZ;
+
+    if (accelUsable(s)) {
+        float invNorm = 1.0f / sqrtf(s.accelX * s.accelX + s.accelY * s.accelY + s.accelZ * s.accelZ);
+        float ax = s.accelX * invNorm;
+        float ay = s.accelY * invNorm;
+        float az = s.accelZ * invNorm;
+
+        // Estimated direction of gravity in the body frame
+        float vx = 2.0f * (_q1 * _q3 - _q0 * _q2);
+        float vy = 2.0f * (_q0 * _q1 + _q2 * _q3);
+        float vz = _q0 * _q0 - _q1 * _q1 - _q2 * _q2 + _q3 * _q3;
+
+        // Error is the cross product between measured and estimated gravity
+        float ex = ay * vz - az * vy;
+        float ey = az * vx - ax * vz;
+        float ez = ax * vy - ay * vx;
+
+        if (_ki > 0) {
+            _integralX += _ki * ex * dt;
+            _integralY += _ki * ey * dt;
+            _integralZ += _ki * ez * dt;
+            gx += _integralX;
+            gy += _integralY;
+            gz += _integralZ;
+        }
+
+        gx += _kp * ex;
+        gy += _kp * ey;
+        gz += _kp * ez;
+    }
+
+    // Integrate the quaternion rate
+    gx *= 0.5f * dt;
+    gy *= 0.5f * dt;
+    gz *= 0.5f * dt;
+    float qa = _q0, qb = _q1, qc = _q2;
+    _q0 += (-qb * gx - qc * gy - _q3 * gz);
+    _q1 += (qa * gx + qc * gz - _q3 * gy);
+    _q2 += (qa * gy - qb * gz + _q3 * gx);
+    _q3 += (qa * gz + qb * gy - qc * gx);
+
+    float invNorm = 1.0f / sqrtf(_q0 * _q0 + _q1 * _q1 + _q2 * _q2 + _q3 * _q3);
+    _q0 *= invNorm;
+    _q1 *= invNorm;
+    _q2 *= invNorm;
+    _q3 *= invNorm;
+
+    // Keep the Euler view in sync so getEstimate() and setType() share state
+    _roll = atan2f(2.0f * (_q0 * _q1 + _q2 * _q3), 1.0f - 2.0f * (_q1 * _q1 + _q2 * _q2));
+    float sinPitch = 2.0f * (_q0 * _q2 - _q3 * _q1);
+    sinPitch = sinPitch > 1.0f ? 1.0f : (sinPitch < -1.0f ? -1.0f : sinPitch);
+    _pitch = asinf(sinPitch);
+    _yaw = atan2f(2.0f * (_q0 * _q3 + _q1 * _q2), 1.0f - 2.0f * (_q2 * _q2 + _q3 * _q3));
+}
+
+AttitudeEstimate AttitudeEstimator::getEstimate() const {
+    AttitudeEstimate estimate;
+    estimate.roll = _roll * RAD_TO_DEG_F;
+    estimate.pitch = _pitch * RAD_TO_DEG_F;
+    estimate.yaw = _yaw * RAD_TO_DEG_F;
+    estimate.valid = _initialized;
+    estimate.rollRate = _rateX * RAD_TO_DEG_F;
+    estimate.pitchRate = _rateY * RAD_TO_DEG_F;
+    estimate.yawRate = _rateZ * RAD_TO_DEG_F;
+    return estimate;
+}
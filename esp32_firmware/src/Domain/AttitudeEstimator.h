@@ -0,0 +1,63 @@
+#pragma once
+#include <stdint.h>
+
+// Pure C++ (no Arduino dependencies) so it can run and be benchmarked on the host.
+
+// One IMU sample in body axes: x = roll, y = pitch, z = yaw
+struct ImuSample {
+    float accelX, accelY, accelZ; // m/s^2
+    float gyroX, gyroY, gyroZ;    // rad/s
+};
+
+// Attitude in degrees relative to the horizon. Roll/pitch are absolute
+// (accelerometer-referenced); yaw is gyro-only and drifts slowly.
+// Rates are the latest gyro sample in deg/s about body x/y/z.
+struct AttitudeEstimate {
+    float roll;
+    float pitch;
+    float yaw;
+    bool valid;
+    float rollRate;
+    float pitchRate;
+    float yawRate;
+};
+
+enum class EstimatorType : uint8_t {
+    COMPLEMENTARY = 0,
+    MAHONY = 1
+};
+
+class AttitudeEstimator {
+public:
+    AttitudeEstimator(EstimatorType type = EstimatorType::MAHONY);
+
+    void setType(EstimatorType type);
+    EstimatorType getType() const { return _type; }
+    void setComplementaryTimeConstant(float tau);
+    void setMahonyGains(float kp, float ki);
+    void reset();
+
+    // Feed one sample; dt is the sample period in seconds
+    void update(const ImuSample& sample, float dt);
+    AttitudeEstimate getEstimate() const;
+
+private:
+    EstimatorType _type;
+    bool _initialized;
+
+    // Complementary filter state (radians)
+    float _tau;
+    float _roll, _pitch, _yaw;
+    float _rateX, _rateY, _rateZ; // Latest gyro sample, rad/s
+
+    // Mahony filter state
+    float _kp, _ki;
+    float _q0, _q1, _q2, _q3;
+    float _integralX, _integralY, _integralZ;
+
+    void initFromAccel(const ImuSample& sample);
+    void seedQuaternion(); // Quaternion from the current Euler angles
+    bool accelUsable(const ImuSample& sample) const;
+    void updateComplementary(const ImuSample& sample, float dt);
+    void updateMahony(const ImuSample& sample, float dt);
+};
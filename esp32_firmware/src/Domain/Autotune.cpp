@@ -0,0 +1,181 @@
+#include "Autotune.h"
+#include <math.h>
+#include <string.h>
+
+const char* const AUTOTUNE_RULE_NAMES[AUTOTUNE_RULE_COUNT] = {
+    "ziegler_nichols", "some_overshoot", "no_overshoot", "tyreus_luyben"};
+
+const char* const AUTOTUNE_STATUS_NAMES[AUTOTUNE_CANCELLED + 1] = {
+    "skipped", "pending", "running", "done", "timeout", "out_of_range", "no_attitude", "cancelled"};
+
+bool parseAutotuneRule(const char* name, AutotuneRule& rule) {
+    for (int i = 0; name && i < AUTOTUNE_RULE_COUNT; i++) {
+        if (strcmp(name, AUTOTUNE_RULE_NAMES[i]) == 0) {
+            rule = (AutotuneRule)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+PidGains tuneFromRelay(float ku, float tu, AutotuneRule rule) {
+    // Kp as a fraction of Ku, Ti and Td as fractions of Tu
+    static const float RULES[AUTOTUNE_RULE_COUNT][3] = {
+        {0.6f, 0.5f, 0.125f},
+        {0.33f, 0.5f, 1.0f / 3.0f},
+        {0.2f, 0.5f, 1.0f / 3.0f},
+        {0.45f, 2.2f, 1.0f / 6.3f},
+    };
+    const float* r = RULES[rule < AUTOTUNE_RULE_COUNT ? rule : AUTOTUNE_RULE_NO_OVERSHOOT];
+    if (!(ku > 0) || !(tu > 0)) {
+        return {0, 0, 0};
+    }
+    float kp = r[0] * ku;
+    return {kp, kp / (r[1] * tu), kp * r[2] * tu};
+}
+
+RelayAutotune::RelayAutotune()
+    : _active(false),
+      _axis(AXIS_YAW),
+      _phaseTime(0),
+      _settings(),
+      _output(0),
+      _lastSwitch(-1),
+      _errMin(0),
+      _errMax(0),
+      _periods(0) {
+    memset(_result, 0, sizeof(_result));
+}
+
+void RelayAutotune::start(const RelayAutotuneSettings& settings, const bool axes[AXIS_COUNT]) {
+    _settings = settings;
+    memset(_result, 0, sizeof(_result));
+    for (int i = 0; i < AXIS_COUNT; i++) {
+        _result[i].status = axes[i] ? AUTOTUNE_PENDING : AUTOTUNE_SKIPPED;
+    }
+    _active = true;
+    beginAxis(0);
+}
+
+void RelayAutotune::cancel() {
+    for (int i = 0; i < AXIS_COUNT; i++) {
+        if (_result[i].status == AUTOTUNE_PENDING || _result[i].status == AUTOTUNE_RUNNING) {
+            _result[i].status = AUTOTUNE_CANCELLED;
+        }
+    }
+    _active = false;
+}
+
+void RelayAutotune::beginAxis(int from) {
+    int axis = from;
+    while (axis < AXIS_COUNT && _result[axis].status != AUTOTUNE_PENDING) axis++;
+    if (axis == AXIS_COUNT) {
+        _active = false;
+        return;
+    }
+    _axis = (GimbalAxis)axis;
+    _result[axis].status = AUTOTUNE_RUNNING;
+    _phaseTime = 0;
+    _output = 0;
+    _lastSwitch = -1;
+    _periods = 0;
+}
+
+void RelayAutotune::finishAxis(AutotuneAxisStatus status) {
+    _result[_axis].status = status;
+    if (status == AUTOTUNE_OUT_OF_RANGE || status == AUTOTUNE_NO_ATTITUDE) {
+        cancel();
+        return;
+    }
+    beginAxis(_axis + 1);
+}
+
+bool RelayAutotune::steady(float& tu, float& amplitude) const {
+    int n = _settings.measureCycles;
+    if (_periods - _settings.discardCycles < n || n <= 0) {
+        return false;
+    }
+    // Mean of the newest n periods, which must all lie within the tolerance of it
+    float sumT = 0, sumA = 0;
+    for (int k = 0; k < n; k++) {
+        int i = (_periods - 1 - k) % MAX_PERIODS;
+        sumT += _period[i];
+        sumA += _amplitude[i];
+    }
+    tu = sumT / n;
+    amplitude = sumA / n;
+    for (int k = 0; k < n; k++) {
+        int i = (_periods - 1 - k) % MAX_PERIODS;
+        if (fabsf(_period[i] - tu) > _settings.periodTolerance * tu ||
+            fabsf(_amplitude[i] - amplitude) > _settings.periodTolerance * amplitude) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void RelayAutotune::update(float dt, const float error[AXIS_COUNT], bool measuredValid, float correction[AXIS_COUNT]) {
+    if (!_active) {
+        return;
+    }
+    _phaseTime += dt;
+    if (_phaseTime < _settings.settleTime) {
+        return; // Normal control until the previous axis has recovered
+    }
+
+    const RelayAutotuneSettings& s = _settings;
+    AxisAutotuneResult& r = _result[_axis];
+    float e = error[_axis];
+    if (!measuredValid) {
+        finishAxis(AUTOTUNE_NO_ATTITUDE);
+        return;
+    }
+    if (fabsf(e) > s.maxError) {
+        finishAxis(AUTOTUNE_OUT_OF_RANGE);
+        return;
+    }
+    if (_phaseTime - s.settleTime > s.axisTimeout) {
+        finishAxis(AUTOTUNE_TIMEOUT);
+        return;
+    }
+
+    if (_output == 0) {
+        // First relay cycle: push towards the setpoint
+        _output = e >= 0 ? s.relayAmplitude : -s.relayAmplitude;
+        _errMin = _errMax = e;
+    }
+    _errMin = fminf(_errMin, e);
+    _errMax = fmaxf(_errMax, e);
+
+    if (_output < 0 && e > s.hysteresis) {
+        // A - to + switch closes one full period
+        if (_lastSwitch >= 0) {
+            int i = _periods % MAX_PERIODS;
+            _period[i] = _phaseTime - _lastSwitch;
+            _amplitude[i] = (_errMax - _errMin) * 0.5f;
+            _periods++;
+            r.cycles = (uint8_t)(_periods < 255 ? _periods : 255);
+        }
+        _lastSwitch = _phaseTime;
+        _errMin = _errMax = e;
+        _output = s.relayAmplitude;
+
+        float tu, amplitude;
+        if (steady(tu, amplitude)) {
+            if (amplitude <= s.hysteresis) {
+                finishAxis(AUTOTUNE_TIMEOUT); // Cycle lost in the hysteresis band; Ku is undefined
+                return;
+            }
+            r.tu = tu;
+            r.amplitude = amplitude;
+            r.ku = 4.0f * s.relayAmplitude /
+                   ((float)M_PI * sqrtf(amplitude * amplitude - s.hysteresis * s.hysteresis));
+            finishAxis(AUTOTUNE_DONE);
+            return;
+        }
+    } else if (_output > 0 && e < -s.hysteresis) {
+        _output = -s.relayAmplitude;
+    }
+
+    correction[_axis] = _output;
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include <stdint.h>
+#include "GainSchedule.h"
+
+// Pure C++ (no Arduino dependencies) so it can run and be benchmarked on the host.
+
+// Tuning rules from the ultimate gain Ku and period Tu of a relay experiment.
+// The first three assume a self-regulating plant; the auto loop integrates
+// (its correction moves the filtered position), where they overshoot and
+// Tyreus-Luyben is the one to use.
+enum AutotuneRule {
+    AUTOTUNE_RULE_ZIEGLER_NICHOLS = 0, // Kp 0.6 Ku, Ti Tu/2, Td Tu/8: fast, about 25% overshoot
+    AUTOTUNE_RULE_SOME_OVERSHOOT = 1,  // Kp 0.33 Ku, Ti Tu/2, Td Tu/3
+    AUTOTUNE_RULE_NO_OVERSHOOT = 2,    // Kp 0.2 Ku, Ti Tu/2, Td Tu/3
+    AUTOTUNE_RULE_TYREUS_LUYBEN = 3,   // Kp 0.45 Ku, Ti 2.2 Tu, Td Tu/6.3: robust, slow integral
+    AUTOTUNE_RULE_COUNT = 4
+};
+
+// "ziegler_nichols", "some_overshoot", "no_overshoot", "tyreus_luyben"
+extern const char* const AUTOTUNE_RULE_NAMES[AUTOTUNE_RULE_COUNT];
+bool parseAutotuneRule(const char* name, AutotuneRule& rule); // False for an unknown or null name
+
+// Gains in the units of AxisPidState: ki per second, kd in seconds
+PidGains tuneFromRelay(float ku, float tu, AutotuneRule rule);
+
+enum AutotuneAxisStatus {
+    AUTOTUNE_SKIPPED,      // Not selected
+    AUTOTUNE_PENDING,
+    AUTOTUNE_RUNNING,
+    AUTOTUNE_DONE,
+    AUTOTUNE_TIMEOUT,      // No steady oscillation in time; the other axes still run
+    AUTOTUNE_OUT_OF_RANGE, // Error beyond maxError; the whole run stops
+    AUTOTUNE_NO_ATTITUDE,  // Estimate lost; the whole run stops
+    AUTOTUNE_CANCELLED
+};
+
+// "skipped", "pending", "running", "done", "timeout", "out_of_range", "no_attitude", "cancelled"
+extern const char* const AUTOTUNE_STATUS_NAMES[AUTOTUNE_CANCELLED + 1];
+
+struct RelayAutotuneSettings {
+    float relayAmplitude;  // deg of correction the relay switches between (+/-)
+    float hysteresis;      // deg of error; must be above the estimate's noise
+    float maxError;        // deg; a larger error stops the run
+    float axisTimeout;     // s per axis
+    float settleTime;      // s of normal control before each axis
+    int discardCycles;     // Oscillation periods ignored while it builds up
+    int measureCycles;     // Periods averaged for Ku and Tu
+    float periodTolerance; // Fraction the measured periods may spread and still count as steady
+};
+
+struct AxisAutotuneResult {
+    uint8_t status;  // AutotuneAxisStatus
+    uint8_t cycles;  // Oscillation periods seen
+    float ku;        // Ultimate gain, deg of correction per deg of error
+    float tu;        // s, ultimate period
+    float amplitude; // deg, half the peak-to-peak error
+};
+
+// Relay-feedback (Astrom-Hagglund) experiment run from the auto-mode loop,
+// one axis at a time. While an axis is tested its PID output is replaced by
+// +/-relayAmplitude switched on the sign of the error (with hysteresis), so
+// it settles into a limit cycle at the loop's phase crossover. From the
+// period Tu and the error amplitude a of that cycle, the describing function
+// gives Ku = 4 d / (pi sqrt(a^2 - e^2)). The other axes keep their PIDs, and
+// nothing blocks: every call moves the experiment on by the control dt.
+class RelayAutotune {
+public:
+    RelayAutotune();
+
+    void start(const RelayAutotuneSettings& settings, const bool axes[AXIS_COUNT]);
+    void cancel();
+
+    // error: setpoint - measured of every axis, deg. Overwrites the
+    // correction of the axis under test and leaves the others alone.
+    void update(float dt, const float error[AXIS_COUNT], bool measuredValid, float correction[AXIS_COUNT]);
+
+    bool active() const { return _active; }
+    bool testing() const { return _active && _phaseTime >= _settings.settleTime; } // Relay on, not settling
+    GimbalAxis axis() const { return _axis; }
+    const AxisAutotuneResult& result(GimbalAxis axis) const { return _result[axis]; }
+
+private:
+    static const int MAX_PERIODS = 16; // Newest periods kept for the steadiness check
+
+    bool _active;
+    GimbalAxis _axis;
+    float _phaseTime; // s since the axis started, settling included
+    RelayAutotuneSettings _settings;
+    AxisAutotuneResult _result[AXIS_COUNT];
+
+    float _output;     // Current relay output, +/- relayAmplitude
+    float _lastSwitch; // s, phase time of the last - to + switch; < 0 before the first
+    float _errMin, _errMax;
+    int _periods;
+    float _period[MAX_PERIODS];
+    float _amplitude[MAX_PERIODS];
+
+    void beginAxis(int from);
+    void finishAxis(AutotuneAxisStatus status);
+    bool steady(float& tu, float& amplitude) const;
+};
@@ -0,0 +1,75 @@
+#include "AxisKernel.h"
+#include <math.h>
+
+void resetAxisPid(AxisPidState& pid) {
+    for (int i = 0; i < AXIS_COUNT; i++) {
+        pid.iTerm[i] = 0;
+        pid.pError[i] = 0;
+        pid.prevInput[i] = 0;
+        pid.derivative[i] = 0;
+        pid.prevOutput[i] = 0;
+    }
+    pid.primed = false;
+}
+
+void setAxisGains(AxisPidState& pid, GimbalAxis axis, const PidGains& gains, bool bumpless) {
+    // With setpoint weighting the P term is not zero at rest, so move the
+    // change it would make into the integral. Before the first step there is
+    // no output to keep.
+    if (bumpless && pid.primed) {
+        pid.iTerm[axis] += (pid.kp[axis] - gains.kp) * pid.pError[axis];
+    }
+    pid.kp[axis] = gains.kp;
+    pid.ki[axis] = gains.ki;
+    pid.kd[axis] = gains.kd;
+}
+
+void computeAxisPid(AxisPidState& pid, const PIDShaping& shaping, const AxisPidInput& in,
+                    float dt, float invDt, float out[AXIS_COUNT]) {
+    if (dt <= 0) {
+        for (int i = 0; i < AXIS_COUNT; i++) out[i] = 0;
+        return;
+    }
+
+    if (!pid.primed) {
+        // No derivative history yet: start from rest instead of kicking
+        for (int i = 0; i < AXIS_COUNT; i++) {
+            pid.prevInput[i] = in.measured[i];
+            pid.derivative[i] = 0;
+            pid.prevOutput[i] = 0;
+        }
+        pid.primed = true;
+    }
+
+    // Shared by all axes, hoisted out of the loop
+    const float filter = shaping.derivativeTau > 0 ? dt / (shaping.derivativeTau + dt) : 1.0f;
+    const float weight = shaping.setpointWeight;
+    const float maxStep = shaping.outputRateLimit > 0 ? shaping.outputRateLimit * dt : INFINITY;
+
+    for (int i = 0; i < AXIS_COUNT; i++) {
+        float setpoint = in.setpoint[i];
+        float input = in.measured[i];
+        float error = setpoint - input;
+
+        // Derivative on measurement, low-passed (filter = 1 passes it raw)
+        float rawDerivative = (input - pid.prevInput[i]) * invDt;
+        pid.prevInput[i] = input;
+        pid.derivative[i] += (rawDerivative - pid.derivative[i]) * filter;
+
+        pid.pError[i] = weight * setpoint - input;
+        float base = pid.kp[i] * pid.pError[i] - pid.kd[i] * pid.derivative[i] + in.feedForward[i];
+
+        // Conditional integration: skip the update when it would only wind the
+        // integral further into a saturated output
+        float candidate = pid.iTerm[i] + pid.ki[i] * error * dt;
+        float unclamped = base + candidate;
+        bool windingUp = (unclamped > in.outMax[i] && error > 0) || (unclamped < in.outMin[i] && error < 0);
+        pid.iTerm[i] = windingUp ? pid.iTerm[i] : candidate;
+
+        float output = clampf(base + pid.iTerm[i], in.outMin[i], in.outMax[i]);
+        output = clampf(output, pid.prevOutput[i] - maxStep, pid.prevOutput[i] + maxStep);
+        output = clampf(output, in.outMin[i], in.outMax[i]);
+        pid.prevOutput[i] = output;
+        out[i] = output;
+    }
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <stdint.h>
+#include "GainSchedule.h"
+
+// Pure C++ (no Arduino dependencies) so it can run and be benchmarked on the host.
+
+// Three-axis control kernel. State is laid out as structure-of-arrays indexed
+// by GimbalAxis, and each kernel is one pass over all axes with no per-axis
+// member calls, so the compiler can unroll and schedule the three lanes
+// together.
+//
+// Everything stays in float: the ESP32-S3 FPU does single-precision
+// multiply-add in hardware, and its PIE vector unit only has integer lanes,
+// so Q16 fixed point would add conversions and saturation without saving
+// cycles. The savings come from hoisting per-cycle constants (1/dt,
+// filter coefficients) out of the axis loop, branch-free clamps and one call
+// per cycle instead of three. KernelBenchmark compares it against the
+// scalar PIDController path.
+
+// Shaping applied to the auto-mode PIDs on top of the configured gains
+struct PIDShaping {
+    float derivativeTau;   // s, low-pass on derivative-on-measurement; 0 = raw
+    float setpointWeight;  // Proportional term acts on weight * setpoint - measurement
+    float feedForwardGain; // Fraction of the estimated base rotation rate cancelled directly
+    float outputRateLimit; // deg/s change of the correction; 0 = unlimited
+    bool antiWindup;       // Limit corrections to the servo range and stop integrating at the limit
+};
+
+// Servo-side state of every axis, in degrees
+struct AxisState {
+    float target[AXIS_COUNT];    // Input of the output filter (OutputFilter.h)
+    float position[AXIS_COUNT];  // Filtered logical position (before trim)
+    float servoRate[AXIS_COUNT]; // deg/s of the filtered position over the last cycle
+};
+
+// The three auto-mode PIDs. Same algorithm as PIDController: derivative on
+// measurement with optional low-pass, setpoint weighting, feed-forward,
+// conditional-integration anti-windup, output rate limit. The integral is
+// stored as its contribution to the output, so ki changes do not step it.
+// setAxisGains can also fold the P-term change of a kp change into it
+// (bumpless transfer). kd changes are left alone: the filtered derivative is
+// near zero at rest, and folding its noise into the integral would keep it.
+struct AxisPidState {
+    float kp[AXIS_COUNT];
+    float ki[AXIS_COUNT];
+    float kd[AXIS_COUNT];
+    float iTerm[AXIS_COUNT];
+    float pError[AXIS_COUNT]; // weight * setpoint - measured of the last step
+    float prevInput[AXIS_COUNT];
+    float derivative[AXIS_COUNT];
+    float prevOutput[AXIS_COUNT];
+    bool primed; // False until the first sample after a reset
+};
+
+// Inputs of one auto cycle, relative to level (SERVO_CENTER)
+struct AxisPidInput {
+    float setpoint[AXIS_COUNT];
+    float measured[AXIS_COUNT];
+    float feedForward[AXIS_COUNT];
+    float outMin[AXIS_COUNT]; // -INFINITY / INFINITY when unlimited
+    float outMax[AXIS_COUNT];
+};
+
+void resetAxisPid(AxisPidState& pid);
+// Gains take effect on the next computeAxisPid(). Bumpless moves the P-term
+// change into the integral so the output does not step: use it for config
+// changes, not for a gain schedule that follows the error every cycle, where
+// the folded sum would stay in the integral as overshoot.
+void setAxisGains(AxisPidState& pid, GimbalAxis axis, const PidGains& gains, bool bumpless = false);
+
+// One PID step for every axis; invDt = 1 / dt
+void computeAxisPid(AxisPidState& pid, const PIDShaping& shaping, const AxisPidInput& in,
+                    float dt, float invDt, float out[AXIS_COUNT]);
+
+inline float clampf(float value, float lo, float hi) {
+    // Written as selects so it compiles to conditional moves, not branches
+    value = value < lo ? lo : value;
+    return value > hi ? hi : value;
+}
@@ -0,0 +1,188 @@
+#include "EventLog.h"
+#include <Arduino.h>
+#include <stdio.h>
+#include <string.h>
+
+const char* const LOG_LEVEL_NAMES[LOG_LEVEL_COUNT] = {"debug", "info", "warn", "error"};
+
+const char* const LOG_FORMATS[LOG_MESSAGE_COUNT] = {
+    "%u log message(s) dropped",                              // LOG_DROPPED
+    "BLE client connected",                                   // LOG_BLE_CONNECTED
+    "BLE client disconnected",                                // LOG_BLE_DISCONNECTED
+    "BLE advertising restarted",                              // LOG_BLE_ADVERTISING
+    "BLE position: yaw=%.1f, pitch=%.1f, roll=%.1f",          // LOG_BLE_POSITION
+    "BLE position: invalid values, ignoring",                 // LOG_BLE_POSITION_INVALID
+    "BLE mode change: %d",                                    // LOG_BLE_MODE
+    "BLE mode change: invalid mode %d, ignoring",             // LOG_BLE_MODE_INVALID
+    "WiFi lost, reconnecting...",                             // LOG_WIFI_LOST
+    "WiFi reconnected",                                       // LOG_WIFI_RECONNECTED
+    "Long press detected - running self-test",                // LOG_BUTTON_SELF_TEST
+    "Short press detected - setting flat reference",          // LOG_BUTTON_FLAT_REFERENCE
+    "Flat reference set to yaw=%.2f, pitch=%.2f, roll=%.2f",  // LOG_FLAT_REFERENCE
+    "Self-test started (%.1f s)",                             // LOG_SELF_TEST_STARTED
+    "Self-test %s (%.1f s)",                                  // LOG_SELF_TEST_DONE
+    "  %-5s no attitude estimate",                            // LOG_SELF_TEST_NO_ATTITUDE
+    "  %-5s NO RESPONSE (gain %.2f)",                         // LOG_SELF_TEST_NO_RESPONSE
+    "  %-5s gain %.2f  rise %.0f ms  settle %.0f ms  overshoot %.1f%%", // LOG_SELF_TEST_AXIS
+    "Servo calibration stored for axis %d (%u points)",       // LOG_SERVO_CALIBRATION_STORED
+    "Autotune gains (%s) stored for %d axes",                 // LOG_AUTOTUNE_STORED
+    "Accel calibration stored: offset %.3f %.3f %.3f, scale %.4f %.4f %.4f", // LOG_ACCEL_CALIBRATION_STORED
+    "Gyro temperature compensation stored: %d bins, %.1f-%.1f C", // LOG_GYRO_TEMPERATURE_STORED
+    "Failed to open config file for writing",                 // LOG_CONFIG_OPEN_FAILED
+    "Failed to write config file",                            // LOG_CONFIG_WRITE_FAILED
+    "Failed to open config backup for writing",               // LOG_CONFIG_BACKUP_OPEN_FAILED
+    "Failed to write config backup",                          // LOG_CONFIG_BACKUP_WRITE_FAILED
+    "Failed to open sequence file for writing",               // LOG_SEQUENCE_OPEN_FAILED
+    "Failed to write sequence file",                          // LOG_SEQUENCE_WRITE_FAILED
+};
+
+EventLog eventLog;
+
+uint32_t logNowMs() {
+    return (uint32_t)millis();
+}
+
+EventLog::EventLog() : _head(0), _tail(0), _written(0), _dropped(0) {
+    for (uint32_t i = 0; i < CAPACITY; i++) {
+        _slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+bool EventLog::write(LogLevel level, LogMessage message, const LogArg* args, int count) {
+    uint32_t position = _head.load(std::memory_order_relaxed);
+    Slot* slot;
+    for (;;) {
+        slot = &_slots[position & (CAPACITY - 1)];
+        uint32_t sequence = slot->sequence.load(std::memory_order_acquire);
+        int32_t diff = (int32_t)(sequence - position);
+        if (diff == 0) {
+            // Free for this position; claim it
+            if (_head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // Still holds the record from one lap ago: full
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            // Another producer claimed it first
+            position = _head.load(std::memory_order_relaxed);
+        }
+    }
+
+    LogRecord& record = slot->record;
+    record.timeMs = logNowMs();
+    record.message = message;
+    record.level = level;
+    record.argCount = (uint8_t)(count < LOG_MAX_ARGS ? count : LOG_MAX_ARGS);
+    memcpy(record.args, args, record.argCount * sizeof(LogArg));
+    slot->sequence.store(position + 1, std::memory_order_release);
+    _written.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool EventLog::read(LogRecord& out) {
+    Slot& slot = _slots[_tail & (CAPACITY - 1)];
+    if (slot.sequence.load(std::memory_order_acquire) != _tail + 1) {
+        return false;
+    }
+    out = slot.record;
+    // Free it for the producer one lap ahead
+    slot.sequence.store(_tail + CAPACITY, std::memory_order_release);
+    _tail++;
+    return true;
+}
+
+// Formats one conversion spec (without length modifiers) with the argument,
+// converted to what the conversion expects
+static int formatArg(char* out, size_t size, const char* spec, char conversion, const LogArg* arg) {
+    bool numeric = arg && arg->type != LogArg::STRING;
+    switch (conversion) {
+    case 'd': case 'i': case 'c':
+        if (numeric) {
+            return snprintf(out, size, spec, arg->type == LogArg::FLOAT ? (int)arg->f : (int)arg->i);
+        }
+        break;
+    case 'u': case 'x': case 'X': case 'o':
+        if (numeric) {
+            return snprintf(out, size, spec, arg->type == LogArg::FLOAT ? (unsigned)arg->f : (unsigned)arg->u);
+        }
+        break;
+    case 'f': case 'F': case 'e': case 'E': case 'g': case 'G':
+        if (numeric) {
+            double v = arg->type == LogArg::FLOAT ? arg->f : arg->type == LogArg::UINT ? (double)arg->u : arg->i;
+            return snprintf(out, size, spec, v);
+        }
+        break;
+    case 's':
+        if (arg && arg->type == LogArg::STRING && arg->s) {
+            return snprintf(out, size, spec, arg->s);
+        }
+        break;
+    }
+    return snprintf(out, size, "?");
+}
+
+size_t formatLogMessage(const LogRecord& record, char* out, size_t size) {
+    if (size == 0) {
+        return 0;
+    }
+    if (record.message >= LOG_MESSAGE_COUNT) {
+        // Logged by newer firmware than the one formatting it
+        int written = snprintf(out, size, "message %u", (unsigned)record.message);
+        return written < 0 ? 0 : ((size_t)written < size ? (size_t)written : size - 1);
+    }
+    const char* format = LOG_FORMATS[record.message];
+    size_t length = 0;
+    int next = 0;
+
+    for (const char* p = format; *p && length + 1 < size;) {
+        if (*p != '%') {
+            out[length++] = *p++;
+            continue;
+        }
+        if (p[1] == '%') {
+            out[length++] = '%';
+            p += 2;
+            continue;
+        }
+        // %[flags][width][.precision][length]conversion
+        char spec[16];
+        size_t n = 0;
+        spec[n++] = *p++;
+        while (*p && strchr("-+ #0123456789.", *p)) {
+            if (n < sizeof(spec) - 2) spec[n++] = *p;
+            p++;
+        }
+        while (*p && strchr("hlLqjzt", *p)) {
+            p++; // Arguments are passed as int, unsigned or double
+        }
+        char conversion = *p;
+        if (!conversion) {
+            break;
+        }
+        p++;
+        spec[n++] = conversion;
+        spec[n] = '\0';
+
+        const LogArg* arg = next < record.argCount ? &record.args[next] : nullptr;
+        next++;
+        int written = formatArg(out + length, size - length, spec, conversion, arg);
+        if (written > 0) {
+            length += (size_t)written < size - length ? (size_t)written : size - length - 1;
+        }
+    }
+    out[length] = '\0';
+    return length;
+}
+
+size_t formatLogLine(const LogRecord& record, char* out, size_t size) {
+    static const char LEVEL_LETTERS[LOG_LEVEL_COUNT] = {'D', 'I', 'W', 'E'};
+    char level = record.level < LOG_LEVEL_COUNT ? LEVEL_LETTERS[record.level] : '?';
+    int prefix = snprintf(out, size, "%4lu.%03lu %c ", (unsigned long)(record.timeMs / 1000),
+                          (unsigned long)(record.timeMs % 1000), level);
+    if (prefix < 0 || (size_t)prefix >= size) {
+        return size ? strlen(out) : 0;
+    }
+    return (size_t)prefix + formatLogMessage(record, out + prefix, size - prefix);
+}
@@ -0,0 +1,152 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include "config.h"
+
+// Pure C++ (no Arduino dependencies) so it can run and be benchmarked on the host.
+
+enum LogLevel : uint8_t {
+    LOG_LEVEL_DEBUG,
+    LOG_LEVEL_INFO,
+    LOG_LEVEL_WARN,
+    LOG_LEVEL_ERROR,
+    LOG_LEVEL_COUNT
+};
+
+// "debug", "info", "warn", "error"
+extern const char* const LOG_LEVEL_NAMES[LOG_LEVEL_COUNT];
+
+// Every message the firmware logs at run time. A record carries only the ID
+// and its arguments; the printf-style format (LOG_FORMATS in EventLog.cpp)
+// is applied by the log task. Append new IDs at the end so stored and
+// streamed logs keep their meaning.
+enum LogMessage : uint16_t {
+    LOG_DROPPED,                 // Emitted by the log task itself
+    LOG_BLE_CONNECTED,
+    LOG_BLE_DISCONNECTED,
+    LOG_BLE_ADVERTISING,
+    LOG_BLE_POSITION,
+    LOG_BLE_POSITION_INVALID,
+    LOG_BLE_MODE,
+    LOG_BLE_MODE_INVALID,
+    LOG_WIFI_LOST,
+    LOG_WIFI_RECONNECTED,
+    LOG_BUTTON_SELF_TEST,
+    LOG_BUTTON_FLAT_REFERENCE,
+    LOG_FLAT_REFERENCE,
+    LOG_SELF_TEST_STARTED,
+    LOG_SELF_TEST_DONE,
+    LOG_SELF_TEST_NO_ATTITUDE,
+    LOG_SELF_TEST_NO_RESPONSE,
+    LOG_SELF_TEST_AXIS,
+    LOG_SERVO_CALIBRATION_STORED,
+    LOG_AUTOTUNE_STORED,
+    LOG_ACCEL_CALIBRATION_STORED,
+    LOG_GYRO_TEMPERATURE_STORED,
+    LOG_CONFIG_OPEN_FAILED,
+    LOG_CONFIG_WRITE_FAILED,
+    LOG_CONFIG_BACKUP_OPEN_FAILED,
+    LOG_CONFIG_BACKUP_WRITE_FAILED,
+    LOG_SEQUENCE_OPEN_FAILED,
+    LOG_SEQUENCE_WRITE_FAILED,
+    LOG_MESSAGE_COUNT
+};
+
+extern const char* const LOG_FORMATS[LOG_MESSAGE_COUNT];
+
+// One argument, tagged with the type it was captured as. Strings are kept
+// by pointer, so only pass string literals and static tables (AXIS_NAMES...).
+struct LogArg {
+    enum Type : uint8_t { INT, UINT, FLOAT, STRING };
+    Type type;
+    union {
+        int32_t i;
+        uint32_t u;
+        float f;
+        const char* s;
+    };
+};
+
+inline LogArg logArg(int v) { LogArg a; a.type = LogArg::INT; a.i = v; return a; }
+inline LogArg logArg(long v) { LogArg a; a.type = LogArg::INT; a.i = (int32_t)v; return a; }
+inline LogArg logArg(unsigned int v) { LogArg a; a.type = LogArg::UINT; a.u = v; return a; }
+inline LogArg logArg(unsigned long v) { LogArg a; a.type = LogArg::UINT; a.u = (uint32_t)v; return a; }
+inline LogArg logArg(float v) { LogArg a; a.type = LogArg::FLOAT; a.f = v; return a; }
+inline LogArg logArg(double v) { LogArg a; a.type = LogArg::FLOAT; a.f = (float)v; return a; }
+inline LogArg logArg(const char* v) { LogArg a; a.type = LogArg::STRING; a.s = v; return a; }
+
+struct LogRecord {
+    uint32_t timeMs;
+    uint16_t message;  // LogMessage
+    uint8_t level;     // LogLevel
+    uint8_t argCount;
+    LogArg args[LOG_MAX_ARGS];
+};
+
+// Formats the record's message into out (always terminated). Each conversion
+// takes the next argument; a missing or mismatched one prints as "?".
+// Returns the length written.
+size_t formatLogMessage(const LogRecord& record, char* out, size_t size);
+// "  12.345 I message"
+size_t formatLogLine(const LogRecord& record, char* out, size_t size);
+
+// Deferred log: any task enqueues fixed-size records into a bounded ring and
+// one low-priority task dequeues, formats and writes them out, so a log call
+// costs a few atomic operations and a copy instead of a blocking UART write.
+//
+// Multi-producer, single-consumer. Each slot carries a sequence number
+// (Vyukov's bounded queue): a producer claims the next position with a CAS,
+// fills the slot and publishes it by advancing the sequence. Producers never
+// wait; when the ring is full the record is dropped and counted. A producer
+// preempted between claim and publish only holds up the consumer, which
+// picks the record up on a later pass.
+class EventLog {
+public:
+    static const uint32_t CAPACITY = LOG_RING_RECORDS;
+
+    EventLog();
+
+    // Producer side, any task. Returns false if the record was dropped.
+    bool write(LogLevel level, LogMessage message, const LogArg* args, int count);
+
+    // Consumer side, one task. Returns false when nothing is ready.
+    bool read(LogRecord& out);
+
+    uint32_t getWrittenCount() const { return _written.load(std::memory_order_relaxed); }
+    uint32_t getDroppedCount() const { return _dropped.load(std::memory_order_relaxed); }
+
+private:
+    static_assert((CAPACITY & (CAPACITY - 1)) == 0, "LOG_RING_RECORDS must be a power of two");
+
+    struct Slot {
+        std::atomic<uint32_t> sequence;
+        LogRecord record;
+    };
+
+    Slot _slots[CAPACITY];
+    std::atomic<uint32_t> _head; // Next position to claim
+    uint32_t _tail;              // Consumer only
+    std::atomic<uint32_t> _written;
+    std::atomic<uint32_t> _dropped;
+};
+
+// The firmware's log, drained by LogTask
+extern EventLog eventLog;
+
+uint32_t logNowMs(); // Record timestamp: millis()
+
+template <typename... Args>
+inline void logMessage(LogLevel level, LogMessage message, Args... args) {
+    static_assert(sizeof...(Args) <= LOG_MAX_ARGS, "Too many log arguments");
+    const LogArg packed[sizeof...(Args) + 1] = {logArg(args)...};
+    eventLog.write(level, message, packed, (int)sizeof...(Args));
+}
+
+// Levels below LOG_COMPILE_LEVEL are compiled out, arguments included
+#define LOG_AT(level, ...) \
+    do { if ((level) >= LOG_COMPILE_LEVEL) logMessage((level), __VA_ARGS__); } while (0)
+#define LOG_DEBUG(...) LOG_AT(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#define LOG_INFO(...) LOG_AT(LOG_LEVEL_INFO, __VA_ARGS__)
+#define LOG_WARN(...) LOG_AT(LOG_LEVEL_WARN, __VA_ARGS__)
+#define LOG_ERROR(...) LOG_AT(LOG_LEVEL_ERROR, __VA_ARGS__)
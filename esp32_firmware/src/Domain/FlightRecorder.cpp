@@ -0,0 +1,212 @@
+#include "FlightRecorder.h"
+#include <string.h>
+
+const char* const FLIGHT_STATE_NAMES[FLIGHT_CAPTURED + 1] = {"idle", "armed", "triggered", "captured"};
+
+const char* const FLIGHT_TRIGGER_NAMES[FLIGHT_TRIGGER_COUNT] = {"manual", "error", "saturation"};
+
+bool parseFlightTrigger(const char* name, FlightTrigger& trigger) {
+    for (int i = 0; name && i < FLIGHT_TRIGGER_COUNT; i++) {
+        if (strcmp(name, FLIGHT_TRIGGER_NAMES[i]) == 0) {
+            trigger = (FlightTrigger)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+FlightCaptureHeader makeFlightCaptureHeader(const FlightRecorderStatus& status, uint32_t rateHz,
+                                            float accelLsbPerG, float gyroLsbPerDps) {
+    FlightCaptureHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "GFR1", 4);
+    header.version = FLIGHT_CAPTURE_VERSION;
+    header.recordSize = sizeof(FlightRecord);
+    header.count = status.state == FLIGHT_CAPTURED ? status.count : 0;
+    header.triggerIndex = status.triggerIndex;
+    header.cause = status.cause;
+    header.rateHz = rateHz;
+    header.accelLsbPerG = accelLsbPerG;
+    header.gyroLsbPerDps = gyroLsbPerDps;
+    return header;
+}
+
+FlightRecorder::FlightRecorder()
+    : _buffer(nullptr),
+      _capacity(0),
+      _requests(0),
+      _written(0),
+      _generation(0),
+      _count(0),
+      _stopAt(0),
+      _triggerAt(0),
+      _manualPending(false),
+      _wasValid(false),
+      _saturatedRun(0),
+      _slot(nullptr)
+{
+    memset(&_status, 0, sizeof(_status));
+    _status.state = FLIGHT_IDLE;
+}
+
+void FlightRecorder::begin(FlightRecord* buffer, uint32_t capacity) {
+    bool powerOfTwo = capacity > 1 && (capacity & (capacity - 1)) == 0;
+    _buffer = powerOfTwo ? buffer : nullptr;
+    _capacity = _buffer ? capacity : 0;
+    _status.capacity = _capacity;
+    _published.write(_status);
+}
+
+void FlightRecorder::arm(const FlightRecorderSettings& settings) {
+    _pendingSettings.write(settings);
+    _requests.fetch_or(REQUEST_ARM, std::memory_order_release);
+}
+
+void FlightRecorder::trigger() {
+    _requests.fetch_or(REQUEST_TRIGGER, std::memory_order_release);
+}
+
+void FlightRecorder::disarm() {
+    _requests.fetch_or(REQUEST_DISARM, std::memory_order_release);
+}
+
+void FlightRecorder::applyRequests(uint32_t requests) {
+    if (requests & REQUEST_DISARM) {
+        _status.state = FLIGHT_IDLE;
+        _status.count = 0;
+    }
+    if (requests & REQUEST_ARM) {
+        FlightRecorderSettings settings = _pendingSettings.read();
+        settings.preTriggerPct = settings.preTriggerPct > 100 ? 100 : settings.preTriggerPct;
+        settings.saturationCycles = settings.saturationCycles < 1 ? 1 : settings.saturationCycles;
+        // Readers of the old capture check the generation after copying, so
+        // bumping it before the ring is overwritten makes them discard the copy
+        _generation.store(_status.generation + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        _status.generation++;
+        _status.settings = settings;
+        _status.state = FLIGHT_ARMED;
+        _status.count = 0;
+        _status.triggerIndex = 0;
+        _count = 0;
+        _written.store(0, std::memory_order_relaxed);
+        _manualPending = false;
+        _wasValid = false;
+        _saturatedRun = 0;
+    }
+    if ((requests & REQUEST_TRIGGER) && _status.state == FLIGHT_ARMED) {
+        _manualPending = true;
+    }
+    _published.write(_status);
+}
+
+FlightRecord* FlightRecorder::prepare() {
+    _slot = nullptr;
+    if (_requests.load(std::memory_order_relaxed) != 0) {
+        applyRequests(_requests.exchange(0, std::memory_order_acquire));
+    }
+    if (!_buffer || (_status.state != FLIGHT_ARMED && _status.state != FLIGHT_TRIGGERED)) {
+        return nullptr;
+    }
+    _slot = &_buffer[_count & (_capacity - 1)];
+    return _slot;
+}
+
+int FlightRecorder::checkTriggers(const FlightRecord& record) {
+    const FlightRecorderSettings& s = _status.settings;
+    bool valid = (record.flags & FLIGHT_FLAG_VALID) != 0;
+    bool autoMode = (record.flags & FLIGHT_FLAG_AUTO) != 0;
+    bool lost = autoMode && _wasValid && !valid;
+    _wasValid = autoMode && valid;
+
+    uint8_t saturated = record.flags & (FLIGHT_FLAG_SATURATED * 7); // Any axis
+    _saturatedRun = saturated ? (_saturatedRun < 0xFFFF ? _saturatedRun + 1 : _saturatedRun) : 0;
+
+    if (_manualPending) {
+        return FLIGHT_TRIGGER_MANUAL;
+    }
+    if (s.triggers & (1 << FLIGHT_TRIGGER_ERROR)) {
+        bool tracking = false;
+        if (autoMode && valid) {
+            int32_t limit = toFlightCentis(s.errorDeg);
+            for (int i = 0; i < 3; i++) {
+                int32_t error = (int32_t)record.setpoint[i] - record.attitude[i];
+                tracking |= error > limit || error < -limit;
+            }
+        }
+        if (tracking || lost || (record.flags & FLIGHT_FLAG_OVERRUN)) {
+            return FLIGHT_TRIGGER_ERROR;
+        }
+    }
+    if ((s.triggers & (1 << FLIGHT_TRIGGER_SATURATION)) && _saturatedRun >= s.saturationCycles) {
+        return FLIGHT_TRIGGER_SATURATION;
+    }
+    return -1;
+}
+
+void FlightRecorder::commit() {
+    if (!_slot) {
+        return;
+    }
+    FlightRecord& record = *_slot;
+    _slot = nullptr;
+    _count++;
+
+    bool changed = false;
+    if (_status.state == FLIGHT_ARMED) {
+        int cause = checkTriggers(record);
+        if (cause >= 0) {
+            record.flags |= FLIGHT_FLAG_TRIGGER;
+            _manualPending = false;
+            // The trigger record ends the pre-trigger share of the ring
+            uint32_t pre = (uint32_t)((uint64_t)_capacity * _status.settings.preTriggerPct / 100);
+            pre = pre >= _capacity ? _capacity - 1 : pre;
+            _triggerAt = _count - 1;
+            _stopAt = _triggerAt + (_capacity - pre);
+            _status.state = FLIGHT_TRIGGERED;
+            _status.cause = (uint8_t)cause;
+            changed = true;
+        }
+    }
+    if (_status.state == FLIGHT_TRIGGERED && _count >= _stopAt) {
+        uint32_t held = _count < _capacity ? _count : _capacity;
+        _status.count = held;
+        _status.triggerIndex = _triggerAt - (_count - held);
+        _status.state = FLIGHT_CAPTURED;
+        changed = true;
+    }
+    _written.store(_count, std::memory_order_release);
+    if (changed) {
+        _published.write(_status);
+    }
+}
+
+FlightRecorderStatus FlightRecorder::status() const {
+    FlightRecorderStatus status = _published.read();
+    if (status.state == FLIGHT_ARMED || status.state == FLIGHT_TRIGGERED) {
+        uint32_t written = _written.load(std::memory_order_acquire);
+        status.count = written < status.capacity ? written : status.capacity;
+    }
+    return status;
+}
+
+size_t FlightRecorder::read(uint32_t generation, uint32_t first, FlightRecord* out, size_t max) const {
+    FlightRecorderStatus status = _published.read();
+    if (status.state != FLIGHT_CAPTURED || status.generation != generation || first >= status.count) {
+        return 0;
+    }
+    size_t n = status.count - first;
+    n = n < max ? n : max;
+    // The capture ends at the last record written; the oldest held one is
+    // `count` before it
+    uint32_t end = _written.load(std::memory_order_acquire);
+    uint32_t start = end - status.count + first;
+    for (size_t i = 0; i < n; i++) {
+        out[i] = _buffer[(start + i) & (status.capacity - 1)];
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (_generation.load(std::memory_order_relaxed) != generation) {
+        return 0;
+    }
+    return n;
+}
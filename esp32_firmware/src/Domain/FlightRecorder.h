@@ -0,0 +1,168 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include "SeqLock.h"
+
+// Pure C++ (no Arduino dependencies) so it can run and be benchmarked on the host.
+
+// FlightRecord::flags
+enum FlightRecordFlag : uint8_t {
+    FLIGHT_FLAG_VALID = 0x01,      // Attitude estimate used by the controller
+    FLIGHT_FLAG_AUTO = 0x02,       // Auto-mode PIDs ran this cycle
+    FLIGHT_FLAG_OVERRUN = 0x04,    // The previous cycle ran past its period
+    FLIGHT_FLAG_TRIGGER = 0x08,    // This record fired the trigger
+    FLIGHT_FLAG_SATURATED = 0x10   // Shifted left by the axis: correction pinned at the servo range
+};
+
+// One control cycle, 64 bytes, little-endian. Angles and PID terms are in
+// hundredths of a degree, clamped to +/-327.67; the IMU is in raw sensor
+// counts, with the scales in the capture header.
+struct FlightRecord {
+    uint32_t timeUs;            // Start of the cycle
+    uint16_t dtUs;              // Measured control period
+    uint8_t samples;            // IMU samples consumed this cycle
+    uint8_t flags;              // FlightRecordFlag
+    int16_t accel[3];           // Raw counts of the newest sample, body x/y/z
+    int16_t gyro[3];
+    int16_t temperature;        // 0.01 deg C
+    int16_t attitude[3];        // cdeg, yaw/pitch/roll estimate
+    int16_t setpoint[3];        // cdeg; auto: target relative to level, otherwise servo target
+    int16_t pTerm[3];           // cdeg of correction; zero outside auto mode
+    int16_t iTerm[3];
+    int16_t dTerm[3];
+    int16_t feedForward[3];
+    uint16_t servoQuarterUs[3]; // Pulse width written, 0.25 us
+};
+static_assert(sizeof(FlightRecord) == 64, "FlightRecord layout is part of the download format");
+
+inline int16_t toFlightCentis(float value) {
+    float scaled = value * 100.0f;
+    scaled = scaled > 32767.0f ? 32767.0f : scaled;
+    scaled = scaled < -32767.0f ? -32767.0f : scaled;
+    return (int16_t)(scaled + (scaled >= 0 ? 0.5f : -0.5f));
+}
+
+enum FlightRecorderState : uint8_t {
+    FLIGHT_IDLE,      // Not recording
+    FLIGHT_ARMED,     // Recording into the ring, waiting for a trigger
+    FLIGHT_TRIGGERED, // Recording the post-trigger part
+    FLIGHT_CAPTURED   // Frozen until downloaded and re-armed
+};
+
+// "idle", "armed", "triggered", "captured"
+extern const char* const FLIGHT_STATE_NAMES[FLIGHT_CAPTURED + 1];
+
+enum FlightTrigger : uint8_t {
+    FLIGHT_TRIGGER_MANUAL,     // POST /api/recorder/trigger; always enabled
+    FLIGHT_TRIGGER_ERROR,      // Auto-mode tracking error, estimate lost or control overrun
+    FLIGHT_TRIGGER_SATURATION, // A correction pinned at the servo range for a while
+    FLIGHT_TRIGGER_COUNT
+};
+
+// "manual", "error", "saturation"
+extern const char* const FLIGHT_TRIGGER_NAMES[FLIGHT_TRIGGER_COUNT];
+bool parseFlightTrigger(const char* name, FlightTrigger& trigger); // False for an unknown or null name
+
+struct FlightRecorderSettings {
+    uint8_t triggers;          // Bit per FlightTrigger
+    uint8_t preTriggerPct;     // Share of the buffer kept from before the trigger, 0-100
+    uint16_t saturationCycles; // Consecutive saturated cycles that fire the saturation trigger
+    float errorDeg;            // Auto-mode |setpoint - attitude| on any axis that fires the error trigger
+};
+
+struct FlightRecorderStatus {
+    uint8_t state;          // FlightRecorderState
+    uint8_t cause;          // FlightTrigger, once triggered
+    uint32_t generation;    // Counts arms; a download checks it still reads the same capture
+    uint32_t capacity;      // Records the buffer holds; 0 = no buffer
+    uint32_t count;         // Records held
+    uint32_t triggerIndex;  // Record that fired, counted from the oldest (captured only)
+    FlightRecorderSettings settings;
+};
+
+// Download header, followed by `count` FlightRecords oldest first
+struct FlightCaptureHeader {
+    char magic[4];          // "GFR1"
+    uint16_t version;       // FLIGHT_CAPTURE_VERSION
+    uint16_t recordSize;    // sizeof(FlightRecord)
+    uint32_t count;
+    uint32_t triggerIndex;
+    uint8_t cause;          // FlightTrigger
+    uint8_t reserved[3];
+    uint32_t rateHz;        // Nominal control rate
+    float accelLsbPerG;     // Raw IMU scales
+    float gyroLsbPerDps;
+};
+static_assert(sizeof(FlightCaptureHeader) == 32, "FlightCaptureHeader layout is part of the download format");
+
+const uint16_t FLIGHT_CAPTURE_VERSION = 1;
+
+FlightCaptureHeader makeFlightCaptureHeader(const FlightRecorderStatus& status, uint32_t rateHz,
+                                            float accelLsbPerG, float gyroLsbPerDps);
+
+// Flight recorder: every control cycle is written into a ring of
+// FlightRecords (PSRAM on the device) until a trigger fires, then the
+// post-trigger share of the ring is filled and the capture frozen for
+// download.
+//
+// The control task is the only writer and owns every state change. Other
+// tasks post requests (arm, trigger, disarm) that it applies at its next
+// cycle, and read the published status and the frozen capture, so neither
+// side ever waits. A capture being downloaded is only overwritten after a
+// new arm; read() notices that from the generation and returns nothing.
+class FlightRecorder {
+public:
+    FlightRecorder();
+
+    // capacity must be a power of two. Without a buffer prepare() always
+    // returns null.
+    void begin(FlightRecord* buffer, uint32_t capacity);
+    bool available() const { return _buffer != nullptr; }
+
+    // From one task at a time; applied by the control task on its next cycle.
+    // Arming discards any capture.
+    void arm(const FlightRecorderSettings& settings);
+    void trigger(); // Manual trigger; ignored unless armed
+    void disarm();
+
+    // Control task, once per cycle: prepare() returns the slot to fill, or
+    // null when not recording (one atomic load when idle), and commit()
+    // stores it and checks the triggers.
+    FlightRecord* prepare();
+    void commit();
+
+    FlightRecorderStatus status() const;
+    // Copies up to max records of capture `generation`, starting `first`
+    // records after its oldest. Returns the number copied; 0 past the end,
+    // unless captured, or once the recorder has been re-armed.
+    size_t read(uint32_t generation, uint32_t first, FlightRecord* out, size_t max) const;
+
+private:
+    enum Request : uint32_t {
+        REQUEST_ARM = 1,
+        REQUEST_TRIGGER = 2,
+        REQUEST_DISARM = 4
+    };
+
+    FlightRecord* _buffer;
+    uint32_t _capacity;
+    std::atomic<uint32_t> _requests;
+    SeqLock<FlightRecorderSettings> _pendingSettings;
+    SeqLock<FlightRecorderStatus> _published; // Written on every state change
+    std::atomic<uint32_t> _written;           // Records since the arm, for status()
+    std::atomic<uint32_t> _generation;        // Bumped before a new arm overwrites the ring
+
+    // Control task only
+    FlightRecorderStatus _status;
+    uint32_t _count;          // Records since the arm
+    uint32_t _stopAt;         // _count at which the capture freezes
+    uint32_t _triggerAt;
+    bool _manualPending;
+    bool _wasValid;
+    uint16_t _saturatedRun;
+    FlightRecord* _slot;      // Handed out by prepare()
+
+    void applyRequests(uint32_t requests);
+    int checkTriggers(const FlightRecord& record); // FlightTrigger, or -1
+};
@@ -0,0 +1,56 @@
+#include "GainSchedule.h"
+#include <string.h>
+
+const char* const AXIS_NAMES[AXIS_COUNT] = {"yaw", "pitch", "roll"};
+
+bool parseAxisName(const char* name, GimbalAxis& axis) {
+    for (int i = 0; name && i < AXIS_COUNT; i++) {
+        if (strcmp(name, AXIS_NAMES[i]) == 0) {
+            axis = (GimbalAxis)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+PidGains scheduleGains(const PidGains& base, const GainSchedule& schedule, float absError) {
+    if (schedule.count == 0) {
+        return base;
+    }
+
+    const GainSchedulePoint* points = schedule.points;
+    int last = schedule.count - 1;
+    GainSchedulePoint factor;
+    if (absError <= points[0].error) {
+        factor = points[0];
+    } else if (absError >= points[last].error) {
+        factor = points[last];
+    } else {
+        int i = 1;
+        while (absError > points[i].error) i++;
+        const GainSchedulePoint& a = points[i - 1];
+        const GainSchedulePoint& b = points[i];
+        float t = (absError - a.error) / (b.error - a.error);
+        factor.kpScale = a.kpScale + (b.kpScale - a.kpScale) * t;
+        factor.kiScale = a.kiScale + (b.kiScale - a.kiScale) * t;
+        factor.kdScale = a.kdScale + (b.kdScale - a.kdScale) * t;
+    }
+
+    return {base.kp * factor.kpScale, base.ki * factor.kiScale, base.kd * factor.kdScale};
+}
+
+void normalizeSchedule(GainSchedule& schedule) {
+    if (schedule.count > GainSchedule::MAX_POINTS) {
+        schedule.count = GainSchedule::MAX_POINTS;
+    }
+    // Insertion sort; at most MAX_POINTS entries
+    for (int i = 1; i < schedule.count; i++) {
+        GainSchedulePoint p = schedule.points[i];
+        int j = i - 1;
+        while (j >= 0 && schedule.points[j].error > p.error) {
+            schedule.points[j + 1] = schedule.points[j];
+            j--;
+        }
+        schedule.points[j + 1] = p;
+    }
+}
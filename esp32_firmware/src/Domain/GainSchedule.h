@@ -0,0 +1,44 @@
+#pragma once
+#include <stdint.h>
+
+// Pure C++ (no Arduino dependencies) so it can run and be benchmarked on the host.
+
+enum GimbalAxis {
+    AXIS_YAW = 0,
+    AXIS_PITCH = 1,
+    AXIS_ROLL = 2,
+    AXIS_COUNT = 3
+};
+
+// "yaw", "pitch", "roll": the axis keys used in config.json and the API
+extern const char* const AXIS_NAMES[AXIS_COUNT];
+bool parseAxisName(const char* name, GimbalAxis& axis); // False for an unknown or null name
+
+struct PidGains {
+    float kp;
+    float ki;
+    float kd;
+};
+
+// One breakpoint of a gain schedule: gains are multiplied by these factors
+// at the given absolute error in degrees
+struct GainSchedulePoint {
+    float error;
+    float kpScale;
+    float kiScale;
+    float kdScale;
+};
+
+// Error-keyed gain schedule shared by all axes as scale factors on each
+// axis's own gains. Factors are interpolated linearly between breakpoints and
+// held flat outside them. count == 0 disables scheduling.
+struct GainSchedule {
+    static const int MAX_POINTS = 4;
+    uint8_t count;
+    GainSchedulePoint points[MAX_POINTS]; // Ascending error
+};
+
+PidGains scheduleGains(const PidGains& base, const GainSchedule& schedule, float absError);
+
+// Clamps count and sorts points by error; call on any schedule from outside
+void normalizeSchedule(GainSchedule& schedule);
@@ -1,79 +1,280 @@
 #include "GimbalController.h"
+#include "EventLog.h"
 #include <math.h>
 
+namespace {
+// Weight of each cycle's dt in the averaged loop period
+const float LOOP_DT_AVERAGING = 0.02f;
+
+const int SERVO_PINS[AXIS_COUNT] = {SERVO_PIN_YAW, SERVO_PIN_PITCH, SERVO_PIN_ROLL};
+const float PHONE_GYRO_GAINS[AXIS_COUNT] = {PHONE_GYRO_GAIN_YAW, PHONE_GYRO_GAIN_PITCH, PHONE_GYRO_GAIN_ROLL};
+const AxisLimits TRAJECTORY_LIMITS[AXIS_COUNT] = {
+    {TRAJ_MAX_VELOCITY_YAW, TRAJ_MAX_ACCEL_YAW, TRAJ_MAX_JERK_YAW},
+    {TRAJ_MAX_VELOCITY_PITCH, TRAJ_MAX_ACCEL_PITCH, TRAJ_MAX_JERK_PITCH},
+    {TRAJ_MAX_VELOCITY_ROLL, TRAJ_MAX_ACCEL_ROLL, TRAJ_MAX_JERK_ROLL},
+};
+
+void toAxes(const GimbalPosition& pos, float out[AXIS_COUNT]) {
+    out[AXIS_YAW] = pos.yaw;
+    out[AXIS_PITCH] = pos.pitch;
+    out[AXIS_ROLL] = pos.roll;
+}
+
+GimbalPosition fromAxes(const float in[AXIS_COUNT]) {
+    return {in[AXIS_YAW], in[AXIS_PITCH], in[AXIS_ROLL]};
+}
+}
+
 GimbalController::GimbalController(ConfigManager& configManager)
-    : _configManager(configManager),
-      _pidYaw(configManager.getConfig().kp, configManager.getConfig().ki, configManager.getConfig().kd),
-      _pidPitch(configManager.getConfig().kp, configManager.getConfig().ki, configManager.getConfig().kd),
-      _pidRoll(configManager.getConfig().kp, configManager.getConfig().ki, configManager.getConfig().kd)
+    : _configManager(configManager)
 {
-    _currentPos = {90, 90, 90};
-    _targetPos = {90, 90, 90};
-    _autoTarget = {90, 90, 90};
-    _phoneGyroRates = {0, 0, 0};
+    _mutex = xSemaphoreCreateMutex();
+    for (int i = 0; i < AXIS_COUNT; i++) {
+        _axes.target[i] = SERVO_CENTER;
+        _axes.position[i] = SERVO_CENTER;
+        _axes.servoRate[i] = 0;
+        _autoTarget[i] = SERVO_CENTER;
+        _scheduleError[i] = 0;
+        _phoneGyroRates[i] = 0;
+    }
+    resetAxisPid(_pid);
+    memset(&_filters, 0, sizeof(_filters)); // designDt = 0: designed on the first cycle
+    _loopDt = 0;
+    _attitude = {0, 0, 0, false, 0, 0, 0};
     _phoneGyroLastMs = 0;
     _phoneGyroActive = false;
     _moveActive = false;
-    _mutex = xSemaphoreCreateMutex();
+    _moveCursor = 0;
+    _moveElapsed = 0;
+    _commandSeq = 0;
+    _moveSeq = 0;
+    _mode = MODE_MANUAL;
+    memset(&_trace, 0, sizeof(_trace));
+    _traced = false;
+    setPidShaping({PID_DERIVATIVE_TAU, PID_SETPOINT_WEIGHT, PID_FEEDFORWARD_GAIN, PID_OUTPUT_RATE_LIMIT, true});
+    refreshParams();
+    publishState();
 }
 
 void GimbalController::begin() {
-    ESP32PWM::allocateTimer(0);
-    ESP32PWM::allocateTimer(1);
-    ESP32PWM::allocateTimer(2);
-
-    _servoYaw.setPeriodHertz(50);
-    _servoPitch.setPeriodHertz(50);
-    _servoRoll.setPeriodHertz(50);
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    refreshParams();
+    for (int i = 0; i < AXIS_COUNT; i++) {
+        _servos[i].begin(SERVO_PINS[i], SERVO_LEDC_CHANNEL_BASE + i, _params.servo_refresh_hz);
+    }
+    _mode = _params.mode;
+    updateServos(0, true); // Write the initial position; no loop period yet
+    publishState();
+    xSemaphoreGive(_mutex);
+}
 
-    _servoYaw.attach(SERVO_PIN_YAW, 500, 2500);
-    _servoPitch.attach(SERVO_PIN_PITCH, 500, 2500);
-    _servoRoll.attach(SERVO_PIN_ROLL, 500, 2500);
+void GimbalController::update(float dt, const AttitudeEstimate& attitude, FlightRecord* record) {
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    _traced = false;
 
-    AppConfig config = _configManager.getConfig();
-    updateServos(config);
-}
+    // One atomic load per cycle; gains are copied only after a config change
+    if (_configManager.getControlVersion() != _params.version) {
+        refreshParams();
+    }
 
-void GimbalController::update(float dt, float gyroYaw, float gyroPitch, float gyroRoll) {
-    // Get config before taking mutex to avoid lock-order inversion
-    AppConfig config = _configManager.getConfig(); // Copy by value
+    _attitude = attitude;
+    if (_params.mode != _mode && _selfTest.active()) {
+        _selfTest.cancel();
+        for (int i = 0; i < AXIS_COUNT; i++) _axes.target[i] = _axes.position[i];
+    }
+    _mode = _params.mode;
+    if (_mode != MODE_MANUAL) {
+        _calibration.cancel();
+    }
+    if (_mode != MODE_AUTO && _autotune.active()) {
+        _autotune.cancel();
+    }
 
-    xSemaphoreTake(_mutex, portMAX_DELAY);
+    applyCommands(_mode);
 
-    // Update PID tunings
-    _pidYaw.setTunings(config.kp, config.ki, config.kd);
-    _pidPitch.setTunings(config.kp, config.ki, config.kd);
-    _pidRoll.setTunings(config.kp, config.ki, config.kd);
+    // The self-test owns the servos while it runs. Its steps are written
+    // directly, so the response measured is the servo's and not the filter's.
+    if (_selfTest.active()) {
+        const float measured[AXIS_COUNT] = {_attitude.yaw, _attitude.pitch, _attitude.roll};
+        _selfTest.update(dt, measured, _attitude.valid, _axes.target);
+        updateServos(dt, true);
+        if (record) traceCycle(*record);
+        publishState();
+        xSemaphoreGive(_mutex);
+        return;
+    }
 
-    // Always update timed moves regardless of mode
-    updateTimedMove();
+    // Always update timed moves regardless of mode. A move's last cycle is
+    // still written directly, so it ends exactly on the final keyframe.
+    bool moving = _moveActive;
+    updateTimedMove(dt);
 
     // Apply phone gyro rate control in manual mode
-    if (config.mode == MODE_MANUAL) {
+    if (_mode == MODE_MANUAL) {
         updatePhoneGyro(dt);
     }
 
-    if (config.mode == MODE_AUTO) {
-        updateAuto(dt, gyroYaw, gyroPitch, gyroRoll);
+    if (_mode == MODE_AUTO) {
+        updateAuto(dt);
     }
 
-    updateServos(config);
+    updateServos(dt, moving && _mode != MODE_AUTO);
+    if (record) traceCycle(*record);
+    publishState();
 
     xSemaphoreGive(_mutex);
 }
 
-void GimbalController::updateAuto(float dt, float gyroYaw, float gyroPitch, float gyroRoll) {
-    float errorYaw = _autoTarget.yaw - (_currentPos.yaw + gyroYaw);
-    float errorPitch = _autoTarget.pitch - (_currentPos.pitch + gyroPitch);
-    float errorRoll = _autoTarget.roll - (_currentPos.roll + gyroRoll);
+void GimbalController::refreshParams() {
+    // Called with _mutex held. With a gain schedule the next auto cycle
+    // rescales these by the current error.
+    OutputFilterConfig previousFilters[AXIS_COUNT];
+    memcpy(previousFilters, _params.output_filter, sizeof(previousFilters));
+    _params = _configManager.getControlParams();
+    // Only a filter change restarts the filters; other config changes keep their state
+    if (memcmp(previousFilters, _params.output_filter, sizeof(previousFilters)) != 0) {
+        _filters.designDt = 0;
+    }
+    for (int i = 0; i < AXIS_COUNT; i++) {
+        // Bumpless against the gains in use, so scheduled at the error they
+        // were last scheduled at
+        setAxisGains(_pid, (GimbalAxis)i, scheduleGains(_params.gains[i], _params.gainSchedule, _scheduleError[i]),
+                     true);
+        _servos[i].setEndpoints(_params.servo_endpoints[i].minUs, _params.servo_endpoints[i].maxUs);
+        _servos[i].setCalibration(_params.servo_calibration[i]);
+        _servos[i].setRefreshRate(_params.servo_refresh_hz);
+    }
+}
 
-    float correctionYaw = _pidYaw.compute(0, -errorYaw, dt);
-    float correctionPitch = _pidPitch.compute(0, -errorPitch, dt);
-    float correctionRoll = _pidRoll.compute(0, -errorRoll, dt);
+void GimbalController::publishState() {
+    GimbalState state;
+    state.position = fromAxes(_axes.position);
+    state.target = fromAxes(_axes.target);
+    state.autoTarget = fromAxes(_autoTarget);
+    state.attitude = _attitude;
+    state.mode = _mode;
+    state.moveActive = _moveActive;
+    state.moveDuration = _moveActive ? _trajectory.duration() : 0.0f;
+    state.moveProgress = _moveActive ? constrain(_moveElapsed / state.moveDuration, 0.0f, 1.0f) : 0.0f;
+    state.phoneGyroActive = _phoneGyroActive;
+    state.selfTestActive = _selfTest.active();
+    state.timeMs = millis();
+    _state.write(state);
+}
+
+void GimbalController::applyCommands(int mode) {
+    // Called with _mutex held. Only the newest command of each kind is applied.
+    SetpointCommand cmd;
 
-    _targetPos.yaw = _currentPos.yaw + correctionYaw;
-    _targetPos.pitch = _currentPos.pitch + correctionPitch;
-    _targetPos.roll = _currentPos.roll + correctionRoll;
+    if (_autoTargetMailbox.take(cmd)) {
+        toAxes(cmd.value, _autoTarget);
+    }
+
+    if (_manualMailbox.take(cmd) && mode == MODE_MANUAL && cmd.seq > _moveSeq) {
+        toAxes(cmd.value, _axes.target);
+        _phoneGyroActive = false;
+        toAxes({0, 0, 0}, _phoneGyroRates);
+        _moveActive = false; // Cancel any timed move
+        _selfTest.cancel();
+    }
+
+    if (_phoneGyroMailbox.take(cmd) && mode == MODE_MANUAL && cmd.seq > _moveSeq) {
+        toAxes(cmd.value, _phoneGyroRates);
+        _phoneGyroLastMs = cmd.timeMs;
+        _phoneGyroActive = true;
+        _moveActive = false; // Cancel any timed move
+        _selfTest.cancel();
+    }
+}
+
+void GimbalController::updateAuto(float dt) {
+    // Measured platform orientation relative to level, indexed by GimbalAxis.
+    // Without an estimate (no sensor) fall back to the commanded position.
+    float gyroRate[AXIS_COUNT] = {0, 0, 0};
+    AxisPidInput in;
+    if (_attitude.valid) {
+        in.measured[AXIS_YAW] = _attitude.yaw;
+        in.measured[AXIS_PITCH] = _attitude.pitch;
+        in.measured[AXIS_ROLL] = _attitude.roll;
+        gyroRate[AXIS_YAW] = _attitude.yawRate;
+        gyroRate[AXIS_PITCH] = _attitude.pitchRate;
+        gyroRate[AXIS_ROLL] = _attitude.rollRate;
+    } else {
+        for (int i = 0; i < AXIS_COUNT; i++) in.measured[i] = _axes.position[i] - SERVO_CENTER;
+    }
+
+    const bool scheduled = _params.gainSchedule.count > 0;
+    for (int i = 0; i < AXIS_COUNT; i++) {
+        // Work relative to level so setpoint weighting does not act on the
+        // SERVO_CENTER offset
+        in.setpoint[i] = _autoTarget[i] - SERVO_CENTER;
+
+        if (scheduled) {
+            // Not bumpless: the schedule follows the error, and folding each
+            // step would leave the whole sum in the integral
+            _scheduleError[i] = fabsf(in.setpoint[i] - in.measured[i]);
+            setAxisGains(_pid, (GimbalAxis)i, scheduleGains(_params.gains[i], _params.gainSchedule, _scheduleError[i]));
+        }
+
+        // The correction is added to the filtered position, so the servo range
+        // bounds it; the PID stops integrating once it is pinned there
+        in.outMin[i] = _shaping.antiWindup ? SERVO_MIN_ANGLE - _axes.position[i] : -INFINITY;
+        in.outMax[i] = _shaping.antiWindup ? SERVO_MAX_ANGLE - _axes.position[i] : INFINITY;
+
+        // The camera gyro sees base motion plus our own servo motion; what is
+        // left after removing the servo rate is the disturbance to cancel. A
+        // correction c moves the filtered position at about c / lag deg/s,
+        // which converts the rate into a correction.
+        in.feedForward[i] = -_shaping.feedForwardGain * _filters.lag[i] * (gyroRate[i] - _axes.servoRate[i]);
+    }
+
+    // The axis under autotune sees zero error so its PID neither integrates
+    // nor kicks, and picks up where it left off once the relay stops
+    float error[AXIS_COUNT];
+    for (int i = 0; i < AXIS_COUNT; i++) error[i] = in.setpoint[i] - in.measured[i];
+    bool tuning = _autotune.testing();
+    GimbalAxis tuned = _autotune.axis();
+    if (tuning) in.setpoint[tuned] = in.measured[tuned];
+
+    float correction[AXIS_COUNT];
+    computeAxisPid(_pid, _shaping, in, dt, 1.0f / dt, correction);
+    if (_autotune.active()) {
+        _autotune.update(dt, error, _attitude.valid, correction);
+        if (tuning) correction[tuned] = clampf(correction[tuned], in.outMin[tuned], in.outMax[tuned]);
+    }
+    for (int i = 0; i < AXIS_COUNT; i++) {
+        _axes.target[i] = _axes.position[i] + correction[i];
+    }
+
+    // The kernel only keeps the integral; the other terms are rebuilt from
+    // its inputs for the flight recorder
+    _trace.saturated = 0;
+    for (int i = 0; i < AXIS_COUNT; i++) {
+        _trace.p[i] = _pid.kp[i] * (_shaping.setpointWeight * in.setpoint[i] - in.measured[i]);
+        _trace.i[i] = _pid.iTerm[i];
+        _trace.d[i] = -_pid.kd[i] * _pid.derivative[i];
+        _trace.feedForward[i] = in.feedForward[i];
+        _trace.saturated |= (correction[i] <= in.outMin[i] || correction[i] >= in.outMax[i]) ? 1 << i : 0;
+    }
+    _traced = true;
+}
+
+void GimbalController::traceCycle(FlightRecord& record) const {
+    // Called with _mutex held, after the servos were written
+    const float attitude[AXIS_COUNT] = {_attitude.yaw, _attitude.pitch, _attitude.roll};
+    record.flags |= _attitude.valid ? FLIGHT_FLAG_VALID : 0;
+    if (_traced) {
+        record.flags |= FLIGHT_FLAG_AUTO | _trace.saturated * FLIGHT_FLAG_SATURATED;
+    }
+    for (int i = 0; i < AXIS_COUNT; i++) {
+        record.attitude[i] = toFlightCentis(attitude[i]);
+        record.setpoint[i] = toFlightCentis(_traced ? _autoTarget[i] - SERVO_CENTER : _axes.target[i]);
+        record.pTerm[i] = _traced ? toFlightCentis(_trace.p[i]) : 0;
+        record.iTerm[i] = _traced ? toFlightCentis(_trace.i[i]) : 0;
+        record.dTerm[i] = _traced ? toFlightCentis(_trace.d[i]) : 0;
+        record.feedForward[i] = _traced ? toFlightCentis(_trace.feedForward[i]) : 0;
+        record.servoQuarterUs[i] = (uint16_t)(_servos[i].getPulseUs() * 4.0f + 0.5f);
+    }
 }
 
 void GimbalController::updatePhoneGyro(float dt) {
@@ -84,64 +285,52 @@ void GimbalController::updatePhoneGyro(float dt) {
     uint32_t age = millis() - _phoneGyroLastMs;
     if (age > PHONE_GYRO_TIMEOUT_MS) {
         _phoneGyroActive = false;
-        _phoneGyroRates = {0, 0, 0};
+        toAxes({0, 0, 0}, _phoneGyroRates);
         return;
     }
 
-    float gx = _phoneGyroRates.pitch;
-    float gy = _phoneGyroRates.roll;
-    float gz = _phoneGyroRates.yaw;
-
-    if (fabsf(gx) < PHONE_GYRO_DEADBAND_RAD_S) gx = 0.0f;
-    if (fabsf(gy) < PHONE_GYRO_DEADBAND_RAD_S) gy = 0.0f;
-    if (fabsf(gz) < PHONE_GYRO_DEADBAND_RAD_S) gz = 0.0f;
-
     const float radToDeg = 57.2958f;
-    float yawDelta = gz * radToDeg * PHONE_GYRO_GAIN_YAW * dt;
-    float pitchDelta = gx * radToDeg * PHONE_GYRO_GAIN_PITCH * dt;
-    float rollDelta = gy * radToDeg * PHONE_GYRO_GAIN_ROLL * dt;
-
-    _targetPos.yaw += yawDelta;
-    _targetPos.pitch += pitchDelta;
-    _targetPos.roll += rollDelta;
+    for (int i = 0; i < AXIS_COUNT; i++) {
+        float rate = _phoneGyroRates[i];
+        rate = fabsf(rate) < PHONE_GYRO_DEADBAND_RAD_S ? 0.0f : rate;
+        _axes.target[i] += rate * radToDeg * PHONE_GYRO_GAINS[i] * dt;
+    }
 }
 
-void GimbalController::updateTimedMove() {
+void GimbalController::updateTimedMove(float dt) {
     if (!_moveActive) return;
 
-    unsigned long elapsed = millis() - _moveStartTime;
-
-    if (elapsed >= _moveDuration) {
+    _moveElapsed += dt;
+    _trajectory.evaluate(_moveElapsed, _moveCursor, _axes.target);
+    if (_moveElapsed >= _trajectory.duration()) {
         _moveActive = false;
-        _targetPos = _moveEndPos;
-        return;
     }
-
-    float progress = (float)elapsed / _moveDuration;
-    _targetPos.yaw = _moveStartPos.yaw + (_moveEndPos.yaw - _moveStartPos.yaw) * progress;
-    _targetPos.pitch = _moveStartPos.pitch + (_moveEndPos.pitch - _moveStartPos.pitch) * progress;
-    _targetPos.roll = _moveStartPos.roll + (_moveEndPos.roll - _moveStartPos.roll) * progress;
 }
 
-void GimbalController::updateServos(const AppConfig& config) {
-    // Smoothing
-    _currentPos.yaw += (_targetPos.yaw - _currentPos.yaw) * 0.1;
-    _currentPos.pitch += (_targetPos.pitch - _currentPos.pitch) * 0.1;
-    _currentPos.roll += (_targetPos.roll - _currentPos.roll) * 0.1;
-
-    // Constrain logical position
-    _currentPos.yaw = constrain(_currentPos.yaw, SERVO_MIN_ANGLE, SERVO_MAX_ANGLE);
-    _currentPos.pitch = constrain(_currentPos.pitch, SERVO_MIN_ANGLE, SERVO_MAX_ANGLE);
-    _currentPos.roll = constrain(_currentPos.roll, SERVO_MIN_ANGLE, SERVO_MAX_ANGLE);
-
-    // Apply configured servo offsets (trim) before writing to hardware, then clamp
-    float yawCommand = constrain(_currentPos.yaw + config.yaw_offset, SERVO_MIN_ANGLE, SERVO_MAX_ANGLE);
-    float pitchCommand = constrain(_currentPos.pitch + config.pitch_offset, SERVO_MIN_ANGLE, SERVO_MAX_ANGLE);
-    float rollCommand = constrain(_currentPos.roll + config.roll_offset, SERVO_MIN_ANGLE, SERVO_MAX_ANGLE);
+void GimbalController::updateServos(float dt, bool direct) {
+    // The filters are designed for the averaged loop period, so one late
+    // cycle does not redesign them but a different loop rate does and the
+    // response stays the same
+    if (dt > 0) {
+        _loopDt = _loopDt > 0 ? _loopDt + (dt - _loopDt) * LOOP_DT_AVERAGING : dt;
+        if (fabsf(_loopDt - _filters.designDt) > SERVO_FILTER_DT_TOLERANCE * _filters.designDt) {
+            designAxisFilters(_filters, _params.output_filter, _loopDt, _axes.position);
+        }
+    }
 
-    _servoYaw.write((int)yawCommand);
-    _servoPitch.write((int)pitchCommand);
-    _servoRoll.write((int)rollCommand);
+    // Trajectories are already smooth and are written directly (direct = true)
+    filterAxes(_axes, _filters, direct || dt <= 0, dt > 0 ? 1.0f / dt : 0.0f, SERVO_MIN_ANGLE, SERVO_MAX_ANGLE);
+
+    // Apply configured servo offsets (trim) before writing to hardware. The
+    // command stays fractional; ServoOutput clamps it to the servo range.
+    const int offsets[AXIS_COUNT] = {_params.yaw_offset, _params.pitch_offset, _params.roll_offset};
+    for (int i = 0; i < AXIS_COUNT; i++) {
+        if (_calibration.active() && _calibration.axis() == i) {
+            _servos[i].writeMicroseconds(_calibration.pulseUs());
+        } else {
+            _servos[i].writeDegrees(_axes.position[i] + offsets[i]);
+        }
+    }
 }
 
 void GimbalController::setMode(int mode) {
@@ -153,64 +342,56 @@ void GimbalController::setMode(int mode) {
     // Now take gimbal mutex to reset PIDs if needed
     xSemaphoreTake(_mutex, portMAX_DELAY);
     if (mode == MODE_MANUAL) {
-        _pidYaw.reset();
-        _pidPitch.reset();
-        _pidRoll.reset();
+        resetAxisPid(_pid);
     }
     xSemaphoreGive(_mutex);
 }
 
-int GimbalController::getMode() {
-    return _configManager.getConfig().mode;
+void GimbalController::setPidShaping(const PIDShaping& shaping) {
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    // Same ranges PIDController accepts
+    _shaping = shaping;
+    _shaping.derivativeTau = fmaxf(shaping.derivativeTau, 0.0f);
+    _shaping.setpointWeight = clampf(shaping.setpointWeight, 0.0f, 1.0f);
+    _shaping.outputRateLimit = fmaxf(shaping.outputRateLimit, 0.0f);
+    xSemaphoreGive(_mutex);
+}
+
+int GimbalController::getMode() const {
+    return _state.read().mode;
 }
 
 void GimbalController::setManualPosition(float yaw, float pitch, float roll) {
-    if (_configManager.getConfig().mode == MODE_MANUAL) {
-        xSemaphoreTake(_mutex, portMAX_DELAY);
-        _targetPos = {yaw, pitch, roll};
-        _phoneGyroActive = false;
-        _phoneGyroRates = {0, 0, 0};
-        _moveActive = false; // Cancel any timed move
-        xSemaphoreGive(_mutex);
-    }
+    _manualMailbox.post({{yaw, pitch, roll}, nextSeq(), (uint32_t)millis()});
 }
 
 void GimbalController::setAutoTarget(float yaw, float pitch, float roll) {
-    xSemaphoreTake(_mutex, portMAX_DELAY);
-    _autoTarget = {yaw, pitch, roll};
-    xSemaphoreGive(_mutex);
+    _autoTargetMailbox.post({{yaw, pitch, roll}, nextSeq(), (uint32_t)millis()});
 }
 
 void GimbalController::setPhoneGyroRates(float gx, float gy, float gz) {
-    if (_configManager.getConfig().mode != MODE_MANUAL) {
-        return;
-    }
-
-    xSemaphoreTake(_mutex, portMAX_DELAY);
-    _phoneGyroRates = {gz, gx, gy};
-    _phoneGyroLastMs = millis();
-    _phoneGyroActive = true;
-    _moveActive = false; // Cancel any timed move
-    xSemaphoreGive(_mutex);
+    // Stored as yaw/pitch/roll rates: phone z -> yaw, x -> pitch, y -> roll
+    _phoneGyroMailbox.post({{gz, gx, gy}, nextSeq(), (uint32_t)millis()});
 }
 
 void GimbalController::clearPhoneGyro() {
     xSemaphoreTake(_mutex, portMAX_DELAY);
-    _phoneGyroRates = {0, 0, 0};
+    toAxes({0, 0, 0}, _phoneGyroRates);
     _phoneGyroActive = false;
     xSemaphoreGive(_mutex);
 }
 
-GimbalPosition GimbalController::getCurrentPosition() {
-    xSemaphoreTake(_mutex, portMAX_DELAY);
-    GimbalPosition pos = _currentPos;
-    xSemaphoreGive(_mutex);
-    return pos;
+CommandStats GimbalController::getCommandStats() const {
+    CommandStats stats;
+    stats.posted = _manualMailbox.getPostedCount() + _autoTargetMailbox.getPostedCount() + _phoneGyroMailbox.getPostedCount();
+    stats.superseded = _manualMailbox.getSupersededCount() + _autoTargetMailbox.getSupersededCount() + _phoneGyroMailbox.getSupersededCount();
+    stats.dropped = _manualMailbox.getDroppedCount() + _autoTargetMailbox.getDroppedCount() + _phoneGyroMailbox.getDroppedCount();
+    return stats;
 }
 
 void GimbalController::center() {
     // Center to the stored flat reference position instead of absolute center
-    AppConfig config = _configManager.getConfig();
+    ControlParams config = _configManager.getControlParams();
     // Use >= 0 to allow flat reference at 0 degrees (sentinel value is -1.0)
     float centerYaw = config.flat_ref_yaw >= 0 ? config.flat_ref_yaw : SERVO_CENTER;
     float centerPitch = config.flat_ref_pitch >= 0 ? config.flat_ref_pitch : SERVO_CENTER;
@@ -221,7 +402,7 @@ void GimbalController::center() {
 void GimbalController::setFlatReference() {
     // Capture the current position as the new flat reference
     xSemaphoreTake(_mutex, portMAX_DELAY);
-    GimbalPosition currentPos = _currentPos;
+    GimbalPosition currentPos = fromAxes(_axes.position);
     xSemaphoreGive(_mutex);
     
     // Update config with new flat reference
@@ -231,76 +412,235 @@ void GimbalController::setFlatReference() {
     config.flat_ref_roll = currentPos.roll;
     _configManager.updateConfig(config);
     
-    Serial.println("Flat reference set to current position:");
-    Serial.printf("  Yaw: %.2f, Pitch: %.2f, Roll: %.2f\n", 
-                  currentPos.yaw, currentPos.pitch, currentPos.roll);
+    LOG_INFO(LOG_FLAT_REFERENCE, currentPos.yaw, currentPos.pitch, currentPos.roll);
 }
 
-void GimbalController::runSelfTest() {
-    Serial.println("=== Running Gimbal Self-Test ===");
-    Serial.println("WARNING: Self-test will block for 3 seconds.");
-    Serial.println("BLE/WiFi connections may be affected.");
-    
-    // Test 1: Servo range test
-    Serial.println("Test 1: Servo Range Test");
+float GimbalController::startSelfTest() {
+    // Config read outside the gimbal mutex, as in setFlatReference()
+    ControlParams config = _configManager.getControlParams();
+    SelfTestSettings settings = {SERVO_CENTER, SELF_TEST_STEP_DEG, SERVO_MIN_ANGLE, SERVO_MAX_ANGLE,
+                                 SELF_TEST_SETTLE_S, SELF_TEST_STEP_S, SELF_TEST_RANGE_HOLD_S,
+                                 SELF_TEST_SETTLE_BAND_PCT / 100.0f};
+
     xSemaphoreTake(_mutex, portMAX_DELAY);
-    
-    // Save current position
-    GimbalPosition originalPos = _currentPos;
-    
-    // Test each axis
-    _targetPos = {SERVO_MIN_ANGLE, SERVO_CENTER, SERVO_CENTER};
+    // Return to flat reference position if set, otherwise original position.
+    // Use >= 0 to check if flat reference is set (sentinel value is -1.0)
+    float home[AXIS_COUNT];
+    if (config.flat_ref_yaw >= 0 || config.flat_ref_pitch >= 0 || config.flat_ref_roll >= 0) {
+        home[AXIS_YAW] = config.flat_ref_yaw >= 0 ? config.flat_ref_yaw : SERVO_CENTER;
+        home[AXIS_PITCH] = config.flat_ref_pitch >= 0 ? config.flat_ref_pitch : SERVO_CENTER;
+        home[AXIS_ROLL] = config.flat_ref_roll >= 0 ? config.flat_ref_roll : SERVO_CENTER;
+    } else {
+        memcpy(home, _axes.position, sizeof(home));
+    }
+
+    _moveSeq = nextSeq(); // Commands already posted do not cancel it
+    _moveActive = false;
+    _phoneGyroActive = false;
+    toAxes({0, 0, 0}, _phoneGyroRates);
+    _calibration.cancel();
+    _autotune.cancel();
+    resetAxisPid(_pid); // Auto mode restarts from the home position afterwards
+    _selfTest.start(settings, home);
+    float duration = _selfTest.totalTime();
     xSemaphoreGive(_mutex);
-    delay(500);
-    
+
+    LOG_INFO(LOG_SELF_TEST_STARTED, duration);
+    return duration;
+}
+
+void GimbalController::cancelSelfTest() {
     xSemaphoreTake(_mutex, portMAX_DELAY);
-    _targetPos = {SERVO_MAX_ANGLE, SERVO_CENTER, SERVO_CENTER};
+    if (_selfTest.active()) {
+        _selfTest.cancel();
+        for (int i = 0; i < AXIS_COUNT; i++) _axes.target[i] = _axes.position[i];
+    }
     xSemaphoreGive(_mutex);
-    delay(500);
-    
+}
+
+SelfTestStatus GimbalController::getSelfTestStatus() {
     xSemaphoreTake(_mutex, portMAX_DELAY);
-    _targetPos = {SERVO_CENTER, SERVO_MIN_ANGLE, SERVO_CENTER};
+    SelfTestStatus status;
+    status.active = _selfTest.active();
+    status.phase = _selfTest.phase();
+    status.axis = _selfTest.axis();
+    status.progress = _selfTest.progress();
+    status.duration = _selfTest.totalTime();
+    status.result = _selfTest.result();
     xSemaphoreGive(_mutex);
-    delay(500);
-    
+    return status;
+}
+
+void GimbalController::startTimedMove(float duration, GimbalPosition endPos) {
+    TrajectoryKeyframe keyframe;
+    keyframe.time = fmaxf(duration / 1000.0f, 0.001f); // An instant move is slowed to the limits
+    toAxes(endPos, keyframe.position);
+    startTrajectory(&keyframe, 1, TRAJ_SCURVE);
+}
+
+bool GimbalController::startTrajectory(const TrajectoryKeyframe* keyframes, int count, TrajectoryShape shape,
+                                       float* plannedDuration) {
+    // Plan outside the mutex so the control task is not held up. The start
+    // point is the position at the time of the call; a move normally starts
+    // from rest, where that does not change.
+    float start[AXIS_COUNT];
     xSemaphoreTake(_mutex, portMAX_DELAY);
-    _targetPos = {SERVO_CENTER, SERVO_MAX_ANGLE, SERVO_CENTER};
+    for (int i = 0; i < AXIS_COUNT; i++) start[i] = _axes.position[i];
     xSemaphoreGive(_mutex);
-    delay(500);
-    
+
+    Trajectory trajectory;
+    if (!trajectory.plan(start, keyframes, count, shape, TRAJECTORY_LIMITS)) {
+        return false;
+    }
+    if (plannedDuration) *plannedDuration = trajectory.duration();
+
     xSemaphoreTake(_mutex, portMAX_DELAY);
-    _targetPos = {SERVO_CENTER, SERVO_CENTER, SERVO_MIN_ANGLE};
+    _trajectory = trajectory;
+    _selfTest.cancel();
+    _moveSeq = nextSeq();
+    _moveActive = true;
+    _moveCursor = 0;
+    _moveElapsed = 0;
     xSemaphoreGive(_mutex);
-    delay(500);
-    
+    return true;
+}
+
+void GimbalController::stopMove() {
     xSemaphoreTake(_mutex, portMAX_DELAY);
-    _targetPos = {SERVO_CENTER, SERVO_CENTER, SERVO_MAX_ANGLE};
+    if (_moveActive) {
+        _moveActive = false;
+        for (int i = 0; i < AXIS_COUNT; i++) _axes.target[i] = _axes.position[i];
+    }
     xSemaphoreGive(_mutex);
-    delay(500);
-    
-    // Return to flat reference position if set, otherwise original position
-    AppConfig config = _configManager.getConfig();
+}
+
+bool GimbalController::startServoCalibration(GimbalAxis axis) {
+    if (axis < 0 || axis >= AXIS_COUNT) {
+        return false;
+    }
     xSemaphoreTake(_mutex, portMAX_DELAY);
-    // Use >= 0 to check if flat reference is set (sentinel value is -1.0)
-    if (config.flat_ref_yaw >= 0 || config.flat_ref_pitch >= 0 || config.flat_ref_roll >= 0) {
-        _targetPos.yaw = config.flat_ref_yaw >= 0 ? config.flat_ref_yaw : SERVO_CENTER;
-        _targetPos.pitch = config.flat_ref_pitch >= 0 ? config.flat_ref_pitch : SERVO_CENTER;
-        _targetPos.roll = config.flat_ref_roll >= 0 ? config.flat_ref_roll : SERVO_CENTER;
-    } else {
-        _targetPos = originalPos;
+    bool started = _mode == MODE_MANUAL;
+    if (started) {
+        _selfTest.cancel();
+        _autotune.cancel();
+        _calibration.start(axis, SERVO_CAL_POINTS, SERVO_MIN_ANGLE, SERVO_MAX_ANGLE);
+        // Start from where the current mapping puts the first angle
+        _calibration.setPulse(_servos[axis].pulseForDegrees(_calibration.targetAngle()));
     }
     xSemaphoreGive(_mutex);
-    
-    Serial.println("Self-test complete!");
-    Serial.println("================================");
+    return started;
 }
 
-void GimbalController::startTimedMove(float duration, GimbalPosition endPos) {
+bool GimbalController::jogServoCalibration(float pulseUs) {
     xSemaphoreTake(_mutex, portMAX_DELAY);
-    _moveActive = true;
-    _moveStartTime = millis();
-    _moveDuration = duration;
-    _moveStartPos = _currentPos;
-    _moveEndPos = endPos;
+    bool active = _calibration.active();
+    if (active) {
+        _calibration.setPulse(constrain(pulseUs, SERVO_PULSE_LIMIT_MIN_US, SERVO_PULSE_LIMIT_MAX_US));
+    }
     xSemaphoreGive(_mutex);
+    return active;
+}
+
+CalibrationCapture GimbalController::captureServoCalibrationPoint() {
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    GimbalAxis axis = _calibration.axis();
+    CalibrationCapture result = _calibration.capture();
+    ServoCalibration table = _calibration.table();
+
+    if (result == CAL_CAPTURE_NEXT) {
+        // Propose the next pulse from the current mapping, shifted by the
+        // error just measured, so the operator only has to fine-tune
+        int last = table.count - 1;
+        float error = table.pulseUs[last] - _servos[axis].pulseForDegrees(table.angle[last]);
+        _calibration.setPulse(_servos[axis].pulseForDegrees(_calibration.targetAngle()) + error);
+    }
+    xSemaphoreGive(_mutex);
+
+    if (result == CAL_CAPTURE_DONE) {
+        // Config update outside the gimbal mutex, as in setFlatReference()
+        AppConfig config = _configManager.getConfig();
+        config.servo_calibration[axis] = table;
+        int* offsets[AXIS_COUNT] = {&config.yaw_offset, &config.pitch_offset, &config.roll_offset};
+        *offsets[axis] = 0;
+        _configManager.updateConfig(config);
+        LOG_INFO(LOG_SERVO_CALIBRATION_STORED, axis, table.count);
+    }
+    return result;
+}
+
+void GimbalController::cancelServoCalibration() {
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    _calibration.cancel();
+    xSemaphoreGive(_mutex);
+}
+
+ServoCalibrationStatus GimbalController::getServoCalibrationStatus() {
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    ServoCalibrationStatus status;
+    status.active = _calibration.active();
+    status.axis = _calibration.axis();
+    status.points = _calibration.points();
+    status.targetAngle = _calibration.targetAngle();
+    status.pulseUs = _calibration.pulseUs();
+    status.captured = _calibration.table();
+    xSemaphoreGive(_mutex);
+    return status;
+}
+
+bool GimbalController::startAutotune(const bool axes[AXIS_COUNT]) {
+    RelayAutotuneSettings settings = {AUTOTUNE_RELAY_DEG, AUTOTUNE_HYSTERESIS_DEG, AUTOTUNE_MAX_ERROR_DEG,
+                                      AUTOTUNE_AXIS_TIMEOUT_S, AUTOTUNE_SETTLE_S, AUTOTUNE_DISCARD_CYCLES,
+                                      AUTOTUNE_MEASURE_CYCLES, AUTOTUNE_PERIOD_TOLERANCE};
+    bool any = false;
+    for (int i = 0; i < AXIS_COUNT; i++) any = any || axes[i];
+
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    bool started = any && _mode == MODE_AUTO && _attitude.valid;
+    if (started) {
+        _selfTest.cancel();
+        _autotune.start(settings, axes);
+    }
+    xSemaphoreGive(_mutex);
+    return started;
+}
+
+void GimbalController::cancelAutotune() {
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    _autotune.cancel();
+    xSemaphoreGive(_mutex);
+}
+
+AutotuneStatus GimbalController::getAutotuneStatus() {
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    AutotuneStatus status;
+    status.active = _autotune.active();
+    status.axis = _autotune.axis();
+    status.testing = _autotune.testing();
+    for (int i = 0; i < AXIS_COUNT; i++) {
+        status.axes[i] = _autotune.result((GimbalAxis)i);
+        status.current[i] = _params.gains[i];
+    }
+    xSemaphoreGive(_mutex);
+    return status;
+}
+
+int GimbalController::acceptAutotune(AutotuneRule rule) {
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    AxisAutotuneResult results[AXIS_COUNT];
+    for (int i = 0; i < AXIS_COUNT; i++) results[i] = _autotune.result((GimbalAxis)i);
+    xSemaphoreGive(_mutex);
+
+    // Config update outside the gimbal mutex, as in setFlatReference()
+    AppConfig config = _configManager.getConfig();
+    int accepted = 0;
+    for (int i = 0; i < AXIS_COUNT; i++) {
+        if (results[i].status != AUTOTUNE_DONE) continue;
+        config.gains[i] = tuneFromRelay(results[i].ku, results[i].tu, rule);
+        accepted++;
+    }
+    if (accepted > 0) {
+        _configManager.updateConfig(config);
+        LOG_INFO(LOG_AUTOTUNE_STORED, AUTOTUNE_RULE_NAMES[rule], accepted);
+    }
+    return accepted;
 }
@@ -1,8 +1,17 @@
 #pragma once
 #include <Arduino.h>
-#include <ESP32Servo.h>
-#include "PIDController.h"
+#include "AxisKernel.h"
+#include "AttitudeEstimator.h"
+#include "Autotune.h"
+#include "FlightRecorder.h"
+#include "LatestMailbox.h"
+#include "OutputFilter.h"
+#include "SelfTest.h"
+#include "SeqLock.h"
+#include "ServoCalibration.h"
+#include "Trajectory.h"
 #include "../Services/ConfigManager.h"
+#include "../Infrastructure/ServoOutput.h"
 
 struct GimbalPosition {
     float yaw;
@@ -10,51 +19,189 @@ struct GimbalPosition {
     float roll;
 };
 
+// Setpoint posted by the network/BLE tasks and applied by the control task.
+// seq orders it against timed moves started through the mutex path.
+struct SetpointCommand {
+    GimbalPosition value;  // Position in degrees, or phone gyro rates in rad/s
+    uint32_t seq;
+    uint32_t timeMs;
+};
+
+// Everything other tasks read about the gimbal, published by the control task
+// once per cycle through a SeqLock so readers never block it
+struct GimbalState {
+    GimbalPosition position;    // Filtered logical servo position (before trim)
+    GimbalPosition target;
+    GimbalPosition autoTarget;
+    AttitudeEstimate attitude;
+    int32_t mode;
+    bool moveActive;
+    float moveProgress;         // 0..1 while a timed move or trajectory runs
+    float moveDuration;         // s, including any slow-down for the trajectory limits
+    bool phoneGyroActive;
+    bool selfTestActive;
+    uint32_t timeMs;            // millis() at publication
+};
+
+struct CommandStats {
+    uint32_t posted;
+    uint32_t superseded; // Replaced by a newer command before the control task ran
+    uint32_t dropped;    // No free mailbox slot
+};
+
+struct ServoCalibrationStatus {
+    bool active;
+    GimbalAxis axis;
+    uint8_t points;       // Points the table will have
+    float targetAngle;    // Angle to jog the servo to for the next capture
+    float pulseUs;        // Raw pulse currently output on the axis
+    ServoCalibration captured;
+};
+
+struct SelfTestStatus {
+    bool active;
+    SelfTestPhase phase;
+    GimbalAxis axis;      // Axis the current phase acts on
+    float progress;       // 0..1
+    float duration;       // s the whole test takes
+    SelfTestResult result; // Last run, or the axes finished so far
+};
+
+// Terms of the last auto-mode PID step, kept for the flight recorder
+struct AxisPidTrace {
+    float p[AXIS_COUNT];
+    float i[AXIS_COUNT];
+    float d[AXIS_COUNT];
+    float feedForward[AXIS_COUNT];
+    uint8_t saturated; // Bit per axis: correction pinned at the servo range
+};
+
+struct AutotuneStatus {
+    bool active;
+    GimbalAxis axis;      // Axis being tested or settling before its test
+    bool testing;         // Relay running on that axis (false while it settles)
+    AxisAutotuneResult axes[AXIS_COUNT];
+    PidGains current[AXIS_COUNT]; // Configured gains, for comparison
+};
+
 class GimbalController {
 public:
     GimbalController(ConfigManager& configManager);
     void begin();
-    void update(float dt, float gyroYaw, float gyroPitch, float gyroRoll);
+    // record, when given, gets the attitude, setpoint, PID and servo fields
+    // of this cycle (see FlightRecorder)
+    void update(float dt, const AttitudeEstimate& attitude, FlightRecord* record = nullptr);
 
     void setMode(int mode);
-    int getMode();
+    int getMode() const;
 
+    // Setpoint inputs never block: they are posted to latest-wins mailboxes
+    // and applied at the start of the next control cycle
     void setManualPosition(float yaw, float pitch, float roll);
     void setAutoTarget(float yaw, float pitch, float roll);
     void setPhoneGyroRates(float gx, float gy, float gz);
     void clearPhoneGyro();
+    CommandStats getCommandStats() const;
 
-    GimbalPosition getCurrentPosition();
+    // Wait-free snapshot reads for any task
+    GimbalState getState() const { return _state.read(); }
+    GimbalPosition getCurrentPosition() const { return _state.read().position; }
+    AttitudeEstimate getAttitude() const { return _state.read().attitude; }
     void center();
     
     void setFlatReference(); // Set current position as new flat reference
-    void runSelfTest(); // Run self-test routine
 
-    void startTimedMove(float duration, GimbalPosition endPos);
+    // Self-test run by the control loop: a step on each axis with the camera
+    // response measured from the IMU, a sweep of the servo range, then back to
+    // the flat reference (or where it started). It returns at once with the
+    // test's length in s. Manual commands, a trajectory, calibration or a mode
+    // change cancel it.
+    float startSelfTest();
+    void cancelSelfTest(); // Holds wherever the test has got to
+    SelfTestStatus getSelfTestStatus();
+
+    // Timed moves and trajectories start from the current position, follow
+    // a precomputed Trajectory and bypass the output filters, so they take
+    // exactly the planned time. A manual setpoint cancels them.
+    void startTimedMove(float duration, GimbalPosition endPos); // ms, S-curve
+    bool startTrajectory(const TrajectoryKeyframe* keyframes, int count, TrajectoryShape shape,
+                         float* plannedDuration = nullptr); // False for invalid keyframes
+    void stopMove(); // Holds wherever the move has got to
+
+    // Guided servo calibration, manual mode only. While it runs the axis
+    // being calibrated outputs a raw pulse instead of its position: jog it
+    // until the servo physically sits at targetAngle, then capture. After the
+    // last point the table is stored in the config and that axis's offset is
+    // cleared, since the table already includes it.
+    bool startServoCalibration(GimbalAxis axis);
+    bool jogServoCalibration(float pulseUs);
+    CalibrationCapture captureServoCalibrationPoint();
+    void cancelServoCalibration();
+    ServoCalibrationStatus getServoCalibrationStatus();
+
+    // Relay-feedback autotune, auto mode with a valid attitude only. Runs one
+    // axis at a time from the control loop; the other axes keep stabilizing.
+    // Results are staged until accepted, which writes the gains from the
+    // chosen rule into the config for every axis that finished. Leaving auto
+    // mode, the self-test or calibration cancels it.
+    bool startAutotune(const bool axes[AXIS_COUNT]);
+    void cancelAutotune();
+    AutotuneStatus getAutotuneStatus();
+    int acceptAutotune(AutotuneRule rule); // Axes whose gains were written
+
+    // Defaults come from PID_* in config.h; the host benchmark swaps them
+    void setPidShaping(const PIDShaping& shaping);
+    PIDShaping getPidShaping() const { return _shaping; }
 
 private:
     ConfigManager& _configManager;
-    Servo _servoYaw, _servoPitch, _servoRoll;
-    PIDController _pidYaw, _pidPitch, _pidRoll;
+    ServoOutput _servos[AXIS_COUNT];
 
-    GimbalPosition _currentPos;
-    GimbalPosition _targetPos;
-    GimbalPosition _autoTarget;
-    GimbalPosition _phoneGyroRates;
+    // Per-axis loop state, indexed by GimbalAxis and run through AxisKernel
+    AxisState _axes;
+    AxisPidState _pid;
+    AxisFilterBank _filters;
+    float _loopDt; // s, averaged control period the filters are designed for; 0 until the first cycle
+    float _autoTarget[AXIS_COUNT];
+    float _scheduleError[AXIS_COUNT]; // |error| the gain schedule was last evaluated at
+    float _phoneGyroRates[AXIS_COUNT]; // rad/s
+    AttitudeEstimate _attitude;
     uint32_t _phoneGyroLastMs;
     bool _phoneGyroActive;
 
-    // Timed Move State
+    // Timed move / trajectory state
     bool _moveActive;
-    unsigned long _moveStartTime;
-    float _moveDuration;
-    GimbalPosition _moveStartPos;
-    GimbalPosition _moveEndPos;
+    Trajectory _trajectory;
+    int _moveCursor;
+    float _moveElapsed; // s, summed control dt
 
     SemaphoreHandle_t _mutex;
 
-    void updateServos(const AppConfig& config);
-    void updateAuto(float dt, float gyroYaw, float gyroPitch, float gyroRoll);
+    LatestMailbox<SetpointCommand> _manualMailbox;
+    LatestMailbox<SetpointCommand> _autoTargetMailbox;
+    LatestMailbox<SetpointCommand> _phoneGyroMailbox;
+    std::atomic<uint32_t> _commandSeq;
+    uint32_t _moveSeq; // Commands posted before the current timed move started do not cancel it
+
+    SeqLock<GimbalState> _state;
+    int _mode; // Mode used by the last control cycle
+
+    ControlParams _params; // Control task's copy, refreshed when the config version changes
+    PIDShaping _shaping;
+    ServoCalibrationSession _calibration;
+    SelfTestSequence _selfTest;
+    RelayAutotune _autotune;
+    AxisPidTrace _trace;
+    bool _traced; // _trace is from this cycle
+
+    uint32_t nextSeq() { return _commandSeq.fetch_add(1, std::memory_order_relaxed) + 1; }
+    void applyCommands(int mode);
+    void publishState();
+    void refreshParams();
+
+    void updateServos(float dt, bool direct);
+    void updateAuto(float dt);
     void updatePhoneGyro(float dt);
-    void updateTimedMove();
+    void updateTimedMove(float dt);
+    void traceCycle(FlightRecord& record) const;
 };
@@ -0,0 +1,317 @@
+#include "ImuCalibration.h"
+#include <math.h>
+#include <string.h>
+
+const char* const ACCEL_FACE_NAMES[ACCEL_FACE_COUNT] = {
+    "x_up", "x_down", "y_up", "y_down", "z_up", "z_down"};
+
+namespace {
+
+const float GRAVITY = 9.80665f;
+// Weight of a new window in a temperature bin stops falling here, so a bin
+// keeps following a bias that wanders at a fixed temperature
+const int BIN_AVERAGE_CAP = 200;
+// Share of the accel norm on the dominant axis for a face capture: cos 25 deg
+const float FACE_MIN_SHARE = 0.9f;
+
+float clampf(float v, float lo, float hi) {
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+// Solves the n x n system a x = b in place (Gaussian elimination with partial pivoting)
+bool solveLinear(double a[3][3], double b[3], int n) {
+    for (int col = 0; col < n; col++) {
+        int pivot = col;
+        for (int row = col + 1; row < n; row++) {
+            if (fabs(a[row][col]) > fabs(a[pivot][col])) pivot = row;
+        }
+        if (fabs(a[pivot][col]) < 1e-12) {
+            return false;
+        }
+        for (int k = 0; k < n; k++) {
+            double t = a[col][k];
+            a[col][k] = a[pivot][k];
+            a[pivot][k] = t;
+        }
+        double t = b[col];
+        b[col] = b[pivot];
+        b[pivot] = t;
+        for (int row = col + 1; row < n; row++) {
+            double f = a[row][col] / a[col][col];
+            for (int k = col; k < n; k++) a[row][k] -= f * a[col][k];
+            b[row] -= f * b[col];
+        }
+    }
+    for (int row = n - 1; row >= 0; row--) {
+        for (int k = row + 1; k < n; k++) b[row] -= a[row][k] * b[k];
+        b[row] /= a[row][row];
+    }
+    return true;
+}
+
+}
+
+ImuCalibration defaultImuCalibration() {
+    ImuCalibration cal;
+    memset(&cal, 0, sizeof(cal));
+    for (int i = 0; i < 3; i++) cal.accelScale[i] = 1.0f;
+    cal.tempRef = cal.tempMin = cal.tempMax = 25.0f;
+    return cal;
+}
+
+bool isValidImuCalibration(const ImuCalibration& cal) {
+    for (int i = 0; i < 3; i++) {
+        if (!isfinite(cal.accelOffset[i]) || !isfinite(cal.accelScale[i]) || !(cal.accelScale[i] > 0)) {
+            return false;
+        }
+        for (int k = 0; k < 3; k++) {
+            if (!isfinite(cal.gyroTemp[i][k])) return false;
+        }
+    }
+    return isfinite(cal.tempMin) && isfinite(cal.tempMax) &&
+           cal.tempMin <= cal.tempRef && cal.tempRef <= cal.tempMax;
+}
+
+void gyroTempBias(const ImuCalibration& cal, float tempC, float bias[3]) {
+    float d = clampf(tempC, cal.tempMin, cal.tempMax) - cal.tempRef;
+    for (int i = 0; i < 3; i++) {
+        const float* c = cal.gyroTemp[i];
+        bias[i] = c[0] + d * (c[1] + d * c[2]);
+    }
+}
+
+int fitGyroTempPolynomial(const ImuTempTable& table, int minWindows, float minSpan, ImuCalibration& cal) {
+    int used = 0;
+    float lo = 0, hi = 0, ref = 0;
+    for (int b = 0; b < ImuTempTable::BINS; b++) {
+        const ImuTempBin& bin = table.bin[b];
+        if (bin.windows < minWindows || bin.windows == 0) continue;
+        lo = used ? fminf(lo, bin.temp) : bin.temp;
+        hi = used ? fmaxf(hi, bin.temp) : bin.temp;
+        ref += bin.temp;
+        used++;
+    }
+    if (used < 2 || hi - lo < minSpan) {
+        return 0;
+    }
+    ref /= used; // Centred dT keeps the normal equations well conditioned
+    int terms = used >= 4 && hi - lo >= 2 * minSpan ? 3 : 2;
+
+    float coeff[3][3] = {};
+    for (int axis = 0; axis < 3; axis++) {
+        double a[3][3] = {}, rhs[3] = {};
+        for (int b = 0; b < ImuTempTable::BINS; b++) {
+            const ImuTempBin& bin = table.bin[b];
+            if (bin.windows < minWindows || bin.windows == 0) continue;
+            double d = bin.temp - ref;
+            double basis[3] = {1.0, d, d * d};
+            for (int r = 0; r < terms; r++) {
+                for (int c = 0; c < terms; c++) a[r][c] += basis[r] * basis[c];
+                rhs[r] += basis[r] * bin.bias[axis];
+            }
+        }
+        if (!solveLinear(a, rhs, terms)) {
+            return 0;
+        }
+        for (int k = 0; k < terms; k++) coeff[axis][k] = (float)rhs[k];
+    }
+
+    memcpy(cal.gyroTemp, coeff, sizeof(coeff));
+    cal.tempRef = ref;
+    cal.tempMin = lo;
+    cal.tempMax = hi;
+    return used;
+}
+
+ImuCorrector::ImuCorrector()
+    : _settings(),
+      _cal(defaultImuCalibration()),
+      _count(0),
+      _windowTime(0),
+      _elapsed(0),
+      _bootCount(0) {
+    memset(&_status, 0, sizeof(_status));
+    memset(_poly, 0, sizeof(_poly));
+    memset(_shift, 0, sizeof(_shift));
+    memset(_sum, 0, sizeof(_sum));
+    memset(_sumSq, 0, sizeof(_sumSq));
+    memset(_bootSum, 0, sizeof(_bootSum));
+    _status.temperature = _cal.tempRef;
+}
+
+void ImuCorrector::configure(const ImuRestSettings& settings, float tempMin, float binWidth) {
+    _settings = settings;
+    memset(&_status.table, 0, sizeof(_status.table));
+    _status.table.minTemp = tempMin;
+    _status.table.binWidth = binWidth;
+}
+
+void ImuCorrector::setCalibration(const ImuCalibration& cal) {
+    float before[3], after[3];
+    gyroTempBias(_cal, _status.temperature, before);
+    gyroTempBias(cal, _status.temperature, after);
+    for (int i = 0; i < 3; i++) {
+        _status.residual[i] += before[i] - after[i];
+        _bootSum[i] += _bootCount * (before[i] - after[i]);
+    }
+    _cal = cal;
+    memcpy(_poly, after, sizeof(_poly));
+    updateBias();
+}
+
+void ImuCorrector::beginCycle(float tempC) {
+    _status.temperature = tempC;
+    gyroTempBias(_cal, tempC, _poly);
+    updateBias();
+}
+
+void ImuCorrector::updateBias() {
+    for (int i = 0; i < 3; i++) _status.bias[i] = _poly[i] + _status.residual[i];
+}
+
+bool ImuCorrector::apply(ImuSample& s, float dt) {
+    const float raw[6] = {s.gyroX, s.gyroY, s.gyroZ, s.accelX, s.accelY, s.accelZ};
+    if (_count == 0) {
+        memcpy(_shift, raw, sizeof(_shift));
+    }
+    for (int i = 0; i < 6; i++) {
+        float d = raw[i] - _shift[i];
+        _sum[i] += d;
+        _sumSq[i] += d * d;
+    }
+    _count++;
+    _windowTime += dt;
+    _elapsed += dt;
+
+    s.gyroX = raw[0] - _status.bias[0];
+    s.gyroY = raw[1] - _status.bias[1];
+    s.gyroZ = raw[2] - _status.bias[2];
+    s.accelX = (raw[3] - _cal.accelOffset[0]) * _cal.accelScale[0];
+    s.accelY = (raw[4] - _cal.accelOffset[1]) * _cal.accelScale[1];
+    s.accelZ = (raw[5] - _cal.accelOffset[2]) * _cal.accelScale[2];
+
+    if (_windowTime < _settings.window) {
+        if (!_status.settled && _elapsed >= _settings.bootTimeout) _status.settled = true;
+        return false;
+    }
+    closeWindow();
+    return true;
+}
+
+void ImuCorrector::closeWindow() {
+    const ImuRestSettings& s = _settings;
+    float mean[6];
+    bool still = true;
+    for (int i = 0; i < 6; i++) {
+        float m = _sum[i] / _count;
+        float variance = fmaxf(_sumSq[i] / _count - m * m, 0.0f);
+        mean[i] = _shift[i] + m;
+        still = still && variance <= (i < 3 ? s.gyroStd * s.gyroStd : s.accelStd * s.accelStd);
+    }
+    float norm = sqrtf(mean[3] * mean[3] + mean[4] * mean[4] + mean[5] * mean[5]);
+    still = still && fabsf(norm - GRAVITY) <= s.gravityTol;
+
+    _status.windows++;
+    _status.atRest = still;
+    if (still) {
+        _status.restWindows++;
+        memcpy(_status.restAccel, mean + 3, sizeof(_status.restAccel));
+        recordBin(mean);
+
+        float measured[3];
+        for (int i = 0; i < 3; i++) measured[i] = mean[i] - _poly[i];
+        if (!_status.biasLocked) {
+            for (int i = 0; i < 3; i++) _bootSum[i] += measured[i];
+            if (++_bootCount >= s.bootWindows) {
+                for (int i = 0; i < 3; i++) _status.residual[i] = _bootSum[i] / _bootCount;
+                _status.biasLocked = true;
+                _status.settled = true;
+            }
+        } else {
+            bool plausible = true;
+            for (int i = 0; i < 3; i++) plausible = plausible && fabsf(measured[i] - _status.residual[i]) <= s.maxStep;
+            if (plausible) {
+                float alpha = fminf(s.window / s.trackTau, 1.0f);
+                for (int i = 0; i < 3; i++) _status.residual[i] += alpha * (measured[i] - _status.residual[i]);
+            }
+        }
+    } else if (!_status.biasLocked) {
+        // Moving at boot (a vehicle mount): stabilize now, capture at the next rest
+        _bootCount = 0;
+        memset(_bootSum, 0, sizeof(_bootSum));
+        _status.settled = true;
+    }
+    updateBias();
+
+    _count = 0;
+    _windowTime = 0;
+    memset(_sum, 0, sizeof(_sum));
+    memset(_sumSq, 0, sizeof(_sumSq));
+}
+
+void ImuCorrector::recordBin(const float gyro[3]) {
+    ImuTempTable& t = _status.table;
+    if (!(t.binWidth > 0)) {
+        return;
+    }
+    int b = (int)floorf((_status.temperature - t.minTemp) / t.binWidth);
+    if (b < 0 || b >= ImuTempTable::BINS) {
+        return;
+    }
+    ImuTempBin& bin = t.bin[b];
+    if (bin.windows < 0xFFFF) bin.windows++;
+    float w = 1.0f / (bin.windows < BIN_AVERAGE_CAP ? bin.windows : BIN_AVERAGE_CAP);
+    bin.temp += w * (_status.temperature - bin.temp);
+    for (int i = 0; i < 3; i++) bin.bias[i] += w * (gyro[i] - bin.bias[i]);
+}
+
+AccelCalibrationSession::AccelCalibrationSession()
+    : _active(false), _captured(0), _lastFace(-1) {
+    memset(_reading, 0, sizeof(_reading));
+}
+
+void AccelCalibrationSession::start() {
+    _active = true;
+    _captured = 0;
+    _lastFace = -1;
+}
+
+CalibrationCapture AccelCalibrationSession::capture(const float accel[3]) {
+    if (!_active) {
+        return CAL_CAPTURE_INACTIVE;
+    }
+    int axis = 0;
+    for (int i = 1; i < 3; i++) {
+        if (fabsf(accel[i]) > fabsf(accel[axis])) axis = i;
+    }
+    float norm = sqrtf(accel[0] * accel[0] + accel[1] * accel[1] + accel[2] * accel[2]);
+    if (!(norm > 0) || fabsf(accel[axis]) < FACE_MIN_SHARE * norm) {
+        return CAL_CAPTURE_REJECTED;
+    }
+
+    int face = 2 * axis + (accel[axis] < 0 ? 1 : 0);
+    memcpy(_reading[face], accel, sizeof(_reading[face]));
+    _captured |= 1 << face;
+    _lastFace = face;
+    if (_captured != (1 << ACCEL_FACE_COUNT) - 1) {
+        return CAL_CAPTURE_NEXT;
+    }
+    _active = false;
+    return CAL_CAPTURE_DONE;
+}
+
+bool AccelCalibrationSession::solve(ImuCalibration& cal) const {
+    if (_captured != (1 << ACCEL_FACE_COUNT) - 1) {
+        return false;
+    }
+    for (int axis = 0; axis < 3; axis++) {
+        float up = _reading[2 * axis][axis];
+        float down = _reading[2 * axis + 1][axis];
+        if (!(up > down)) {
+            return false;
+        }
+        cal.accelOffset[axis] = (up + down) * 0.5f;
+        cal.accelScale[axis] = 2.0f * GRAVITY / (up - down);
+    }
+    return true;
+}
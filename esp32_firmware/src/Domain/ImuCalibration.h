@@ -0,0 +1,161 @@
+#pragma once
+#include <stdint.h>
+#include "AttitudeEstimator.h"
+#include "ServoCalibration.h"
+
+// Pure C++ (no Arduino dependencies) so it can run and be benchmarked on the host.
+
+// Per-unit IMU correction, stored in config. The accelerometer is corrected
+// per axis as (raw - offset) * scale. The gyro bias follows the sensor
+// temperature as c0 + c1 dT + c2 dT^2 with dT = T - tempRef; T is held
+// within [tempMin, tempMax] so the polynomial never extrapolates past the
+// range it was fitted over. Whatever bias remains on top of it is tracked at
+// run time by ImuCorrector and not stored.
+struct ImuCalibration {
+    float accelOffset[3];  // m/s^2, body x/y/z
+    float accelScale[3];
+    float tempRef;         // deg C
+    float tempMin, tempMax;
+    float gyroTemp[3][3];  // [body axis][c0 rad/s, c1 rad/s/C, c2 rad/s/C^2]
+};
+
+// No correction: zero offsets, unit scales, a zero polynomial
+ImuCalibration defaultImuCalibration();
+
+// Finite values, positive scales and tempMin <= tempRef <= tempMax. Range
+// limits are up to the caller (ConfigManager).
+bool isValidImuCalibration(const ImuCalibration& cal);
+
+// Polynomial gyro bias at tempC, rad/s
+void gyroTempBias(const ImuCalibration& cal, float tempC, float bias[3]);
+
+struct ImuRestSettings {
+    float window;      // s of samples per still/moving decision
+    float gyroStd;     // rad/s; more spread than this on any axis is motion
+    float accelStd;    // m/s^2
+    float gravityTol;  // m/s^2 the mean accel norm may differ from 1 g
+    int bootWindows;   // Consecutive still windows averaged for the boot bias
+    float bootTimeout; // s; the estimate is held back at most this long for them
+    float trackTau;    // s, time constant of bias tracking after boot
+    float maxStep;     // rad/s; a still window further than this from the bias is not averaged in
+};
+
+// Mean raw gyro at rest per temperature band, for fitting the polynomial
+struct ImuTempBin {
+    uint16_t windows;  // Still windows averaged in; 0 = empty
+    float temp;        // deg C, mean
+    float bias[3];     // rad/s, mean raw gyro
+};
+
+struct ImuTempTable {
+    static const int BINS = 16;
+    float minTemp;     // deg C, lower edge of bin 0
+    float binWidth;    // deg C
+    ImuTempBin bin[BINS];
+};
+
+// Least-squares fit of the gyro temperature polynomial over the bins with at
+// least minWindows windows: quadratic from 4 bins spanning 2 * minSpan,
+// linear from 2 bins spanning minSpan. Only the gyro fields of cal change.
+// Returns the number of bins used, 0 if they do not cover enough range.
+int fitGyroTempPolynomial(const ImuTempTable& table, int minWindows, float minSpan, ImuCalibration& cal);
+
+// Published by the control loop after every window (see ControlTask)
+struct ImuCorrectorStatus {
+    bool atRest;          // The newest window was still
+    bool biasLocked;      // Boot bias captured
+    bool settled;         // Boot capture finished or given up
+    uint32_t windows;     // Windows evaluated since boot
+    uint32_t restWindows;
+    float temperature;    // deg C
+    float bias[3];        // rad/s removed from the gyro, polynomial + residual
+    float residual[3];    // rad/s, the part tracked at rest
+    float restAccel[3];   // m/s^2, mean raw accel of the newest still window
+    ImuTempTable table;
+};
+
+// Sensor-pipeline correction applied to every sample before the estimator.
+// apply() costs a subtract (gyro) or subtract and multiply (accel) per axis
+// plus the running sums of the rest detector; the temperature polynomial is
+// evaluated once per control cycle and the still/moving decision once per
+// window.
+//
+// Rest detection looks at the spread of each window, so it cannot tell a
+// slow, perfectly steady rotation from bias. The first still windows after
+// boot set the bias outright; later ones only nudge it (trackTau, maxStep).
+class ImuCorrector {
+public:
+    ImuCorrector();
+
+    void configure(const ImuRestSettings& settings, float tempMin, float binWidth);
+    // The run-time residual is adjusted so the total bias does not jump
+    void setCalibration(const ImuCalibration& cal);
+
+    void beginCycle(float tempC);
+    // Corrects the sample in place; true when it closed a window
+    bool apply(ImuSample& sample, float dt);
+
+    // False while the boot capture is running; hold stabilization off until
+    // then, since the loop's own motion would be taken for bias
+    bool settled() const { return _status.settled; }
+    const ImuCorrectorStatus& status() const { return _status; }
+
+private:
+    ImuRestSettings _settings;
+    ImuCalibration _cal;
+    ImuCorrectorStatus _status;
+    float _poly[3];    // Polynomial bias at the current temperature
+
+    // Current window, as offsets from its first sample so float sums keep precision
+    float _shift[6];
+    float _sum[6];
+    float _sumSq[6];
+    int _count;
+    float _windowTime;
+
+    float _elapsed;
+    int _bootCount;
+    float _bootSum[3];
+
+    void closeWindow();
+    void recordBin(const float gyro[3]);
+    void updateBias();
+};
+
+// "x_up", "x_down", "y_up", "y_down", "z_up", "z_down": the body axis that
+// points up, away from the ground
+enum AccelFace {
+    ACCEL_FACE_X_UP, ACCEL_FACE_X_DOWN,
+    ACCEL_FACE_Y_UP, ACCEL_FACE_Y_DOWN,
+    ACCEL_FACE_Z_UP, ACCEL_FACE_Z_DOWN,
+    ACCEL_FACE_COUNT
+};
+extern const char* const ACCEL_FACE_NAMES[ACCEL_FACE_COUNT];
+
+// Six-position accelerometer calibration: the unit is set down still on each
+// face in any order and a still window captured. The face is recognised from
+// the dominant axis; capturing a face again replaces it. From the up and down
+// readings of each axis: offset = (up + down) / 2, scale = 2 g / (up - down).
+// Cross-axis misalignment is not modelled.
+class AccelCalibrationSession {
+public:
+    AccelCalibrationSession();
+
+    void start();
+    void cancel() { _active = false; }
+    // accel: mean raw reading of a still window. REJECTED when no axis is
+    // within about 25 deg of vertical; DONE once all six faces are in.
+    CalibrationCapture capture(const float accel[3]);
+
+    bool active() const { return _active; }
+    uint8_t captured() const { return _captured; } // Bit per AccelFace
+    int lastFace() const { return _lastFace; }     // -1 before the first capture
+    // Fills the accel fields of cal; false unless all six faces are in
+    bool solve(ImuCalibration& cal) const;
+
+private:
+    bool _active;
+    uint8_t _captured;
+    int _lastFace;
+    float _reading[ACCEL_FACE_COUNT][3];
+};
@@ -0,0 +1,200 @@
+#include "KernelBenchmark.h"
+#include <math.h>
+#include "OutputFilter.h"
+#include "PIDController.h"
+#include "config.h"
+
+namespace {
+
+const int RUNS = 5;
+const int INPUT_SAMPLES = 256; // Synthetic attitude sequence, cycled
+
+struct BenchInput {
+    float attitude[AXIS_COUNT]; // deg, relative to level
+    float gyro[AXIS_COUNT];     // deg/s
+};
+
+BenchInput g_inputs[INPUT_SAMPLES];
+
+void makeInputs() {
+    // Base motion of a few degrees at 0.3-1 Hz plus sensor-sized noise
+    uint32_t seed = 12345;
+    for (int n = 0; n < INPUT_SAMPLES; n++) {
+        float t = n * 0.002f;
+        for (int i = 0; i < AXIS_COUNT; i++) {
+            seed = seed * 1664525u + 1013904223u;
+            float noise = ((seed >> 8) & 0xFFFF) / 65535.0f - 0.5f;
+            float w = 2.0f * (float)M_PI * (0.3f + 0.35f * i);
+            g_inputs[n].attitude[i] = 4.0f * sinf(w * t) + 0.2f * noise;
+            g_inputs[n].gyro[i] = 4.0f * w * cosf(w * t) + 2.0f * noise;
+        }
+    }
+}
+
+const int OFFSETS[AXIS_COUNT] = {2, -1, 0};
+
+// Default first-order output filter on every axis, shared by both loops
+void designBenchFilters(AxisFilterBank& filters, const float position[AXIS_COUNT], float dt) {
+    OutputFilterConfig filter[AXIS_COUNT];
+    for (int i = 0; i < AXIS_COUNT; i++) {
+        filter[i] = {OUTPUT_LOWPASS_FIRST_ORDER, SERVO_FILTER_LOWPASS_HZ, SERVO_FILTER_LOWPASS_Q, 0, 0, 0};
+    }
+    designAxisFilters(filters, filter, dt, position);
+}
+
+// The pre-AxisKernel GimbalController auto cycle, kept as the baseline. Its
+// output goes through the same filter bank as the kernel path, so the two
+// differ only in the PID and per-axis bookkeeping.
+struct ScalarLoop {
+    struct Position { float yaw, pitch, roll; };
+
+    PIDController pidYaw, pidPitch, pidRoll;
+    Position current, target, servoRate;
+    AxisState axes; // Filter bank view of current/target
+    AxisFilterBank filters;
+    float autoTarget;
+    int commands[AXIS_COUNT];
+
+    ScalarLoop(const PIDShaping& shaping, const PidGains gains[AXIS_COUNT], float dt)
+        : pidYaw(gains[AXIS_YAW].kp, gains[AXIS_YAW].ki, gains[AXIS_YAW].kd),
+          pidPitch(gains[AXIS_PITCH].kp, gains[AXIS_PITCH].ki, gains[AXIS_PITCH].kd),
+          pidRoll(gains[AXIS_ROLL].kp, gains[AXIS_ROLL].ki, gains[AXIS_ROLL].kd) {
+        PIDController* pids[] = {&pidYaw, &pidPitch, &pidRoll};
+        for (PIDController* pid : pids) {
+            pid->setDerivativeFilter(shaping.derivativeTau);
+            pid->setSetpointWeight(shaping.setpointWeight);
+            pid->setOutputRateLimit(shaping.outputRateLimit);
+        }
+        current = target = {SERVO_CENTER, SERVO_CENTER, SERVO_CENTER};
+        servoRate = {0, 0, 0};
+        autoTarget = SERVO_CENTER;
+        for (int i = 0; i < AXIS_COUNT; i++) {
+            axes.target[i] = axes.position[i] = SERVO_CENTER;
+            axes.servoRate[i] = 0;
+        }
+        designBenchFilters(filters, axes.position, dt);
+    }
+
+    float computeAxis(PIDController& pid, const PIDShaping& shaping, float measured, float position,
+                      float gyroRate, float rate, float lag, float dt) {
+        if (shaping.antiWindup) {
+            pid.setOutputLimits(SERVO_MIN_ANGLE - position, SERVO_MAX_ANGLE - position);
+        }
+        float feedForward = 0;
+        if (shaping.feedForwardGain > 0) {
+            feedForward = -shaping.feedForwardGain * (gyroRate - rate) * lag;
+        }
+        return pid.compute(autoTarget - SERVO_CENTER, measured - SERVO_CENTER, dt, feedForward);
+    }
+
+    void cycle(const PIDShaping& shaping, const BenchInput& in, float dt) {
+        target.yaw = current.yaw + computeAxis(pidYaw, shaping, SERVO_CENTER + in.attitude[AXIS_YAW], current.yaw,
+                                               in.gyro[AXIS_YAW], servoRate.yaw, filters.lag[AXIS_YAW], dt);
+        target.pitch = current.pitch + computeAxis(pidPitch, shaping, SERVO_CENTER + in.attitude[AXIS_PITCH],
+                                                   current.pitch, in.gyro[AXIS_PITCH], servoRate.pitch,
+                                                   filters.lag[AXIS_PITCH], dt);
+        target.roll = current.roll + computeAxis(pidRoll, shaping, SERVO_CENTER + in.attitude[AXIS_ROLL], current.roll,
+                                                 in.gyro[AXIS_ROLL], servoRate.roll, filters.lag[AXIS_ROLL], dt);
+
+        axes.target[AXIS_YAW] = target.yaw;
+        axes.target[AXIS_PITCH] = target.pitch;
+        axes.target[AXIS_ROLL] = target.roll;
+        filterAxes(axes, filters, false, 1.0f / dt, SERVO_MIN_ANGLE, SERVO_MAX_ANGLE);
+        current = {axes.position[AXIS_YAW], axes.position[AXIS_PITCH], axes.position[AXIS_ROLL]};
+        servoRate = {axes.servoRate[AXIS_YAW], axes.servoRate[AXIS_PITCH], axes.servoRate[AXIS_ROLL]};
+
+        commands[AXIS_YAW] = (int)constrain(current.yaw + OFFSETS[AXIS_YAW], SERVO_MIN_ANGLE, SERVO_MAX_ANGLE);
+        commands[AXIS_PITCH] = (int)constrain(current.pitch + OFFSETS[AXIS_PITCH], SERVO_MIN_ANGLE, SERVO_MAX_ANGLE);
+        commands[AXIS_ROLL] = (int)constrain(current.roll + OFFSETS[AXIS_ROLL], SERVO_MIN_ANGLE, SERVO_MAX_ANGLE);
+    }
+};
+
+// Same cycle as GimbalController::updateAuto + updateServos
+struct KernelLoop {
+    AxisState axes;
+    AxisPidState pid;
+    AxisFilterBank filters;
+    float autoTarget[AXIS_COUNT];
+    int commands[AXIS_COUNT];
+
+    KernelLoop(const PidGains gains[AXIS_COUNT], float dt) {
+        resetAxisPid(pid);
+        for (int i = 0; i < AXIS_COUNT; i++) {
+            axes.target[i] = axes.position[i] = SERVO_CENTER;
+            axes.servoRate[i] = 0;
+            autoTarget[i] = SERVO_CENTER;
+            setAxisGains(pid, (GimbalAxis)i, gains[i]);
+        }
+        designBenchFilters(filters, axes.position, dt);
+    }
+
+    void cycle(const PIDShaping& shaping, const BenchInput& bench, float dt) {
+        AxisPidInput in;
+        for (int i = 0; i < AXIS_COUNT; i++) {
+            in.measured[i] = bench.attitude[i];
+            in.setpoint[i] = autoTarget[i] - SERVO_CENTER;
+            in.outMin[i] = shaping.antiWindup ? SERVO_MIN_ANGLE - axes.position[i] : -INFINITY;
+            in.outMax[i] = shaping.antiWindup ? SERVO_MAX_ANGLE - axes.position[i] : INFINITY;
+            in.feedForward[i] = -shaping.feedForwardGain * filters.lag[i] * (bench.gyro[i] - axes.servoRate[i]);
+        }
+
+        const float invDt = 1.0f / dt;
+        float correction[AXIS_COUNT];
+        computeAxisPid(pid, shaping, in, dt, invDt, correction);
+        for (int i = 0; i < AXIS_COUNT; i++) {
+            axes.target[i] = axes.position[i] + correction[i];
+        }
+
+        filterAxes(axes, filters, false, invDt, SERVO_MIN_ANGLE, SERVO_MAX_ANGLE);
+        for (int i = 0; i < AXIS_COUNT; i++) {
+            commands[i] = (int)clampf(axes.position[i] + OFFSETS[i], SERVO_MIN_ANGLE, SERVO_MAX_ANGLE);
+        }
+    }
+};
+
+} // namespace
+
+KernelBenchmarkResult runKernelBenchmark(const PIDShaping& shaping, const PidGains gains[AXIS_COUNT],
+                                         float dt, uint32_t iterations, BenchmarkClock clock) {
+    makeInputs();
+
+    KernelBenchmarkResult result;
+    result.iterations = iterations;
+    result.maxDifference = 0;
+    uint32_t bestScalar = UINT32_MAX;
+    uint32_t bestKernel = UINT32_MAX;
+
+    // Best of several runs filters out interrupts and preemption
+    for (int run = 0; run < RUNS; run++) {
+        ScalarLoop scalar(shaping, gains, dt);
+        KernelLoop kernel(gains, dt);
+
+        uint32_t start = clock();
+        for (uint32_t n = 0; n < iterations; n++) {
+            scalar.cycle(shaping, g_inputs[n % INPUT_SAMPLES], dt);
+        }
+        uint32_t scalarTicks = clock() - start;
+
+        start = clock();
+        for (uint32_t n = 0; n < iterations; n++) {
+            kernel.cycle(shaping, g_inputs[n % INPUT_SAMPLES], dt);
+        }
+        uint32_t kernelTicks = clock() - start;
+
+        if (scalarTicks < bestScalar) bestScalar = scalarTicks;
+        if (kernelTicks < bestKernel) bestKernel = kernelTicks;
+
+        float diff[AXIS_COUNT] = {
+            scalar.target.yaw - kernel.axes.target[AXIS_YAW],
+            scalar.target.pitch - kernel.axes.target[AXIS_PITCH],
+            scalar.target.roll - kernel.axes.target[AXIS_ROLL],
+        };
+        for (int i = 0; i < AXIS_COUNT; i++) {
+            result.maxDifference = fmaxf(result.maxDifference, fabsf(diff[i]));
+        }
+    }
+
+    result.scalarTicks = iterations ? (float)bestScalar / iterations : 0;
+    result.kernelTicks = iterations ? (float)bestKernel / iterations : 0;
+    return result;
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <stdint.h>
+#include "AxisKernel.h"
+
+// Microbenchmark of one auto-mode control cycle (three PIDs, feed-forward,
+// output filter, trim and clamp; no servo I/O) through the AxisKernel path used
+// by GimbalController, against the previous scalar path of one
+// PIDController and hand-written yaw/pitch/roll code per axis. Both run on
+// the same synthetic attitude sequence.
+//
+// Runs on the host (sim: program --kernel-bench) and on the target in CPU
+// cycles: POST /api/perf/kernel starts it in a background task and
+// GET /api/perf/kernel polls for the result.
+
+// Monotonic tick source: CPU cycles on the target, nanoseconds on the host
+typedef uint32_t (*BenchmarkClock)();
+
+struct KernelBenchmarkResult {
+    uint32_t iterations;
+    float scalarTicks;   // Per control cycle, best of several runs
+    float kernelTicks;
+    float maxDifference; // deg, servo target mismatch between the paths after a run
+};
+
+KernelBenchmarkResult runKernelBenchmark(const PIDShaping& shaping, const PidGains gains[AXIS_COUNT],
+                                         float dt, uint32_t iterations, BenchmarkClock clock);
@@ -0,0 +1,102 @@
+#include "LatencyHistogram.h"
+
+LatencyHistogram::LatencyHistogram(uint32_t deadlineUs)
+    : _deadline(deadlineUs),
+      _resetRequested(false)
+{
+    clear();
+}
+
+void LatencyHistogram::clear() {
+    for (int i = 0; i < BUCKET_COUNT; i++) {
+        _buckets[i].store(0, std::memory_order_relaxed);
+    }
+    _count.store(0, std::memory_order_relaxed);
+    _min.store(UINT32_MAX, std::memory_order_relaxed);
+    _max.store(0, std::memory_order_relaxed);
+    _missed.store(0, std::memory_order_relaxed);
+}
+
+int LatencyHistogram::bucketFor(uint32_t us) {
+    if (us < LINEAR_BUCKETS) {
+        return (int)us;
+    }
+    int octave = 31 - __builtin_clz(us); // floor(log2(us)), >= 4 here
+    if (octave >= 4 + OCTAVES) {
+        return BUCKET_COUNT - 1;
+    }
+    int sub = (us >> (octave - 2)) & (SUB_BUCKETS - 1);
+    return LINEAR_BUCKETS + (octave - 4) * SUB_BUCKETS + sub;
+}
+
+uint32_t LatencyHistogram::bucketUpperBound(int bucket) {
+    if (bucket < LINEAR_BUCKETS) {
+        return (uint32_t)bucket;
+    }
+    int octave = 4 + (bucket - LINEAR_BUCKETS) / SUB_BUCKETS;
+    int sub = (bucket - LINEAR_BUCKETS) % SUB_BUCKETS;
+    return ((uint32_t)(SUB_BUCKETS + sub + 1) << (octave - 2)) - 1;
+}
+
+void LatencyHistogram::record(uint32_t us) {
+    if (_resetRequested.load(std::memory_order_acquire)) {
+        clear();
+        _resetRequested.store(false, std::memory_order_release);
+    }
+
+    // Single writer: plain load/store pairs are enough, no read-modify-write
+    int bucket = bucketFor(us);
+    _buckets[bucket].store(_buckets[bucket].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+    if (us < _min.load(std::memory_order_relaxed)) _min.store(us, std::memory_order_relaxed);
+    if (us > _max.load(std::memory_order_relaxed)) _max.store(us, std::memory_order_relaxed);
+
+    uint32_t deadline = _deadline.load(std::memory_order_relaxed);
+    if (deadline && us > deadline) {
+        _missed.store(_missed.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    // Count last so a reader never sees more samples than bucket entries
+    _count.store(_count.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void LatencyHistogram::requestReset() {
+    _resetRequested.store(true, std::memory_order_release);
+}
+
+LatencyStats LatencyHistogram::getStats() const {
+    LatencyStats stats = {};
+    stats.count = _count.load(std::memory_order_acquire);
+    stats.deadline = _deadline.load(std::memory_order_relaxed);
+    if (stats.count == 0) {
+        return stats;
+    }
+
+    stats.min = _min.load(std::memory_order_relaxed);
+    stats.max = _max.load(std::memory_order_relaxed);
+    stats.missedDeadlines = _missed.load(std::memory_order_relaxed);
+
+    // Quantiles report the upper edge of the bucket holding the ranked sample
+    uint32_t rank50 = (stats.count + 1) / 2;
+    uint32_t rank99 = stats.count - stats.count / 100;
+    uint32_t seen = 0;
+    bool have50 = false;
+    for (int i = 0; i < BUCKET_COUNT; i++) {
+        seen += _buckets[i].load(std::memory_order_relaxed);
+        if (!have50 && seen >= rank50) {
+            stats.p50 = bucketUpperBound(i);
+            have50 = true;
+        }
+        if (seen >= rank99) {
+            stats.p99 = bucketUpperBound(i);
+            break;
+        }
+    }
+
+    // Never report a quantile outside the observed range
+    if (stats.p50 > stats.max) stats.p50 = stats.max;
+    if (stats.p99 > stats.max) stats.p99 = stats.max;
+    if (stats.p50 < stats.min) stats.p50 = stats.min;
+    if (stats.p99 < stats.min) stats.p99 = stats.min;
+    return stats;
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <stdint.h>
+#include <atomic>
+
+// Pure C++ (no Arduino dependencies) so it can run and be benchmarked on the host.
+
+struct LatencyStats {
+    uint32_t count;
+    uint32_t min;  // Microseconds
+    uint32_t p50;
+    uint32_t p99;
+    uint32_t max;
+    uint32_t missedDeadlines;
+    uint32_t deadline;
+};
+
+// Fixed-bucket latency histogram in microseconds.
+// One task records, any other task may read: record() is wait-free and never
+// allocates, and readers only see relaxed per-bucket counters, so a snapshot
+// taken mid-update can be off by one sample but is never corrupt.
+// Values below 16 us get exact buckets; above that each power of two is split
+// into 4 buckets, so quantiles are within 25% up to about 1 s.
+class LatencyHistogram {
+public:
+    static const int LINEAR_BUCKETS = 16;
+    static const int SUB_BUCKETS = 4;
+    static const int OCTAVES = 16; // 2^4 .. 2^20 us
+    static const int BUCKET_COUNT = LINEAR_BUCKETS + OCTAVES * SUB_BUCKETS;
+
+    explicit LatencyHistogram(uint32_t deadlineUs = 0);
+
+    void setDeadline(uint32_t deadlineUs) { _deadline.store(deadlineUs, std::memory_order_relaxed); }
+
+    // Writer side
+    void record(uint32_t us);
+
+    // Reader side
+    LatencyStats getStats() const;
+    void requestReset(); // Applied by the writer on its next record()
+
+private:
+    std::atomic<uint32_t> _buckets[BUCKET_COUNT];
+    std::atomic<uint32_t> _count;
+    std::atomic<uint32_t> _min;
+    std::atomic<uint32_t> _max;
+    std::atomic<uint32_t> _missed;
+    std::atomic<uint32_t> _deadline;
+    std::atomic<bool> _resetRequested;
+
+    void clear();
+    static int bucketFor(uint32_t us);
+    static uint32_t bucketUpperBound(int bucket);
+};
@@ -0,0 +1,79 @@
+#pragma once
+#include <stdint.h>
+#include <atomic>
+
+// Pure C++ (no Arduino dependencies) so it can run and be benchmarked on the host.
+
+// Lock-free latest-wins mailbox: any number of producers post, one consumer
+// takes. Only the newest value is kept; a value replaced before the consumer
+// took it is counted as superseded and dropped.
+//
+// Each post writes into a free slot and then swaps it in as "latest" with a
+// single atomic exchange; whoever gets the previous slot back (the producer
+// that replaced it, or the consumer that took it) frees it. Neither side ever
+// waits for the other. N must cover the producers that can be writing at once
+// plus the published and the consumed slot; if every slot is busy the post is
+// dropped rather than blocking.
+template <typename T, int N = 4>
+class LatestMailbox {
+public:
+    LatestMailbox() : _latest(EMPTY), _posted(0), _superseded(0), _dropped(0) {
+        for (int i = 0; i < N; i++) {
+            _busy[i].store(false, std::memory_order_relaxed);
+        }
+    }
+
+    // Producer side; never blocks. Returns false if the value was dropped.
+    bool post(const T& value) {
+        int slot = claimSlot();
+        if (slot < 0) {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        _slots[slot] = value;
+        _posted.fetch_add(1, std::memory_order_relaxed);
+
+        int previous = _latest.exchange(slot, std::memory_order_acq_rel);
+        if (previous != EMPTY) {
+            // The consumer never saw it
+            _busy[previous].store(false, std::memory_order_release);
+            _superseded.fetch_add(1, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    // Consumer side; returns false if nothing new was posted since the last take.
+    bool take(T& out) {
+        int slot = _latest.exchange(EMPTY, std::memory_order_acq_rel);
+        if (slot == EMPTY) {
+            return false;
+        }
+        out = _slots[slot];
+        _busy[slot].store(false, std::memory_order_release);
+        return true;
+    }
+
+    uint32_t getPostedCount() const { return _posted.load(std::memory_order_relaxed); }
+    uint32_t getSupersededCount() const { return _superseded.load(std::memory_order_relaxed); }
+    uint32_t getDroppedCount() const { return _dropped.load(std::memory_order_relaxed); }
+
+private:
+    static const int EMPTY = -1;
+
+    T _slots[N];
+    std::atomic<bool> _busy[N];
+    std::atomic<int> _latest;
+    std::atomic<uint32_t> _posted;
+    std::atomic<uint32_t> _superseded;
+    std::atomic<uint32_t> _dropped;
+
+    int claimSlot() {
+        for (int i = 0; i < N; i++) {
+            bool expected = false;
+            if (_busy[i].compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                return i;
+            }
+        }
+        return -1;
+    }
+};
@@ -0,0 +1,128 @@
+#include "OutputFilter.h"
+#include <math.h>
+#include <string.h>
+
+const char* const OUTPUT_LOWPASS_NAMES[3] = {"off", "first_order", "biquad"};
+
+bool parseOutputLowpass(const char* name, OutputLowpass& type) {
+    for (int i = 0; name && i < 3; i++) {
+        if (strcmp(name, OUTPUT_LOWPASS_NAMES[i]) == 0) {
+            type = (OutputLowpass)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+namespace {
+
+// Highest cutoff as a fraction of the loop rate. The bilinear designs are
+// exact at the cutoff but squeeze everything above it towards Nyquist.
+const float MAX_CUTOFF_RATIO = 0.45f;
+
+// Normalized (a0 = 1): y = b0 x + b1 x[-1] + b2 x[-2] - a1 y[-1] - a2 y[-2]
+struct Coefficients {
+    float b0, b1, b2, a1, a2;
+};
+
+const Coefficients PASS_THROUGH = {1, 0, 0, 0, 0};
+
+void setStage(AxisFilterBank::Biquad& stage, int axis, const Coefficients& c) {
+    stage.b0[axis] = c.b0;
+    stage.b1[axis] = c.b1;
+    stage.b2[axis] = c.b2;
+    stage.a1[axis] = c.a1;
+    stage.a2[axis] = c.a2;
+}
+
+// State of a stage that has been sitting at x. Assumes unit DC gain, which
+// the low-pass, the notch and the pass-through all have.
+void restStage(AxisFilterBank::Biquad& stage, int axis, float x) {
+    stage.s1[axis] = x * (1.0f - stage.b0[axis]);
+    stage.s2[axis] = x * (stage.b2[axis] - stage.a2[axis]);
+}
+
+inline float runStage(AxisFilterBank::Biquad& stage, int i, float x) {
+    float y = stage.b0[i] * x + stage.s1[i];
+    stage.s1[i] = stage.b1[i] * x - stage.a1[i] * y + stage.s2[i];
+    stage.s2[i] = stage.b2[i] * x - stage.a2[i] * y;
+    return y;
+}
+
+}
+
+void designAxisFilters(AxisFilterBank& bank, const OutputFilterConfig config[AXIS_COUNT], float dt,
+                       const float position[AXIS_COUNT]) {
+    const float maxHz = MAX_CUTOFF_RATIO / dt;
+    const float twoPi = 2.0f * (float)M_PI;
+    bank.designDt = dt;
+
+    for (int axis = 0; axis < AXIS_COUNT; axis++) {
+        const OutputFilterConfig& c = config[axis];
+        float lag = 0;
+
+        Coefficients lowpass = PASS_THROUGH;
+        float fc = fminf(c.lowpassHz, maxHz);
+        if (c.lowpass == OUTPUT_LOWPASS_FIRST_ORDER && fc > 0) {
+            // Exact discretization of tau = 1 / (2 pi fc): y += (x - y) * alpha
+            float tau = 1.0f / (twoPi * fc);
+            float alpha = 1.0f - expf(-dt / tau);
+            lowpass = {alpha, 0, 0, alpha - 1.0f, 0};
+            lag += tau;
+        } else if (c.lowpass == OUTPUT_LOWPASS_BIQUAD && fc > 0 && c.lowpassQ > 0) {
+            // RBJ cookbook low-pass
+            float w0 = twoPi * fc * dt;
+            float cosW = cosf(w0);
+            float alpha = sinf(w0) / (2.0f * c.lowpassQ);
+            float a0 = 1.0f + alpha;
+            float b = (1.0f - cosW) / a0;
+            lowpass = {b * 0.5f, b, b * 0.5f, -2.0f * cosW / a0, (1.0f - alpha) / a0};
+            lag += 1.0f / (twoPi * fc * c.lowpassQ); // Ramp lag of a second-order low-pass, 1 / (Q w0)
+        }
+
+        // A notch at or above the cutoff limit would act on nothing the loop can represent
+        Coefficients notch = PASS_THROUGH;
+        if (c.notchHz > 0 && c.notchHz <= maxHz && c.notchQ > 0) {
+            float w0 = twoPi * c.notchHz * dt;
+            float cosW = cosf(w0);
+            float alpha = sinf(w0) / (2.0f * c.notchQ);
+            float a0 = 1.0f + alpha;
+            notch = {1.0f / a0, -2.0f * cosW / a0, 1.0f / a0, -2.0f * cosW / a0, (1.0f - alpha) / a0};
+            lag += 1.0f / (twoPi * c.notchHz * c.notchQ);
+        }
+
+        setStage(bank.lowpass, axis, lowpass);
+        setStage(bank.notch, axis, notch);
+        restStage(bank.lowpass, axis, position[axis]);
+        restStage(bank.notch, axis, position[axis]);
+        bank.maxStep[axis] = c.slewRate > 0 ? c.slewRate * dt : INFINITY;
+        // With every stage off a correction still shows up one cycle later
+        bank.lag[axis] = fmaxf(lag, dt);
+    }
+}
+
+void filterAxes(AxisState& axes, AxisFilterBank& bank, bool bypass, float invDt, float minAngle, float maxAngle) {
+    if (bypass) {
+        for (int i = 0; i < AXIS_COUNT; i++) {
+            float previous = axes.position[i];
+            float position = clampf(axes.target[i], minAngle, maxAngle);
+            restStage(bank.lowpass, i, position);
+            restStage(bank.notch, i, position);
+            axes.position[i] = position;
+            axes.servoRate[i] = (position - previous) * invDt;
+        }
+        return;
+    }
+
+    for (int i = 0; i < AXIS_COUNT; i++) {
+        float previous = axes.position[i];
+        // Clamping the input keeps the filter state inside the servo range,
+        // so it does not wind up while a target is out of reach
+        float x = clampf(axes.target[i], minAngle, maxAngle);
+        float y = runStage(bank.notch, i, runStage(bank.lowpass, i, x));
+        float position = clampf(y, previous - bank.maxStep[i], previous + bank.maxStep[i]);
+        position = clampf(position, minAngle, maxAngle);
+        axes.position[i] = position;
+        axes.servoRate[i] = (position - previous) * invDt;
+    }
+}
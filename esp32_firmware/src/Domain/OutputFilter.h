@@ -0,0 +1,54 @@
+#pragma once
+#include <stdint.h>
+#include "AxisKernel.h"
+
+// Pure C++ (no Arduino dependencies) so it can run and be benchmarked on the host.
+
+enum OutputLowpass {
+    OUTPUT_LOWPASS_OFF = 0,
+    OUTPUT_LOWPASS_FIRST_ORDER = 1, // Exponential smoothing
+    OUTPUT_LOWPASS_BIQUAD = 2       // Second order, Q sets the damping
+};
+
+// "off", "first_order", "biquad": the names used in config.json and the API
+extern const char* const OUTPUT_LOWPASS_NAMES[3];
+bool parseOutputLowpass(const char* name, OutputLowpass& type); // False for an unknown or null name
+
+// Output filter of one servo axis: low-pass, then notch, then slew-rate
+// limit. Everything is in Hz and deg/s, so the response is the same at any
+// loop rate.
+struct OutputFilterConfig {
+    uint8_t lowpass;  // OutputLowpass
+    float lowpassHz;  // -3 dB cutoff
+    float lowpassQ;   // Biquad only; 0.707 = Butterworth, no overshoot to a step
+    float notchHz;    // 0 = no notch
+    float notchQ;     // notchHz / notchQ is the width of the notch
+    float slewRate;   // deg/s, 0 = unlimited
+};
+
+// Both biquad stages of every axis in transposed direct form II, plus the
+// slew limit. Coefficients are designed once per config change or loop rate
+// change; a stage that is off is a unit pass-through (b0 = 1), so the kernel
+// has no per-stage branches.
+struct AxisFilterBank {
+    struct Biquad {
+        float b0[AXIS_COUNT], b1[AXIS_COUNT], b2[AXIS_COUNT], a1[AXIS_COUNT], a2[AXIS_COUNT];
+        float s1[AXIS_COUNT], s2[AXIS_COUNT];
+    };
+    Biquad lowpass;
+    Biquad notch;
+    float maxStep[AXIS_COUNT]; // deg per cycle, INFINITY = unlimited
+    float lag[AXIS_COUNT];     // s, how far the output trails a ramp at the input
+    float designDt;            // s, loop period the coefficients are for; 0 = not designed
+};
+
+// Designs every axis for loop period dt and restarts the filters at rest on
+// position, so the output does not jump. Cutoffs are held below 0.45 / dt.
+void designAxisFilters(AxisFilterBank& bank, const OutputFilterConfig config[AXIS_COUNT], float dt,
+                       const float position[AXIS_COUNT]);
+
+// Runs target through the filters into position, clamps it to
+// [minAngle, maxAngle] and updates servoRate. With bypass the target is
+// written straight through and the filters follow it at rest, for moves that
+// are already smooth.
+void filterAxes(AxisState& axes, AxisFilterBank& bank, bool bypass, float invDt, float minAngle, float maxAngle);
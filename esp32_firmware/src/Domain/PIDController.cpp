@@ -1,28 +1,93 @@
 #include "PIDController.h"
 
-PIDController::PIDController(float kp, float ki, float kd) : _kp(kp), _ki(ki), _kd(kd), _integral(0), _prevError(0) {}
+PIDController::PIDController(float kp, float ki, float kd)
+    : _kp(kp), _ki(ki), _kd(kd),
+      _outMin(-INFINITY), _outMax(INFINITY),
+      _derivativeTau(0),
+      _setpointWeight(1.0f),
+      _maxRate(0),
+      _iTerm(0), _pError(0), _prevInput(0), _derivative(0), _prevOutput(0),
+      _primed(false) {}
 
-float PIDController::compute(float setpoint, float input, float dt) {
+float PIDController::compute(float setpoint, float input, float dt, float feedForward) {
     if (dt <= 0) return 0;
 
+    if (!_primed) {
+        // No derivative history yet: start from rest instead of kicking
+        _prevInput = input;
+        _derivative = 0;
+        _prevOutput = 0;
+        _primed = true;
+    }
+
     float error = setpoint - input;
-    _integral += error * dt;
 
-    // Anti-windup clamping could be added here
+    // Derivative on measurement, low-passed
+    float rawDerivative = (input - _prevInput) / dt;
+    _prevInput = input;
+    if (_derivativeTau > 0) {
+        _derivative += (rawDerivative - _derivative) * (dt / (_derivativeTau + dt));
+    } else {
+        _derivative = rawDerivative;
+    }
+
+    _pError = _setpointWeight * setpoint - input;
+    float proportional = _kp * _pError;
+    float base = proportional - _kd * _derivative + feedForward;
+
+    // Conditional integration: skip the update when it would only wind the
+    // integral further into a saturated output
+    float candidate = _iTerm + _ki * error * dt;
+    float unclamped = base + candidate;
+    bool windingUp = (unclamped > _outMax && error > 0) || (unclamped < _outMin && error < 0);
+    if (!windingUp) {
+        _iTerm = candidate;
+    }
 
-    float derivative = (error - _prevError) / dt;
-    _prevError = error;
+    float output = constrain(base + _iTerm, _outMin, _outMax);
 
-    return (_kp * error) + (_ki * _integral) + (_kd * derivative);
+    if (_maxRate > 0) {
+        float maxStep = _maxRate * dt;
+        output = constrain(output, _prevOutput - maxStep, _prevOutput + maxStep);
+        output = constrain(output, _outMin, _outMax);
+    }
+    _prevOutput = output;
+    return output;
 }
 
-void PIDController::setTunings(float kp, float ki, float kd) {
+void PIDController::setTunings(float kp, float ki, float kd, bool bumpless) {
+    // Bumpless: the integral takes over the P-term change
+    if (bumpless && _primed) {
+        _iTerm += (_kp - kp) * _pError;
+    }
     _kp = kp;
     _ki = ki;
     _kd = kd;
 }
 
+void PIDController::setOutputLimits(float min, float max) {
+    if (min > max) return;
+    _outMin = min;
+    _outMax = max;
+}
+
+void PIDController::setDerivativeFilter(float tau) {
+    _derivativeTau = tau > 0 ? tau : 0;
+}
+
+void PIDController::setSetpointWeight(float weight) {
+    _setpointWeight = constrain(weight, 0.0f, 1.0f);
+}
+
+void PIDController::setOutputRateLimit(float maxRate) {
+    _maxRate = maxRate > 0 ? maxRate : 0;
+}
+
 void PIDController::reset() {
-    _integral = 0;
-    _prevError = 0;
+    _iTerm = 0;
+    _pError = 0;
+    _prevInput = 0;
+    _derivative = 0;
+    _prevOutput = 0;
+    _primed = false;
 }
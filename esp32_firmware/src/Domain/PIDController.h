@@ -1,15 +1,45 @@
 #pragma once
 #include <Arduino.h>
 
+// PID with the usual production refinements, all optional:
+// - output limits with conditional-integration anti-windup (the integral is
+//   frozen while the output is saturated and the error would push it further)
+// - derivative on measurement through a first-order low-pass, so setpoint
+//   steps do not kick and sensor noise is not differentiated raw
+// - setpoint weighting on the proportional term
+// - a feed-forward term added ahead of the limits
+// - output rate limiting
+// With the defaults (no limits, no filter, weight 1, no rate limit) it
+// behaves like a textbook PID with derivative on measurement.
+// The integral is kept as its contribution to the output, so changing ki
+// (including every cycle under gain scheduling) does not step the output.
+// setTunings(..., bumpless) also folds the P-term change of a kp change into
+// it; leave that off for gains scheduled on the error every cycle, where the
+// folded sum would turn into overshoot. kd changes are not compensated: the
+// derivative is too noisy to fold into the integral, and with the loop at
+// rest the D term is near zero.
 class PIDController {
 public:
     PIDController(float kp, float ki, float kd);
-    float compute(float setpoint, float input, float dt);
-    void setTunings(float kp, float ki, float kd);
+    float compute(float setpoint, float input, float dt, float feedForward = 0.0f);
+    void setTunings(float kp, float ki, float kd, bool bumpless = false);
+    void setOutputLimits(float min, float max);
+    void setDerivativeFilter(float tau);    // Seconds; 0 disables the filter
+    void setSetpointWeight(float weight);   // 0..1, proportional term acts on weight * setpoint - input
+    void setOutputRateLimit(float maxRate); // Output units per second; 0 disables
     void reset();
 
 private:
     float _kp, _ki, _kd;
-    float _integral;
-    float _prevError;
+    float _outMin, _outMax;
+    float _derivativeTau;
+    float _setpointWeight;
+    float _maxRate;
+
+    float _iTerm;      // ki * integral of error, in output units
+    float _pError;     // weight * setpoint - input of the last compute()
+    float _prevInput;
+    float _derivative; // Filtered d(input)/dt
+    float _prevOutput;
+    bool _primed;      // False until the first sample after a reset
 };
@@ -0,0 +1,212 @@
+#include "SelfTest.h"
+#include <math.h>
+#include <string.h>
+
+const char* const SELF_TEST_PHASE_NAMES[SELF_TEST_DONE + 1] = {
+    "idle", "settle", "step", "range_min", "range_max", "return", "done"};
+
+namespace {
+
+// The baseline and the final value are averages over the end of their
+// phase, so servo jitter and IMU noise do not set the gain. A second window
+// DRIFT_SPAN earlier in the settle gives the drift of the estimate (gyro-only
+// yaw), which is taken out of the step.
+const float AVERAGE_WINDOW = 0.2f; // s
+const float DRIFT_SPAN = 0.4f;     // s between the two settle windows
+// A smaller change than this is treated as no response at all
+const float MIN_RESPONSE = 0.2f;   // Fraction of the step
+
+}
+
+SelfTestSequence::SelfTestSequence()
+    : _active(false),
+      _phase(SELF_TEST_IDLE),
+      _axis(AXIS_YAW),
+      _phaseTime(0),
+      _settings(),
+      _baselineSum(0),
+      _baselineCount(0),
+      _earlySum(0),
+      _earlyCount(0),
+      _valid(false),
+      _sampleCount(0) {
+    memset(_home, 0, sizeof(_home));
+    memset(&_result, 0, sizeof(_result));
+}
+
+void SelfTestSequence::start(const SelfTestSettings& settings, const float home[AXIS_COUNT]) {
+    _settings = settings;
+    memcpy(_home, home, sizeof(_home));
+    memset(&_result, 0, sizeof(_result));
+    _active = true;
+    enter(SELF_TEST_SETTLE, AXIS_YAW);
+}
+
+void SelfTestSequence::enter(SelfTestPhase phase, GimbalAxis axis) {
+    _phase = phase;
+    _axis = axis;
+    _phaseTime = 0;
+    _baselineSum = 0;
+    _baselineCount = 0;
+    _earlySum = 0;
+    _earlyCount = 0;
+    _sampleCount = 0;
+    if (phase == SELF_TEST_SETTLE) {
+        _valid = true;
+    }
+}
+
+float SelfTestSequence::totalTime() const {
+    return AXIS_COUNT * (_settings.settleTime + _settings.stepTime + 2 * _settings.rangeHoldTime) +
+           _settings.rangeHoldTime;
+}
+
+float SelfTestSequence::progress() const {
+    if (_phase == SELF_TEST_DONE) {
+        return 1.0f;
+    }
+    float total = totalTime();
+    return total > 0 ? fminf(_result.duration / total, 1.0f) : 0.0f;
+}
+
+void SelfTestSequence::update(float dt, const float measured[AXIS_COUNT], bool measuredValid,
+                              float target[AXIS_COUNT]) {
+    if (!_active) {
+        return;
+    }
+    _phaseTime += dt;
+    _result.duration += dt;
+
+    const SelfTestSettings& s = _settings;
+    for (int i = 0; i < AXIS_COUNT; i++) {
+        target[i] = s.center;
+    }
+
+    switch (_phase) {
+        case SELF_TEST_SETTLE: {
+            float toStep = s.settleTime - _phaseTime;
+            if (toStep <= AVERAGE_WINDOW) {
+                _valid = _valid && measuredValid;
+                _baselineSum += measured[_axis];
+                _baselineCount++;
+            } else if (toStep <= AVERAGE_WINDOW + DRIFT_SPAN && toStep > DRIFT_SPAN) {
+                _earlySum += measured[_axis];
+                _earlyCount++;
+            }
+            if (_phaseTime >= s.settleTime) {
+                _phase = SELF_TEST_STEP; // Not enter(): the baseline carries over
+                _phaseTime = 0;
+                _sampleCount = 0;
+                target[_axis] = s.center + s.stepDeg;
+            }
+            break;
+        }
+
+        case SELF_TEST_STEP: {
+            target[_axis] = s.center + s.stepDeg;
+            _valid = _valid && measuredValid;
+            // Evenly spaced samples, so a faster loop does not cut the window short
+            float interval = s.stepTime / MAX_SAMPLES;
+            if (_sampleCount < MAX_SAMPLES && _phaseTime >= _sampleCount * interval) {
+                _sampleTime[_sampleCount] = _phaseTime;
+                _sampleValue[_sampleCount] = measured[_axis];
+                _sampleCount++;
+            }
+            if (_phaseTime >= s.stepTime) {
+                analyzeStep();
+                if (_axis + 1 < AXIS_COUNT) {
+                    enter(SELF_TEST_SETTLE, (GimbalAxis)(_axis + 1));
+                } else {
+                    enter(SELF_TEST_RANGE_MIN, AXIS_YAW);
+                    target[_axis] = s.minAngle;
+                }
+            }
+            break;
+        }
+
+        // The sweep runs after every step, since driving an axis to the end of
+        // its range can leave the attitude estimate recovering for a while
+        case SELF_TEST_RANGE_MIN:
+            target[_axis] = s.minAngle;
+            if (_phaseTime >= s.rangeHoldTime) {
+                enter(SELF_TEST_RANGE_MAX, _axis);
+                target[_axis] = s.maxAngle;
+            }
+            break;
+
+        case SELF_TEST_RANGE_MAX:
+            target[_axis] = s.maxAngle;
+            if (_phaseTime >= s.rangeHoldTime) {
+                if (_axis + 1 < AXIS_COUNT) {
+                    enter(SELF_TEST_RANGE_MIN, (GimbalAxis)(_axis + 1));
+                    target[_axis] = s.minAngle;
+                } else {
+                    enter(SELF_TEST_RETURN, AXIS_YAW);
+                    memcpy(target, _home, sizeof(_home));
+                }
+            }
+            break;
+
+        case SELF_TEST_RETURN:
+            memcpy(target, _home, sizeof(_home));
+            if (_phaseTime >= s.rangeHoldTime) {
+                enter(SELF_TEST_DONE, AXIS_YAW);
+                _result.complete = true;
+                _active = false;
+            }
+            break;
+
+        default:
+            _active = false;
+            break;
+    }
+}
+
+void SelfTestSequence::analyzeStep() {
+    AxisStepResult& r = _result.axes[_axis];
+    memset(&r, 0, sizeof(r));
+    r.tested = true;
+    r.measured = _valid && _baselineCount > 0 && _sampleCount > 0;
+    if (!r.measured) {
+        return;
+    }
+
+    // Baseline as of the step, and the drift to remove from every sample
+    float baseline = (float)(_baselineSum / _baselineCount);
+    float drift = _earlyCount > 0 ? (baseline - (float)(_earlySum / _earlyCount)) / DRIFT_SPAN : 0.0f;
+    baseline += drift * AVERAGE_WINDOW * 0.5f;
+    for (int i = 0; i < _sampleCount; i++) {
+        _sampleValue[i] -= drift * _sampleTime[i];
+    }
+
+    double finalSum = 0;
+    int finalCount = 0;
+    float windowStart = _sampleTime[_sampleCount - 1] - AVERAGE_WINDOW;
+    for (int i = 0; i < _sampleCount; i++) {
+        if (_sampleTime[i] >= windowStart) {
+            finalSum += _sampleValue[i];
+            finalCount++;
+        }
+    }
+    float change = (float)(finalSum / finalCount) - baseline;
+    r.gain = fabsf(change) / _settings.stepDeg;
+    r.responded = r.gain >= MIN_RESPONSE;
+    if (!r.responded) {
+        return;
+    }
+
+    // Progress towards the final value, whichever way the camera turned
+    float rise10 = -1, rise90 = -1, peak = 0, settled = 0;
+    for (int i = 0; i < _sampleCount; i++) {
+        float p = (_sampleValue[i] - baseline) / change;
+        if (rise10 < 0 && p >= 0.1f) rise10 = _sampleTime[i];
+        if (rise90 < 0 && p >= 0.9f) rise90 = _sampleTime[i];
+        peak = fmaxf(peak, p);
+        if (fabsf(p - 1.0f) > _settings.settleBand) {
+            settled = i + 1 < _sampleCount ? _sampleTime[i + 1] : _sampleTime[i];
+        }
+    }
+    r.riseTime = rise10 >= 0 && rise90 >= 0 ? rise90 - rise10 : _settings.stepTime;
+    r.settlingTime = settled;
+    r.overshootPct = fmaxf(peak - 1.0f, 0.0f) * 100.0f;
+}
@@ -0,0 +1,94 @@
+#pragma once
+#include <stdint.h>
+#include "GainSchedule.h"
+
+// Pure C++ (no Arduino dependencies) so it can run and be benchmarked on the host.
+
+enum SelfTestPhase {
+    SELF_TEST_IDLE,
+    SELF_TEST_SETTLE,    // Every axis at center; the baseline is measured at the end
+    SELF_TEST_STEP,      // Step on one axis while its response is recorded
+    SELF_TEST_RANGE_MIN, // Range sweep, one axis at a time, after all the steps
+    SELF_TEST_RANGE_MAX,
+    SELF_TEST_RETURN,    // Back to the home position
+    SELF_TEST_DONE
+};
+
+// "idle", "settle", "step", "range_min", "range_max", "return", "done"
+extern const char* const SELF_TEST_PHASE_NAMES[SELF_TEST_DONE + 1];
+
+struct SelfTestSettings {
+    float center;        // deg, where each step starts
+    float stepDeg;       // Size of each axis's step
+    float minAngle;      // Range sweep ends
+    float maxAngle;
+    float settleTime;    // s before each step, at least 0.6 to measure drift
+    float stepTime;      // s recorded after each step
+    float rangeHoldTime; // s at each end of the range, and for the return
+    float settleBand;    // Fraction of the step that counts as settled
+};
+
+// Step response of one axis, measured on the camera attitude
+struct AxisStepResult {
+    bool tested;        // The step ran to the end
+    bool measured;      // The attitude estimate was valid throughout
+    bool responded;     // The camera moved at least a fifth of the step
+    float riseTime;     // s, 10% -> 90% of the final change
+    float settlingTime; // s from the step until it stays within the band
+    float overshootPct;
+    float gain;         // |final change| / step; about 1 when the camera follows the servo rigidly
+};
+
+struct SelfTestResult {
+    bool complete;      // Every phase ran; false while running or after a cancel
+    float duration;     // s of control time
+    AxisStepResult axes[AXIS_COUNT];
+};
+
+// Self-test advanced by the control loop: a step on each axis in turn, then
+// the old range sweep, then back home. Nothing blocks; every call moves the
+// sequence on by the control dt and writes the servo targets for the cycle.
+class SelfTestSequence {
+public:
+    static const int MAX_SAMPLES = 256; // Per step, spread evenly over stepTime
+
+    SelfTestSequence();
+
+    void start(const SelfTestSettings& settings, const float home[AXIS_COUNT]);
+    void cancel() { _active = false; }
+
+    // measured: camera attitude in degrees indexed by GimbalAxis (yaw may
+    // drift slowly; only changes over a step are used)
+    void update(float dt, const float measured[AXIS_COUNT], bool measuredValid, float target[AXIS_COUNT]);
+
+    bool active() const { return _active; }
+    SelfTestPhase phase() const { return _phase; }
+    GimbalAxis axis() const { return _axis; }
+    float progress() const; // 0..1
+    float totalTime() const; // s from start to done
+    const SelfTestResult& result() const { return _result; }
+
+private:
+    bool _active;
+    SelfTestPhase _phase;
+    GimbalAxis _axis;
+    float _phaseTime;
+    SelfTestSettings _settings;
+    float _home[AXIS_COUNT];
+    SelfTestResult _result;
+
+    // Baseline before the current step, an earlier average for the drift of
+    // the estimate, and whether the estimate stayed valid
+    double _baselineSum;
+    int _baselineCount;
+    double _earlySum;
+    int _earlyCount;
+    bool _valid;
+
+    float _sampleTime[MAX_SAMPLES];
+    float _sampleValue[MAX_SAMPLES];
+    int _sampleCount;
+
+    void enter(SelfTestPhase phase, GimbalAxis axis);
+    void analyzeStep();
+};
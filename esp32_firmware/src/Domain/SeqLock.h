@@ -0,0 +1,86 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <type_traits>
+
+// Pure C++ (no Arduino dependencies) so it can run and be benchmarked on the host.
+
+// Single-writer sequence lock for publishing a small POD snapshot.
+// The writer never waits. Readers never take a lock; they retry only if they
+// overlapped a write, which takes well under a microsecond for the structs
+// used here. The payload is stored as relaxed atomic words, so a torn read is
+// discarded by the sequence check rather than being a data race.
+template <typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock payload must be trivially copyable");
+
+public:
+    SeqLock() : _seq(0) {
+        T zero;
+        memset(&zero, 0, sizeof(zero));
+        store(zero);
+    }
+
+    // Writer side: one task only
+    void write(const T& value) {
+        uint32_t seq = _seq.load(std::memory_order_relaxed);
+        _seq.store(seq + 1, std::memory_order_relaxed); // Odd: write in progress
+        std::atomic_thread_fence(std::memory_order_release);
+        store(value);
+        _seq.store(seq + 2, std::memory_order_release);
+    }
+
+    // Reader side: any task
+    T read() const {
+        T value;
+        for (;;) {
+            uint32_t before = _seq.load(std::memory_order_acquire);
+            if (before & 1) {
+                continue;
+            }
+            load(value);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (_seq.load(std::memory_order_relaxed) == before) {
+                return value;
+            }
+        }
+    }
+
+    // Reader side, never waits: false if a write was in progress or
+    // overlapped the copy. For readers that can preempt the writer, which
+    // read() would spin on until the writer runs again.
+    bool tryRead(T& out) const {
+        uint32_t before = _seq.load(std::memory_order_acquire);
+        if (before & 1) {
+            return false;
+        }
+        load(out);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return _seq.load(std::memory_order_relaxed) == before;
+    }
+
+    uint32_t getVersion() const { return _seq.load(std::memory_order_acquire) >> 1; }
+
+private:
+    static const size_t WORDS = (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+    std::atomic<uint32_t> _seq;
+    std::atomic<uint32_t> _words[WORDS];
+
+    void store(const T& value) {
+        uint32_t words[WORDS] = {};
+        memcpy(words, &value, sizeof(T));
+        for (size_t i = 0; i < WORDS; i++) {
+            _words[i].store(words[i], std::memory_order_relaxed);
+        }
+    }
+
+    void load(T& value) const {
+        uint32_t words[WORDS];
+        for (size_t i = 0; i < WORDS; i++) {
+            words[i] = _words[i].load(std::memory_order_relaxed);
+        }
+        memcpy(&value, words, sizeof(T));
+    }
+};
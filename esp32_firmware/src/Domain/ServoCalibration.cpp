@@ -0,0 +1,148 @@
+#include "ServoCalibration.h"
+
+bool isValidServoCalibration(const ServoCalibration& cal) {
+    if (cal.count == 0) {
+        return true;
+    }
+    if (cal.count < 2 || cal.count > ServoCalibration::MAX_POINTS) {
+        return false;
+    }
+    bool ascending = cal.pulseUs[1] > cal.pulseUs[0];
+    for (int i = 1; i < cal.count; i++) {
+        if (!(cal.angle[i] > cal.angle[i - 1])) return false;
+        float step = cal.pulseUs[i] - cal.pulseUs[i - 1];
+        if (ascending ? !(step > 0) : !(step < 0)) return false;
+    }
+    return true;
+}
+
+bool buildServoCurve(const ServoCalibration& cal, ServoCurve& curve) {
+    curve.count = 0;
+    if (cal.count == 0 || !isValidServoCalibration(cal)) {
+        return false;
+    }
+
+    int n = cal.count;
+    float h[ServoCalibration::MAX_POINTS];     // Interval widths
+    float delta[ServoCalibration::MAX_POINTS]; // Interval secants
+    for (int i = 0; i < n; i++) {
+        curve.angle[i] = cal.angle[i];
+        curve.pulseUs[i] = cal.pulseUs[i];
+    }
+    for (int i = 0; i < n - 1; i++) {
+        h[i] = cal.angle[i + 1] - cal.angle[i];
+        delta[i] = (cal.pulseUs[i + 1] - cal.pulseUs[i]) / h[i];
+    }
+
+    if (n == 2) {
+        curve.slope[0] = curve.slope[1] = delta[0];
+        curve.count = n;
+        return true;
+    }
+
+    // Interior slopes: weighted harmonic mean of the neighbouring secants
+    // (Fritsch-Butland). The points are strictly monotone, so the secants
+    // never change sign and the mean is always defined.
+    for (int i = 1; i < n - 1; i++) {
+        float w1 = 2 * h[i] + h[i - 1];
+        float w2 = h[i] + 2 * h[i - 1];
+        curve.slope[i] = (w1 + w2) / (w1 / delta[i - 1] + w2 / delta[i]);
+    }
+
+    // End slopes: one-sided three-point estimate, limited so the end
+    // intervals stay monotone
+    const int ends[2][3] = {{0, 0, 1}, {n - 1, n - 2, n - 3}}; // point, near interval, far interval
+    for (const auto& e : ends) {
+        float h0 = h[e[1]], h1 = h[e[2]];
+        float d0 = delta[e[1]], d1 = delta[e[2]];
+        float m = ((2 * h0 + h1) * d0 - h0 * d1) / (h0 + h1);
+        if (m * d0 <= 0) {
+            m = 0;
+        } else if (m / d0 > 3) {
+            m = 3 * d0;
+        }
+        curve.slope[e[0]] = m;
+    }
+
+    curve.count = n;
+    return true;
+}
+
+float evalServoCurve(const ServoCurve& curve, float angle) {
+    int last = curve.count - 1;
+    if (angle <= curve.angle[0]) {
+        return curve.pulseUs[0];
+    }
+    if (angle >= curve.angle[last]) {
+        return curve.pulseUs[last];
+    }
+
+    int i = 1;
+    while (angle > curve.angle[i]) i++;
+    int k = i - 1;
+
+    // Cubic Hermite on [angle[k], angle[k+1]]
+    float h = curve.angle[i] - curve.angle[k];
+    float t = (angle - curve.angle[k]) / h;
+    float t2 = t * t;
+    float t3 = t2 * t;
+    return (2 * t3 - 3 * t2 + 1) * curve.pulseUs[k]
+         + (t3 - 2 * t2 + t) * h * curve.slope[k]
+         + (3 * t2 - 2 * t3) * curve.pulseUs[i]
+         + (t3 - t2) * h * curve.slope[i];
+}
+
+ServoCalibrationSession::ServoCalibrationSession()
+    : _active(false),
+      _axis(AXIS_YAW),
+      _points(0),
+      _minAngle(0),
+      _maxAngle(0),
+      _pulseUs(0)
+{
+    _table.count = 0;
+}
+
+void ServoCalibrationSession::start(GimbalAxis axis, uint8_t points, float minAngle, float maxAngle) {
+    if (points < 2) points = 2;
+    if (points > ServoCalibration::MAX_POINTS) points = ServoCalibration::MAX_POINTS;
+    _active = true;
+    _axis = axis;
+    _points = points;
+    _minAngle = minAngle;
+    _maxAngle = maxAngle;
+    _table.count = 0;
+}
+
+float ServoCalibrationSession::targetAngle() const {
+    if (_points < 2) {
+        return _minAngle;
+    }
+    uint8_t step = _table.count < _points ? _table.count : _points - 1;
+    return _minAngle + (_maxAngle - _minAngle) * step / (_points - 1);
+}
+
+CalibrationCapture ServoCalibrationSession::capture() {
+    if (!_active) {
+        return CAL_CAPTURE_INACTIVE;
+    }
+
+    int n = _table.count;
+    if (n >= 1) {
+        // Each pulse has to continue in the direction the first two set
+        float step = _pulseUs - _table.pulseUs[n - 1];
+        bool ascending = n >= 2 ? _table.pulseUs[1] > _table.pulseUs[0] : step > 0;
+        if (step == 0 || (step > 0) != ascending) {
+            return CAL_CAPTURE_REJECTED;
+        }
+    }
+
+    _table.angle[n] = targetAngle();
+    _table.pulseUs[n] = _pulseUs;
+    _table.count = n + 1;
+    if (_table.count < _points) {
+        return CAL_CAPTURE_NEXT;
+    }
+    _active = false;
+    return CAL_CAPTURE_DONE;
+}
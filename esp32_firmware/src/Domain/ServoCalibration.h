@@ -0,0 +1,73 @@
+#pragma once
+#include <stdint.h>
+#include "GainSchedule.h"
+
+// Pure C++ (no Arduino dependencies) so it can run and be benchmarked on the host.
+
+// Measured angle -> pulse points of one servo. Angles ascend strictly and
+// pulses move strictly in one direction (descending pulses reverse the
+// servo). count == 0 means uncalibrated: the servo maps linearly between its
+// endpoints.
+struct ServoCalibration {
+    static const int MAX_POINTS = 7;
+    uint8_t count;
+    float angle[MAX_POINTS];   // deg
+    float pulseUs[MAX_POINTS];
+};
+
+// Monotone piecewise cubic (PCHIP) through the calibration points. Unlike a
+// natural spline it cannot overshoot between points, so the pulse never
+// moves backwards while the commanded angle moves forwards.
+struct ServoCurve {
+    uint8_t count;             // 0 = no curve
+    float angle[ServoCalibration::MAX_POINTS];
+    float pulseUs[ServoCalibration::MAX_POINTS];
+    float slope[ServoCalibration::MAX_POINTS]; // us/deg at each point
+};
+
+// True for count == 0 or 2..MAX_POINTS points that satisfy the ordering above
+bool isValidServoCalibration(const ServoCalibration& cal);
+
+// Precomputes the point slopes. Returns false (and an empty curve) for an
+// invalid calibration.
+bool buildServoCurve(const ServoCalibration& cal, ServoCurve& curve);
+
+// Pulse for an angle; held at the end values outside the calibrated range
+float evalServoCurve(const ServoCurve& curve, float angle);
+
+enum CalibrationCapture {
+    CAL_CAPTURE_INACTIVE,  // No calibration running
+    CAL_CAPTURE_NEXT,      // Point stored, continue with the next angle
+    CAL_CAPTURE_DONE,      // Last point stored, the table is complete
+    CAL_CAPTURE_REJECTED   // Pulse does not continue the direction of the previous points
+};
+
+// Guided calibration of one servo: for each of `points` angles spread evenly
+// over [minAngle, maxAngle] the operator jogs the raw pulse until the servo
+// physically sits at targetAngle() and captures it.
+class ServoCalibrationSession {
+public:
+    ServoCalibrationSession();
+
+    void start(GimbalAxis axis, uint8_t points, float minAngle, float maxAngle);
+    void cancel() { _active = false; }
+    void setPulse(float us) { _pulseUs = us; }
+    CalibrationCapture capture();
+
+    bool active() const { return _active; }
+    GimbalAxis axis() const { return _axis; }
+    uint8_t step() const { return _table.count; }
+    uint8_t points() const { return _points; }
+    float targetAngle() const;
+    float pulseUs() const { return _pulseUs; }
+    const ServoCalibration& table() const { return _table; } // Points captured so far
+
+private:
+    bool _active;
+    GimbalAxis _axis;
+    uint8_t _points;
+    float _minAngle;
+    float _maxAngle;
+    float _pulseUs;
+    ServoCalibration _table;
+};
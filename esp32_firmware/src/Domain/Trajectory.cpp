@@ -0,0 +1,136 @@
+#include "Trajectory.h"
+#include <math.h>
+
+namespace {
+// Samples per segment when checking the limits at plan time
+const int LIMIT_SAMPLES = 32;
+}
+
+Trajectory::Trajectory() : _count(0), _timeScale(1.0f) {}
+
+bool Trajectory::plan(const float start[AXIS_COUNT], const TrajectoryKeyframe* keyframes, int count,
+                      TrajectoryShape shape, const AxisLimits limits[AXIS_COUNT]) {
+    _count = 0;
+    _timeScale = 1.0f;
+    if (count < 1 || count > MAX_KEYFRAMES) {
+        return false;
+    }
+
+    float points[MAX_KEYFRAMES + 1][AXIS_COUNT];
+    float times[MAX_KEYFRAMES + 1];
+    for (int axis = 0; axis < AXIS_COUNT; axis++) points[0][axis] = start[axis];
+    times[0] = 0;
+    for (int i = 0; i < count; i++) {
+        if (!(keyframes[i].time > times[i])) {
+            return false;
+        }
+        times[i + 1] = keyframes[i].time;
+        for (int axis = 0; axis < AXIS_COUNT; axis++) points[i + 1][axis] = keyframes[i].position[axis];
+    }
+
+    build(points, times, count, shape);
+
+    // Velocity, acceleration and jerk scale with 1/k, 1/k^2 and 1/k^3 when
+    // every time is multiplied by k, for both shapes, so one rebuild fits
+    float scale = requiredScale(limits);
+    if (scale > 1.0f) {
+        for (int i = 0; i <= count; i++) times[i] *= scale;
+        build(points, times, count, shape);
+        _timeScale = scale;
+    }
+    return true;
+}
+
+void Trajectory::build(const float (*points)[AXIS_COUNT], const float* times, int count, TrajectoryShape shape) {
+    // Velocity and acceleration at every point; the ends are at rest
+    float vel[MAX_KEYFRAMES + 1][AXIS_COUNT] = {};
+    float acc[MAX_KEYFRAMES + 1][AXIS_COUNT] = {};
+    if (shape == TRAJ_SPLINE) {
+        for (int k = 1; k < count; k++) {
+            float span = times[k + 1] - times[k - 1];
+            for (int axis = 0; axis < AXIS_COUNT; axis++) {
+                float before = (points[k][axis] - points[k - 1][axis]) / (times[k] - times[k - 1]);
+                float after = (points[k + 1][axis] - points[k][axis]) / (times[k + 1] - times[k]);
+                vel[k][axis] = (points[k + 1][axis] - points[k - 1][axis]) / span;
+                acc[k][axis] = (after - before) * 2.0f / span;
+            }
+        }
+    }
+
+    for (int s = 0; s < count; s++) {
+        TrajectorySegment& seg = _segments[s];
+        float h = times[s + 1] - times[s];
+        seg.startTime = times[s];
+        seg.duration = h;
+        seg.invDuration = 1.0f / h;
+        for (int axis = 0; axis < AXIS_COUNT; axis++) {
+            // Quintic Hermite in u = 0..1, derivatives scaled by the duration
+            float p0 = points[s][axis], p1 = points[s + 1][axis];
+            float v0 = vel[s][axis] * h, v1 = vel[s + 1][axis] * h;
+            float a0 = acc[s][axis] * h * h, a1 = acc[s + 1][axis] * h * h;
+            float d = p1 - p0;
+            float* c = seg.coeff[axis];
+            c[0] = p0;
+            c[1] = v0;
+            c[2] = 0.5f * a0;
+            c[3] = 10 * d - 6 * v0 - 4 * v1 - 0.5f * (3 * a0 - a1);
+            c[4] = -15 * d + 8 * v0 + 7 * v1 + 0.5f * (3 * a0 - 2 * a1);
+            c[5] = 6 * d - 3 * v0 - 3 * v1 - 0.5f * (a0 - a1);
+        }
+    }
+    _count = count;
+}
+
+float Trajectory::requiredScale(const AxisLimits limits[AXIS_COUNT]) const {
+    float scale = 1.0f;
+    for (int s = 0; s < _count; s++) {
+        const TrajectorySegment& seg = _segments[s];
+        float inv = seg.invDuration;
+        for (int axis = 0; axis < AXIS_COUNT; axis++) {
+            const float* c = seg.coeff[axis];
+            float maxV = 0, maxA = 0, maxJ = 0;
+            for (int i = 0; i <= LIMIT_SAMPLES; i++) {
+                float u = (float)i / LIMIT_SAMPLES;
+                float v = c[1] + u * (2 * c[2] + u * (3 * c[3] + u * (4 * c[4] + u * 5 * c[5])));
+                float a = 2 * c[2] + u * (6 * c[3] + u * (12 * c[4] + u * 20 * c[5]));
+                float j = 6 * c[3] + u * (24 * c[4] + u * 60 * c[5]);
+                maxV = fmaxf(maxV, fabsf(v));
+                maxA = fmaxf(maxA, fabsf(a));
+                maxJ = fmaxf(maxJ, fabsf(j));
+            }
+            const AxisLimits& l = limits[axis];
+            if (l.velocity > 0) scale = fmaxf(scale, maxV * inv / l.velocity);
+            if (l.acceleration > 0) scale = fmaxf(scale, sqrtf(maxA * inv * inv / l.acceleration));
+            if (l.jerk > 0) scale = fmaxf(scale, cbrtf(maxJ * inv * inv * inv / l.jerk));
+        }
+    }
+    return scale;
+}
+
+float Trajectory::duration() const {
+    if (_count == 0) {
+        return 0;
+    }
+    const TrajectorySegment& last = _segments[_count - 1];
+    return last.startTime + last.duration;
+}
+
+void Trajectory::evaluate(float t, int& cursor, float out[AXIS_COUNT]) const {
+    if (_count == 0) {
+        return;
+    }
+    if (cursor < 0 || cursor >= _count || t < _segments[cursor].startTime) {
+        cursor = 0;
+    }
+    while (cursor < _count - 1 && t >= _segments[cursor + 1].startTime) {
+        cursor++;
+    }
+
+    const TrajectorySegment& seg = _segments[cursor];
+    float u = (t - seg.startTime) * seg.invDuration;
+    u = u < 0 ? 0 : (u > 1 ? 1 : u);
+    for (int axis = 0; axis < AXIS_COUNT; axis++) {
+        const float* c = seg.coeff[axis];
+        out[axis] = c[0] + u * (c[1] + u * (c[2] + u * (c[3] + u * (c[4] + u * c[5]))));
+    }
+}
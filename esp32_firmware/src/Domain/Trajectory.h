@@ -0,0 +1,77 @@
+#pragma once
+#include <stdint.h>
+#include "GainSchedule.h"
+
+// Pure C++ (no Arduino dependencies) so it can run and be benchmarked on the host.
+
+// Multi-segment motion through keyframes, planned once into a fixed buffer
+// and evaluated every control tick in O(1).
+//
+// Each segment is a quintic per axis, so position, velocity and acceleration
+// are continuous across keyframes and jerk stays bounded:
+//  - TRAJ_SCURVE: minimum-jerk rest-to-rest move between consecutive
+//    keyframes; the gimbal stops at every keyframe.
+//  - TRAJ_SPLINE: passes through the keyframes without stopping. Velocities
+//    at interior keyframes are Catmull-Rom tangents and accelerations come
+//    from the neighbouring secants (C2). Starts and ends at rest.
+//
+// Keyframe times are kept exactly unless a per-axis velocity, acceleration
+// or jerk limit would be exceeded. Then the whole move is slowed by the
+// smallest uniform factor that fits, which keeps the relative timing.
+
+enum TrajectoryShape {
+    TRAJ_SCURVE = 0,
+    TRAJ_SPLINE = 1
+};
+
+struct TrajectoryKeyframe {
+    float time;                 // s from the start of the move
+    float position[AXIS_COUNT]; // deg
+};
+
+// deg/s, deg/s^2, deg/s^3; 0 = unlimited
+struct AxisLimits {
+    float velocity;
+    float acceleration;
+    float jerk;
+};
+
+struct TrajectorySegment {
+    float startTime;
+    float duration;
+    float invDuration;
+    // position = sum coeff[k] * u^k with u = (t - startTime) / duration in 0..1
+    float coeff[AXIS_COUNT][6];
+};
+
+class Trajectory {
+public:
+    static const int MAX_KEYFRAMES = 16; // Not counting the start point
+    static const int MAX_SEGMENTS = MAX_KEYFRAMES;
+
+    Trajectory();
+
+    // Plans from `start` at t = 0 through `count` keyframes with strictly
+    // ascending times > 0. Returns false and leaves the trajectory empty for
+    // bad input.
+    bool plan(const float start[AXIS_COUNT], const TrajectoryKeyframe* keyframes, int count,
+              TrajectoryShape shape, const AxisLimits limits[AXIS_COUNT]);
+    void clear() { _count = 0; }
+
+    bool empty() const { return _count == 0; }
+    int segmentCount() const { return _count; }
+    float duration() const;
+    float timeScale() const { return _timeScale; } // >= 1; > 1 when the limits slowed the move
+
+    // Position at time t, clamped to 0..duration(). `cursor` carries the
+    // segment index between calls, so stepping forward costs O(1); start it at 0.
+    void evaluate(float t, int& cursor, float out[AXIS_COUNT]) const;
+
+private:
+    TrajectorySegment _segments[MAX_SEGMENTS];
+    uint8_t _count;
+    float _timeScale;
+
+    void build(const float (*points)[AXIS_COUNT], const float* times, int count, TrajectoryShape shape);
+    float requiredScale(const AxisLimits limits[AXIS_COUNT]) const;
+};
@@ -0,0 +1,193 @@
+#include "MPU6050Fifo.h"
+
+// Register map (MPU-6000/6050 Register Map rev 4.2)
+#define MPU_REG_SMPLRT_DIV   0x19
+#define MPU_REG_CONFIG       0x1A
+#define MPU_REG_GYRO_CONFIG  0x1B
+#define MPU_REG_ACCEL_CONFIG 0x1C
+#define MPU_REG_FIFO_EN      0x23
+#define MPU_REG_INT_PIN_CFG  0x37
+#define MPU_REG_INT_ENABLE   0x38
+#define MPU_REG_SIGNAL_RESET 0x68
+#define MPU_REG_USER_CTRL    0x6A
+#define MPU_REG_PWR_MGMT_1   0x6B
+#define MPU_REG_FIFO_COUNTH  0x72
+#define MPU_REG_FIFO_R_W     0x74
+#define MPU_REG_WHO_AM_I     0x75
+
+volatile uint32_t MPU6050Fifo::_dataReadyCount = 0;
+
+MPU6050Fifo::MPU6050Fifo()
+    : _wire(nullptr),
+      _address(0x68),
+      _intPin(-1),
+      _samplePeriod(0.001f),
+      _head(0),
+      _tail(0),
+      _latest{},
+      _overflowCount(0),
+      _readErrorCount(0),
+      _droppedCount(0),
+      _lastDataReadyCount(0)
+{}
+
+bool MPU6050Fifo::begin(TwoWire& wire, uint8_t address, int intPin) {
+    _wire = &wire;
+    _address = address;
+    _intPin = intPin;
+
+    _wire->beginTransmission(_address);
+    if (_wire->endTransmission() != 0) {
+        return false;
+    }
+
+    // Genuine parts report 0x68; common clones report 0x70, 0x72 or 0x98
+    uint8_t whoAmI = 0;
+    if (!readRegisters(MPU_REG_WHO_AM_I, &whoAmI, 1)) {
+        return false;
+    }
+    if (whoAmI != 0x68 && whoAmI != 0x70 && whoAmI != 0x72 && whoAmI != 0x98) {
+        Serial.printf("MPU6050: unexpected WHO_AM_I 0x%02X\n", whoAmI);
+        return false;
+    }
+
+    // Reset, then clock from the X gyro PLL for a stable sample rate
+    writeRegister(MPU_REG_PWR_MGMT_1, 0x80);
+    delay(100);
+    writeRegister(MPU_REG_SIGNAL_RESET, 0x07);
+    delay(100);
+    writeRegister(MPU_REG_PWR_MGMT_1, 0x01);
+
+    writeRegister(MPU_REG_SMPLRT_DIV, MPU6050_SAMPLE_RATE_DIV);
+    writeRegister(MPU_REG_CONFIG, MPU6050_DLPF_CFG & 0x07);
+    writeRegister(MPU_REG_GYRO_CONFIG, 0x08);  // FS_SEL=1: +/-500 deg/s
+    writeRegister(MPU_REG_ACCEL_CONFIG, 0x10); // AFS_SEL=2: +/-8 g
+
+    // Internal sample rate is 1 kHz with the DLPF enabled
+    _samplePeriod = (1 + MPU6050_SAMPLE_RATE_DIV) / 1000.0f;
+
+    if (_intPin >= 0) {
+        // Active-high push-pull pulse, cleared by any read
+        writeRegister(MPU_REG_INT_PIN_CFG, 0x10);
+        writeRegister(MPU_REG_INT_ENABLE, 0x11); // FIFO_OFLOW_EN | DATA_RDY_EN
+        pinMode(_intPin, INPUT);
+        attachInterrupt(digitalPinToInterrupt(_intPin), onDataReady, RISING);
+    } else {
+        writeRegister(MPU_REG_INT_ENABLE, 0x00);
+    }
+
+    resetFifo();
+    return true;
+}
+
+void IRAM_ATTR MPU6050Fifo::onDataReady() {
+    _dataReadyCount++;
+}
+
+size_t MPU6050Fifo::drain() {
+    if (!_wire) return 0;
+
+    // With the interrupt wired, skip the bus entirely when nothing is new
+    if (_intPin >= 0) {
+        uint32_t ready = _dataReadyCount;
+        if (ready == _lastDataReadyCount) {
+            return 0;
+        }
+        _lastDataReadyCount = ready;
+    }
+
+    uint8_t countBuf[2];
+    if (!readRegisters(MPU_REG_FIFO_COUNTH, countBuf, 2)) {
+        return 0;
+    }
+    uint16_t count = ((uint16_t)countBuf[0] << 8) | countBuf[1];
+
+    // A (nearly) full FIFO has overwritten old bytes and lost frame alignment
+    if (count > FIFO_CAPACITY - FRAME_SIZE) {
+        _overflowCount++;
+        resetFifo();
+        return 0;
+    }
+
+    size_t frames = count / FRAME_SIZE;
+    size_t total = 0;
+    uint8_t buffer[FRAMES_PER_READ * FRAME_SIZE];
+
+    while (frames > 0) {
+        size_t batch = frames < FRAMES_PER_READ ? frames : FRAMES_PER_READ;
+        if (!readRegisters(MPU_REG_FIFO_R_W, buffer, batch * FRAME_SIZE)) {
+            // The chip may already have clocked out part of a frame, so the
+            // rest of the FIFO is no longer frame-aligned
+            _readErrorCount++;
+            resetFifo();
+            break;
+        }
+
+        for (size_t i = 0; i < batch; i++) {
+            const uint8_t* p = &buffer[i * FRAME_SIZE];
+            RawImuFrame frame;
+            frame.accelX = (int16_t)((p[0] << 8) | p[1]);
+            frame.accelY = (int16_t)((p[2] << 8) | p[3]);
+            frame.accelZ = (int16_t)((p[4] << 8) | p[5]);
+            frame.temp = (int16_t)((p[6] << 8) | p[7]);
+            frame.gyroX = (int16_t)((p[8] << 8) | p[9]);
+            frame.gyroY = (int16_t)((p[10] << 8) | p[11]);
+            frame.gyroZ = (int16_t)((p[12] << 8) | p[13]);
+            push(frame);
+        }
+
+        frames -= batch;
+        total += batch;
+    }
+
+    return total;
+}
+
+size_t MPU6050Fifo::available() const {
+    return (_head + MPU6050_RING_SIZE - _tail) % MPU6050_RING_SIZE;
+}
+
+bool MPU6050Fifo::pop(RawImuFrame& frame) {
+    if (_head == _tail) return false;
+    frame = _ring[_tail];
+    _tail = (_tail + 1) % MPU6050_RING_SIZE;
+    return true;
+}
+
+void MPU6050Fifo::push(const RawImuFrame& frame) {
+    size_t next = (_head + 1) % MPU6050_RING_SIZE;
+    if (next == _tail) {
+        // Ring full: drop the oldest frame so the newest data always wins
+        _tail = (_tail + 1) % MPU6050_RING_SIZE;
+        _droppedCount++;
+    }
+    _ring[_head] = frame;
+    _head = next;
+    _latest = frame;
+}
+
+void MPU6050Fifo::resetFifo() {
+    writeRegister(MPU_REG_FIFO_EN, 0x00);
+    writeRegister(MPU_REG_USER_CTRL, 0x04); // FIFO_RESET
+    writeRegister(MPU_REG_USER_CTRL, 0x40); // FIFO_EN
+    writeRegister(MPU_REG_FIFO_EN, 0xF8);   // TEMP | XG | YG | ZG | ACCEL
+}
+
+bool MPU6050Fifo::writeRegister(uint8_t reg, uint8_t value) {
+    _wire->beginTransmission(_address);
+    _wire->write(reg);
+    _wire->write(value);
+    return _wire->endTransmission() == 0;
+}
+
+bool MPU6050Fifo::readRegisters(uint8_t reg, uint8_t* buffer, size_t len) {
+    _wire->beginTransmission(_address);
+    _wire->write(reg);
+    if (_wire->endTransmission(false) != 0) {
+        return false;
+    }
+    if (_wire->requestFrom(_address, len, true) != len) {
+        return false;
+    }
+    return _wire->readBytes(buffer, len) == len;
+}
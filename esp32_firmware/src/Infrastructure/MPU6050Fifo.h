@@ -0,0 +1,71 @@
+#pragma once
+#include <Arduino.h>
+#include <Wire.h>
+#include "config.h"
+
+// One raw FIFO frame, in MPU6050 register order (accel, temp, gyro)
+struct RawImuFrame {
+    int16_t accelX, accelY, accelZ;
+    int16_t temp;
+    int16_t gyroX, gyroY, gyroZ;
+};
+
+// Native MPU6050 driver built on the hardware FIFO.
+// Every sample the chip produces is queued on-chip and drained with burst
+// reads into a fixed-size ring of raw frames, so nothing is lost between
+// control cycles and no float conversion happens on the read path.
+class MPU6050Fifo {
+public:
+    // Full-scale ranges used by begin(): +/-8 g and +/-500 deg/s
+    static constexpr float ACCEL_LSB_PER_G = 4096.0f;
+    static constexpr float GYRO_LSB_PER_DPS = 65.5f;
+
+    MPU6050Fifo();
+    bool begin(TwoWire& wire, uint8_t address, int intPin);
+
+    // Burst-read every complete frame queued in the FIFO into the ring.
+    // Returns the number of frames read.
+    size_t drain();
+
+    size_t available() const;
+    bool pop(RawImuFrame& frame);
+    const RawImuFrame& latest() const { return _latest; }
+
+    float getSamplePeriod() const { return _samplePeriod; }
+    uint32_t getOverflowCount() const { return _overflowCount; }
+    uint32_t getReadErrorCount() const { return _readErrorCount; } // Failed FIFO burst reads
+    uint32_t getDroppedCount() const { return _droppedCount; }
+
+    static float accelToMs2(int16_t raw) { return raw * (9.80665f / ACCEL_LSB_PER_G); }
+    static float gyroToRads(int16_t raw) { return raw * (0.01745329f / GYRO_LSB_PER_DPS); }
+    static float tempToC(int16_t raw) { return raw / 340.0f + 36.53f; }
+
+private:
+    static const uint8_t FRAME_SIZE = 14;
+    // Arduino-ESP32 Wire buffers 128 bytes per transaction
+    static const uint8_t FRAMES_PER_READ = 9;
+    static const uint16_t FIFO_CAPACITY = 1024;
+
+    TwoWire* _wire;
+    uint8_t _address;
+    int _intPin;
+    float _samplePeriod;
+
+    RawImuFrame _ring[MPU6050_RING_SIZE];
+    size_t _head;
+    size_t _tail;
+    RawImuFrame _latest;
+
+    uint32_t _overflowCount;
+    uint32_t _readErrorCount;
+    uint32_t _droppedCount;
+    uint32_t _lastDataReadyCount;
+
+    static volatile uint32_t _dataReadyCount;
+    static void IRAM_ATTR onDataReady();
+
+    bool writeRegister(uint8_t reg, uint8_t value);
+    bool readRegisters(uint8_t reg, uint8_t* buffer, size_t len);
+    void resetFifo();
+    void push(const RawImuFrame& frame);
+};
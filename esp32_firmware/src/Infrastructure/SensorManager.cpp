@@ -1,43 +1,69 @@
 #include "SensorManager.h"
 
+SensorManager::SensorManager() : _latest{} {
+    _mutex = xSemaphoreCreateMutex();
+}
+
 bool SensorManager::begin() {
-    // Initialize I2C bus only once with custom pins
-    Wire.begin(MPU6050_SDA, MPU6050_SCL);
+    // Initialize I2C bus only once with custom pins, in fast mode for FIFO bursts
+    Wire.begin(MPU6050_SDA, MPU6050_SCL, MPU6050_I2C_CLOCK);
     
     // Try standard I2C addresses: 0x68 (default) then 0x69 (alternate)
-    if (!mpu.begin(0x68, &Wire, 0)) {
+    if (!_imu.begin(Wire, 0x68, MPU6050_INT)) {
         // Try alternate address
-        if (!mpu.begin(0x69, &Wire, 0)) {
+        if (!_imu.begin(Wire, 0x69, MPU6050_INT)) {
             Serial.println("Failed to find MPU6050 chip");
             _sensorAvailable = false;
             return false;
         }
     }
 
-    mpu.setAccelerometerRange(MPU6050_RANGE_8_G);
-    mpu.setGyroRange(MPU6050_RANGE_500_DEG);
-    mpu.setFilterBandwidth(MPU6050_BAND_21_HZ);
-
     _sensorAvailable = true;
     return true;
 }
 
 void SensorManager::update() {
-    if (_sensorAvailable) {
-        mpu.getEvent(&a, &g, &temp);
+    if (_sensorAvailable && _imu.drain() > 0) {
+        // The I2C burst happens outside the lock; only the publish is guarded
+        xSemaphoreTake(_mutex, portMAX_DELAY);
+        _latest = _imu.latest();
+        xSemaphoreGive(_mutex);
+    }
+}
+
+size_t SensorManager::readFrames(RawImuFrame* out, size_t maxFrames) {
+    size_t count = 0;
+    while (count < maxFrames && _imu.pop(out[count])) {
+        count++;
     }
+    return count;
+}
+
+ImuSample SensorManager::toImuSample(const RawImuFrame& frame) {
+    ImuSample sample;
+    sample.accelX = MPU6050Fifo::accelToMs2(frame.accelX);
+    sample.accelY = MPU6050Fifo::accelToMs2(frame.accelY);
+    sample.accelZ = MPU6050Fifo::accelToMs2(frame.accelZ);
+    sample.gyroX = MPU6050Fifo::gyroToRads(frame.gyroX);
+    sample.gyroY = MPU6050Fifo::gyroToRads(frame.gyroY);
+    sample.gyroZ = MPU6050Fifo::gyroToRads(frame.gyroZ);
+    return sample;
 }
 
 SensorData SensorManager::getData() {
     SensorData data;
     if (_sensorAvailable) {
-        data.accelX = a.acceleration.x;
-        data.accelY = a.acceleration.y;
-        data.accelZ = a.acceleration.z;
-        data.gyroX = g.gyro.x;
-        data.gyroY = g.gyro.y;
-        data.gyroZ = g.gyro.z;
-        data.temp = temp.temperature;
+        xSemaphoreTake(_mutex, portMAX_DELAY);
+        RawImuFrame frame = _latest;
+        xSemaphoreGive(_mutex);
+
+        data.accelX = MPU6050Fifo::accelToMs2(frame.accelX);
+        data.accelY = MPU6050Fifo::accelToMs2(frame.accelY);
+        data.accelZ = MPU6050Fifo::accelToMs2(frame.accelZ);
+        data.gyroX = MPU6050Fifo::gyroToRads(frame.gyroX);
+        data.gyroY = MPU6050Fifo::gyroToRads(frame.gyroY);
+        data.gyroZ = MPU6050Fifo::gyroToRads(frame.gyroZ);
+        data.temp = MPU6050Fifo::tempToC(frame.temp);
     } else {
         // Return zeros when sensor is not available
         data.accelX = 0.0;
@@ -51,14 +77,15 @@ SensorData SensorManager::getData() {
     return data;
 }
 
+// Latest-sample accessors; only call from the control task (same task as update())
 float SensorManager::getGyroYaw() {
-    return _sensorAvailable ? g.gyro.z : 0.0;
+    return _sensorAvailable ? MPU6050Fifo::gyroToRads(_imu.latest().gyroZ) : 0.0;
 }
 
 float SensorManager::getGyroPitch() {
-    return _sensorAvailable ? g.gyro.y : 0.0;
+    return _sensorAvailable ? MPU6050Fifo::gyroToRads(_imu.latest().gyroY) : 0.0;
 }
 
 float SensorManager::getGyroRoll() {
-    return _sensorAvailable ? g.gyro.x : 0.0;
+    return _sensorAvailable ? MPU6050Fifo::gyroToRads(_imu.latest().gyroX) : 0.0;
 }
@@ -1,7 +1,8 @@
 #pragma once
-#include <Adafruit_MPU6050.h>
-#include <Adafruit_Sensor.h>
+#include <Arduino.h>
 #include <Wire.h>
+#include "MPU6050Fifo.h"
+#include "../Domain/AttitudeEstimator.h"
 #include "config.h"
 
 struct SensorData {
@@ -12,18 +13,28 @@ struct SensorData {
 
 class SensorManager {
 public:
+    SensorManager();
     bool begin();
-    void update();
+    void update(); // Drain the MPU6050 FIFO (control task)
     SensorData getData();
 
+    // Raw frames queued since the last call, oldest first (control task)
+    size_t readFrames(RawImuFrame* out, size_t maxFrames);
+    float getSamplePeriod() const { return _imu.getSamplePeriod(); }
+    static ImuSample toImuSample(const RawImuFrame& frame);
+
     float getGyroYaw();
     float getGyroPitch();
     float getGyroRoll();
     
     bool isAvailable() const { return _sensorAvailable; }
+    uint32_t getOverflowCount() const { return _imu.getOverflowCount(); }
+    uint32_t getReadErrorCount() const { return _imu.getReadErrorCount(); }
+    uint32_t getDroppedCount() const { return _imu.getDroppedCount(); }
 
 private:
-    Adafruit_MPU6050 mpu;
-    sensors_event_t a, g, temp;
+    MPU6050Fifo _imu;
+    RawImuFrame _latest; // Published copy of the newest frame for getData()
     bool _sensorAvailable = false;
+    SemaphoreHandle_t _mutex; // update() runs in the control task, getData() in loop()
 };
@@ -0,0 +1,91 @@
+#include "ServoOutput.h"
+
+ServoOutput::ServoOutput()
+    : _pin(-1),
+      _channel(0),
+      _attached(false),
+      _refreshHz(SERVO_REFRESH_HZ),
+      _minUs(SERVO_PULSE_MIN_US),
+      _maxUs(SERVO_PULSE_MAX_US),
+      _dutyPerUs(0),
+      _pulseUs((SERVO_PULSE_MIN_US + SERVO_PULSE_MAX_US) / 2.0f),
+      _duty(UINT32_MAX)
+{
+    _curve.count = 0;
+}
+
+bool ServoOutput::begin(int pin, uint8_t channel, uint32_t refreshHz) {
+    _pin = pin;
+    _channel = channel;
+    _refreshHz = constrain(refreshHz, SERVO_MIN_REFRESH_HZ, SERVO_MAX_REFRESH_HZ);
+
+    applyTiming();
+    if (_dutyPerUs == 0) {
+        Serial.printf("LEDC setup failed on channel %u\n", _channel);
+        return false;
+    }
+    ledcAttachPin(_pin, _channel);
+    _attached = true;
+    writeDuty();
+    return true;
+}
+
+void ServoOutput::setRefreshRate(uint32_t refreshHz) {
+    refreshHz = constrain(refreshHz, SERVO_MIN_REFRESH_HZ, SERVO_MAX_REFRESH_HZ);
+    if (refreshHz == _refreshHz) {
+        return;
+    }
+    _refreshHz = refreshHz;
+    if (_attached) {
+        applyTiming();
+        writeDuty();
+    }
+}
+
+void ServoOutput::setEndpoints(float minUs, float maxUs) {
+    _minUs = minUs;
+    _maxUs = maxUs;
+}
+
+void ServoOutput::setCalibration(const ServoCalibration& cal) {
+    buildServoCurve(cal, _curve);
+}
+
+float ServoOutput::pulseForDegrees(float degrees) const {
+    degrees = constrain(degrees, SERVO_MIN_ANGLE, SERVO_MAX_ANGLE);
+    if (_curve.count > 0) {
+        return evalServoCurve(_curve, degrees);
+    }
+    // Endpoints may be reversed (minUs > maxUs)
+    float fraction = (degrees - SERVO_MIN_ANGLE) / (float)(SERVO_MAX_ANGLE - SERVO_MIN_ANGLE);
+    return _minUs + (_maxUs - _minUs) * fraction;
+}
+
+void ServoOutput::writeDegrees(float degrees) {
+    writeMicroseconds(pulseForDegrees(degrees));
+}
+
+void ServoOutput::writeMicroseconds(float us) {
+    // Endpoints and calibration points are validated against the same
+    // limits, so this only bites on raw pulses (calibration jogging)
+    _pulseUs = constrain(us, SERVO_PULSE_LIMIT_MIN_US, SERVO_PULSE_LIMIT_MAX_US);
+    if (_attached) {
+        writeDuty();
+    }
+}
+
+void ServoOutput::applyTiming() {
+    // ledcSetup returns the frequency it achieved, 0 if the resolution is
+    // not possible at this rate
+    uint32_t actualHz = ledcSetup(_channel, _refreshHz, SERVO_LEDC_RESOLUTION_BITS);
+    _dutyPerUs = actualHz ? actualHz * (float)(1UL << SERVO_LEDC_RESOLUTION_BITS) / 1e6f : 0;
+    _duty = UINT32_MAX; // Force the next write
+}
+
+void ServoOutput::writeDuty() {
+    uint32_t duty = (uint32_t)(_pulseUs * _dutyPerUs + 0.5f);
+    if (duty != _duty) {
+        ledcWrite(_channel, duty);
+        _duty = duty;
+    }
+}
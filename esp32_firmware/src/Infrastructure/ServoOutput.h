@@ -0,0 +1,44 @@
+#pragma once
+#include <Arduino.h>
+#include "config.h"
+#include "../Domain/ServoCalibration.h"
+
+// Servo pulse output on one LEDC channel.
+// Commands are float degrees or microseconds; the pulse is quantized only by
+// the LEDC duty resolution (SERVO_LEDC_RESOLUTION_BITS), not to whole
+// degrees. Each servo has its own endpoints and the refresh rate can be
+// raised for digital servos, which also shortens the wait for a new pulse.
+// A calibration table, when set, replaces the linear endpoint mapping.
+//
+// Settings can be made before begin(); they are applied when the channel is
+// attached.
+class ServoOutput {
+public:
+    ServoOutput();
+    bool begin(int pin, uint8_t channel, uint32_t refreshHz);
+
+    void setRefreshRate(uint32_t refreshHz);     // Re-times the channel, keeps the pulse width
+    void setEndpoints(float minUs, float maxUs); // Pulse at SERVO_MIN_ANGLE / SERVO_MAX_ANGLE
+    void setCalibration(const ServoCalibration& cal); // count == 0 or invalid: use the endpoints
+
+    void writeDegrees(float degrees);            // Clamped to SERVO_MIN_ANGLE..SERVO_MAX_ANGLE
+    void writeMicroseconds(float us);            // Clamped to SERVO_PULSE_LIMIT_MIN_US..MAX_US
+    float pulseForDegrees(float degrees) const;  // Pulse writeDegrees() would output
+
+    float getPulseUs() const { return _pulseUs; }
+    uint32_t getRefreshRate() const { return _refreshHz; }
+
+private:
+    int _pin;
+    uint8_t _channel;
+    bool _attached;
+    uint32_t _refreshHz;
+    float _minUs, _maxUs;
+    ServoCurve _curve;
+    float _dutyPerUs;   // LEDC counts per microsecond of pulse at the current rate
+    float _pulseUs;
+    uint32_t _duty;     // Last value written, to skip redundant register writes
+
+    void applyTiming();
+    void writeDuty();
+};
@@ -1,4 +1,5 @@
 #include "BluetoothManager.h"
+#include "../Domain/EventLog.h"
 
 BluetoothManager::BluetoothManager(GimbalController& gimbalController)
     : _gimbalController(gimbalController),
@@ -17,14 +18,14 @@ void BluetoothManager::ServerCallbacks::onConnect(BLEServer* pServer) {
     _manager->_deviceConnected = true;
     _manager->_isAdvertising = false;
     _manager->setEvent("connected");
-    Serial.println("BLE Client Connected");
+    LOG_INFO(LOG_BLE_CONNECTED);
 }
 
 void BluetoothManager::ServerCallbacks::onDisconnect(BLEServer* pServer) {
     _manager->_deviceConnected = false;
     _manager->_isAdvertising = false;
     _manager->setEvent("disconnected");
-    Serial.println("BLE Client Disconnected");
+    LOG_INFO(LOG_BLE_DISCONNECTED);
 }
 
 void BluetoothManager::PositionCallbacks::onWrite(BLECharacteristic* pCharacteristic) {
@@ -40,11 +41,11 @@ void BluetoothManager::PositionCallbacks::onWrite(BLECharacteristic* pCharacteri
         if (yaw < 0.0f || yaw > 180.0f || 
             pitch < 0.0f || pitch > 180.0f || 
             roll < 0.0f || roll > 180.0f) {
-            Serial.println("BLE Position: Invalid values, ignoring");
+            LOG_WARN(LOG_BLE_POSITION_INVALID);
             return;
         }
         
-        Serial.printf("BLE Position: Yaw=%.1f, Pitch=%.1f, Roll=%.1f\n", yaw, pitch, roll);
+        LOG_DEBUG(LOG_BLE_POSITION, yaw, pitch, roll);
         _manager->_gimbalController.setManualPosition(yaw, pitch, roll);
     }
 }
@@ -56,10 +57,10 @@ void BluetoothManager::ModeCallbacks::onWrite(BLECharacteristic* pCharacteristic
         int mode = value[0];
         // Validate mode (0 = Manual, 1 = Auto)
         if (mode != 0 && mode != 1) {
-            Serial.printf("BLE Mode Change: Invalid mode %d, ignoring\n", mode);
+            LOG_WARN(LOG_BLE_MODE_INVALID, mode);
             return;
         }
-        Serial.printf("BLE Mode Change: %d\n", mode);
+        LOG_INFO(LOG_BLE_MODE, mode);
         _manager->_gimbalController.setMode(mode);
     }
 }
@@ -143,7 +144,7 @@ void BluetoothManager::handle() {
             _pServer->startAdvertising();
             _isAdvertising = true;
             setEvent("advertising");
-            Serial.println("Start advertising");
+            LOG_INFO(LOG_BLE_ADVERTISING);
             _oldDeviceConnected = _deviceConnected;
             lastDisconnect = millis();
         }
@@ -180,8 +181,10 @@ void BluetoothManager::setEvent(const char* event) {
 
 void BluetoothManager::updateStatus() {
     if (_deviceConnected && _pStatusCharacteristic) {
-        GimbalPosition pos = _gimbalController.getCurrentPosition();
-        int mode = _gimbalController.getMode();
+        // One consistent snapshot; never blocks the control task
+        GimbalState state = _gimbalController.getState();
+        const GimbalPosition& pos = state.position;
+        int mode = state.mode;
         
         // Pack status into bytes: mode (1 byte) + yaw (4 bytes) + pitch (4 bytes) + roll (4 bytes)
         uint8_t status[13];
@@ -1,7 +1,118 @@
 #include "ConfigManager.h"
+#include "../Domain/EventLog.h"
+#include <esp_rom_crc.h>
+
+// On-flash layout of the binary backup copy. Fixed-size fields so it can be
+// validated and restored without a JSON parser.
+static const uint32_t CONFIG_BACKUP_MAGIC = 0x47464347; // "GCFG"
+static const uint16_t CONFIG_BACKUP_VERSION = 6; // 2: per-axis gains and gain schedule, 3: servo output, 4: servo calibration, 5: output filters, 6: IMU calibration
+
+struct __attribute__((packed)) ConfigBackupRecord {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;
+    char wifi_ssid[33];
+    char wifi_password[65];
+    char hotspot_ssid[33];
+    char hotspot_password[65];
+    int32_t mode;
+    PidGains gains[AXIS_COUNT];
+    GainSchedule gainSchedule;
+    int32_t estimator;
+    ServoEndpoints servo_endpoints[AXIS_COUNT];
+    int32_t servo_refresh_hz;
+    ServoCalibration servo_calibration[AXIS_COUNT];
+    OutputFilterConfig output_filter[AXIS_COUNT];
+    ImuCalibration imu_calibration;
+    int32_t yaw_offset;
+    int32_t pitch_offset;
+    int32_t roll_offset;
+    float flat_ref_yaw;
+    float flat_ref_pitch;
+    float flat_ref_roll;
+    uint32_t crc; // CRC32 of every byte above
+};
+
+static bool validPulse(float us) {
+    return us >= SERVO_PULSE_LIMIT_MIN_US && us <= SERVO_PULSE_LIMIT_MAX_US;
+}
+
+static bool validEndpoints(const ServoEndpoints& e) {
+    return validPulse(e.minUs) && validPulse(e.maxUs) && fabsf(e.maxUs - e.minUs) >= SERVO_PULSE_MIN_SPAN_US;
+}
+
+static bool validCalibration(const ServoCalibration& cal) {
+    if (!isValidServoCalibration(cal)) {
+        return false;
+    }
+    for (int i = 0; i < cal.count; i++) {
+        if (!validPulse(cal.pulseUs[i]) || cal.angle[i] < SERVO_MIN_ANGLE || cal.angle[i] > SERVO_MAX_ANGLE) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool validFilterHz(float hz) {
+    return hz >= SERVO_FILTER_MIN_HZ && hz <= SERVO_FILTER_MAX_HZ;
+}
+
+static bool validFilterQ(float q) {
+    return q >= SERVO_FILTER_MIN_Q && q <= SERVO_FILTER_MAX_Q;
+}
+
+static bool validOutputFilter(const OutputFilterConfig& f) {
+    if (f.lowpass > OUTPUT_LOWPASS_BIQUAD || !validFilterHz(f.lowpassHz) || !validFilterQ(f.lowpassQ)) {
+        return false;
+    }
+    if (f.notchHz != 0 && !validFilterHz(f.notchHz)) {
+        return false;
+    }
+    return validFilterQ(f.notchQ) && f.slewRate >= 0 && f.slewRate <= SERVO_FILTER_MAX_SLEW_DPS;
+}
+
+bool ConfigManager::validImuCalibration(const ImuCalibration& cal) {
+    if (!isValidImuCalibration(cal)) {
+        return false;
+    }
+    for (int i = 0; i < 3; i++) {
+        if (fabsf(cal.accelOffset[i]) > IMU_ACCEL_MAX_OFFSET_MS2 ||
+            cal.accelScale[i] < IMU_ACCEL_MIN_SCALE || cal.accelScale[i] > IMU_ACCEL_MAX_SCALE) {
+            return false;
+        }
+    }
+    // A polynomial has its extremes at the ends of its range or at its vertex
+    for (int i = 0; i < 3; i++) {
+        float vertex = cal.gyroTemp[i][2] != 0 ? cal.tempRef - cal.gyroTemp[i][1] / (2 * cal.gyroTemp[i][2]) : cal.tempRef;
+        float temps[3] = {cal.tempMin, cal.tempMax, vertex}; // gyroTempBias() clamps the vertex into range
+        for (float t : temps) {
+            float bias[3];
+            gyroTempBias(cal, t, bias);
+            if (fabsf(bias[i]) > IMU_GYRO_MAX_BIAS_RAD_S) return false;
+        }
+    }
+    return true;
+}
+
+static bool validRefreshRate(int hz) {
+    return hz >= SERVO_MIN_REFRESH_HZ && hz <= SERVO_MAX_REFRESH_HZ;
+}
+
+static uint32_t backupCrc(const ConfigBackupRecord& record) {
+    return esp_rom_crc32_le(0, (const uint8_t*)&record, offsetof(ConfigBackupRecord, crc));
+}
 
 ConfigManager::ConfigManager() {
     _mutex = xSemaphoreCreateMutex();
+    _ioMutex = xSemaphoreCreateMutex();
+    _persistTask = nullptr;
+    _dirty = false;
+    _dirtySinceMs = 0;
+    _lastChangeMs = 0;
+    _lastFlushMs = 0;
+    memset(&_persistStats, 0, sizeof(_persistStats));
+    _controlVersion.store(0, std::memory_order_relaxed);
+    _controlParams.store(&_controlSlots[0], std::memory_order_release);
     resetToDefaults();
 }
 
@@ -12,9 +123,19 @@ void ConfigManager::resetToDefaults() {
     config.hotspot_ssid = HOTSPOT_SSID;
     config.hotspot_password = HOTSPOT_PASSWORD;
     config.mode = MODE_MANUAL;
-    config.kp = KP;
-    config.ki = KI;
-    config.kd = KD;
+    config.gains[AXIS_YAW] = {KP_YAW, KI_YAW, KD_YAW};
+    config.gains[AXIS_PITCH] = {KP_PITCH, KI_PITCH, KD_PITCH};
+    config.gains[AXIS_ROLL] = {KP_ROLL, KI_ROLL, KD_ROLL};
+    memset(&config.gainSchedule, 0, sizeof(config.gainSchedule)); // Scheduling off
+    for (int axis = 0; axis < AXIS_COUNT; axis++) {
+        config.servo_endpoints[axis] = {SERVO_PULSE_MIN_US, SERVO_PULSE_MAX_US};
+        config.servo_calibration[axis].count = 0; // Linear between the endpoints
+        config.output_filter[axis] = {OUTPUT_LOWPASS_FIRST_ORDER, SERVO_FILTER_LOWPASS_HZ, SERVO_FILTER_LOWPASS_Q,
+                                      0.0f, SERVO_FILTER_NOTCH_Q, 0.0f};
+    }
+    config.servo_refresh_hz = SERVO_REFRESH_HZ;
+    config.estimator = ESTIMATOR_DEFAULT;
+    config.imu_calibration = defaultImuCalibration();
     config.yaw_offset = 0;
     config.pitch_offset = 0;
     config.roll_offset = 0;
@@ -22,6 +143,7 @@ void ConfigManager::resetToDefaults() {
     config.flat_ref_yaw = -1.0;
     config.flat_ref_pitch = -1.0;
     config.flat_ref_roll = -1.0;
+    _publishControlParams();
     xSemaphoreGive(_mutex);
 }
 
@@ -36,100 +158,465 @@ bool ConfigManager::begin() {
         }
         Serial.println("LittleFS formatted successfully");
     }
-    return loadConfig();
+
+    bool loaded = loadConfig();
+
+    if (!_persistTask) {
+        BaseType_t created = xTaskCreatePinnedToCore(
+            persistTaskEntry, "config", CONFIG_TASK_STACK, this,
+            CONFIG_TASK_PRIORITY, &_persistTask, CONFIG_TASK_CORE);
+        if (created != pdPASS) {
+            // Still usable: saveConfig()/flush() write synchronously
+            Serial.println("Failed to create config persistence task");
+            _persistTask = nullptr;
+        }
+    }
+    return loaded;
 }
 
 bool ConfigManager::loadConfig() {
-    xSemaphoreTake(_mutex, portMAX_DELAY);
+    // A leftover temp file means a write was interrupted before its rename;
+    // the previous file is still intact
+    if (LittleFS.exists(_tempFilename)) LittleFS.remove(_tempFilename);
+    if (LittleFS.exists(_backupTempFilename)) LittleFS.remove(_backupTempFilename);
 
-    if (!LittleFS.exists(_filename)) {
-        Serial.println("Config file not found, creating default.");
+    // Keys missing from the file keep their current value
+    AppConfig loaded = getConfig();
+    bool fromJson = _readJson(loaded);
+    bool fromBackup = !fromJson && _readBackup(loaded);
+    if (fromJson || fromBackup) {
+        xSemaphoreTake(_mutex, portMAX_DELAY);
+        config = loaded;
+        _publishControlParams();
         xSemaphoreGive(_mutex);
-        saveConfig(); // This will lock again
+    }
+
+    if (fromJson) {
+        if (!LittleFS.exists(_backupFilename)) {
+            // First boot after upgrading: let the persistence task create the backup
+            xSemaphoreTake(_mutex, portMAX_DELAY);
+            _markDirty();
+            xSemaphoreGive(_mutex);
+        }
         return true;
     }
 
+    if (fromBackup) {
+        Serial.println("Config file missing or corrupt, restored from binary backup");
+    } else {
+        Serial.println("No valid config found, using defaults and persisting them");
+        resetToDefaults();
+    }
+    // Rewrite both copies now; this runs at boot before anything else uses the config
+    return saveConfig();
+}
+
+bool ConfigManager::_readJson(AppConfig& out) {
+    if (!LittleFS.exists(_filename)) {
+        return false;
+    }
+
     File file = LittleFS.open(_filename, "r");
     if (!file) {
         Serial.println("Failed to open config file");
-        xSemaphoreGive(_mutex);
         return false;
     }
 
-    StaticJsonDocument<1024> doc;
+    StaticJsonDocument<CONFIG_JSON_CAPACITY> doc;
     DeserializationError error = deserializeJson(doc, file);
     file.close();
 
     if (error) {
-        Serial.println("Failed to read file, using defaults and persisting them");
-        // Release the mutex before calling methods that will lock it again.
-        xSemaphoreGive(_mutex);
-        // Ensure we actually revert to defaults and persist them to fix the file.
-        resetToDefaults();
-        bool saved = saveConfig();
-        return saved;
+        Serial.println("Failed to parse config file");
+        return false;
     }
 
-    if (doc.containsKey("wifi_ssid")) config.wifi_ssid = doc["wifi_ssid"].as<String>();
-    if (doc.containsKey("wifi_password")) config.wifi_password = doc["wifi_password"].as<String>();
-    if (doc.containsKey("hotspot_ssid")) config.hotspot_ssid = doc["hotspot_ssid"].as<String>();
-    if (doc.containsKey("hotspot_password")) config.hotspot_password = doc["hotspot_password"].as<String>();
+    if (doc.containsKey("wifi_ssid")) out.wifi_ssid = doc["wifi_ssid"].as<String>();
+    if (doc.containsKey("wifi_password")) out.wifi_password = doc["wifi_password"].as<String>();
+    if (doc.containsKey("hotspot_ssid")) out.hotspot_ssid = doc["hotspot_ssid"].as<String>();
+    if (doc.containsKey("hotspot_password")) out.hotspot_password = doc["hotspot_password"].as<String>();
 
-    config.mode = doc["mode"] | config.mode;
-    config.kp = doc["kp"] | config.kp;
-    config.ki = doc["ki"] | config.ki;
-    config.kd = doc["kd"] | config.kd;
+    out.mode = doc["mode"] | out.mode;
+    readGainsJson(doc.as<JsonObjectConst>(), out);
+    readServoJson(doc.as<JsonObjectConst>(), out);
+    out.estimator = doc["estimator"] | out.estimator;
+    readImuJson(doc.as<JsonObjectConst>(), out);
 
-    config.yaw_offset = doc["yaw_offset"] | config.yaw_offset;
-    config.pitch_offset = doc["pitch_offset"] | config.pitch_offset;
-    config.roll_offset = doc["roll_offset"] | config.roll_offset;
-    
-    config.flat_ref_yaw = doc["flat_ref_yaw"] | config.flat_ref_yaw;
-    config.flat_ref_pitch = doc["flat_ref_pitch"] | config.flat_ref_pitch;
-    config.flat_ref_roll = doc["flat_ref_roll"] | config.flat_ref_roll;
+    out.yaw_offset = doc["yaw_offset"] | out.yaw_offset;
+    out.pitch_offset = doc["pitch_offset"] | out.pitch_offset;
+    out.roll_offset = doc["roll_offset"] | out.roll_offset;
 
-    xSemaphoreGive(_mutex);
+    out.flat_ref_yaw = doc["flat_ref_yaw"] | out.flat_ref_yaw;
+    out.flat_ref_pitch = doc["flat_ref_pitch"] | out.flat_ref_pitch;
+    out.flat_ref_roll = doc["flat_ref_roll"] | out.flat_ref_roll;
+    return true;
+}
+
+bool ConfigManager::_readBackup(AppConfig& out) {
+    if (!LittleFS.exists(_backupFilename)) {
+        return false;
+    }
+
+    File file = LittleFS.open(_backupFilename, "r");
+    if (!file) {
+        return false;
+    }
+
+    ConfigBackupRecord record;
+    size_t read = file.read((uint8_t*)&record, sizeof(record));
+    file.close();
+
+    if (read != sizeof(record) || record.magic != CONFIG_BACKUP_MAGIC ||
+        record.version != CONFIG_BACKUP_VERSION || record.size != sizeof(record) ||
+        record.crc != backupCrc(record)) {
+        Serial.println("Config backup is invalid");
+        return false;
+    }
+
+    // Strings are stored NUL-padded; force termination in case of a bad writer
+    record.wifi_ssid[sizeof(record.wifi_ssid) - 1] = '\0';
+    record.wifi_password[sizeof(record.wifi_password) - 1] = '\0';
+    record.hotspot_ssid[sizeof(record.hotspot_ssid) - 1] = '\0';
+    record.hotspot_password[sizeof(record.hotspot_password) - 1] = '\0';
+
+    out.wifi_ssid = record.wifi_ssid;
+    out.wifi_password = record.wifi_password;
+    out.hotspot_ssid = record.hotspot_ssid;
+    out.hotspot_password = record.hotspot_password;
+    out.mode = record.mode;
+    memcpy(out.gains, record.gains, sizeof(out.gains));
+    out.gainSchedule = record.gainSchedule;
+    normalizeSchedule(out.gainSchedule);
+    out.estimator = record.estimator;
+    if (validImuCalibration(record.imu_calibration)) out.imu_calibration = record.imu_calibration;
+    for (int axis = 0; axis < AXIS_COUNT; axis++) {
+        if (validEndpoints(record.servo_endpoints[axis])) out.servo_endpoints[axis] = record.servo_endpoints[axis];
+        if (validCalibration(record.servo_calibration[axis])) out.servo_calibration[axis] = record.servo_calibration[axis];
+        if (validOutputFilter(record.output_filter[axis])) out.output_filter[axis] = record.output_filter[axis];
+    }
+    if (validRefreshRate(record.servo_refresh_hz)) out.servo_refresh_hz = record.servo_refresh_hz;
+    out.yaw_offset = record.yaw_offset;
+    out.pitch_offset = record.pitch_offset;
+    out.roll_offset = record.roll_offset;
+    out.flat_ref_yaw = record.flat_ref_yaw;
+    out.flat_ref_pitch = record.flat_ref_pitch;
+    out.flat_ref_roll = record.flat_ref_roll;
     return true;
 }
 
 bool ConfigManager::saveConfig() {
     xSemaphoreTake(_mutex, portMAX_DELAY);
-    bool result = _saveConfigInternal();
+    _markDirty();
     xSemaphoreGive(_mutex);
-    return result;
+    return flush();
 }
 
-bool ConfigManager::_saveConfigInternal() {
+bool ConfigManager::flush() {
+    // Only one writer at a time. _mutex is held just long enough to snapshot
+    // the config, so updateConfig() and getConfig() never wait for flash.
+    xSemaphoreTake(_ioMutex, portMAX_DELAY);
+
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    if (!_dirty) {
+        xSemaphoreGive(_mutex);
+        xSemaphoreGive(_ioMutex);
+        return true;
+    }
+    AppConfig snapshot = config;
+    _dirty = false;
+    xSemaphoreGive(_mutex);
+
+    uint32_t start = millis();
+    bool ok = _writeFiles(snapshot);
+    uint32_t now = millis();
+
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    _lastFlushMs = now;
+    _persistStats.lastWriteMs = now - start;
+    if (ok) {
+        _persistStats.written++;
+    } else {
+        _persistStats.failed++;
+        // Retry after the minimum interval unless a newer change already re-armed it
+        if (!_dirty) {
+            _dirty = true;
+            _dirtySinceMs = now;
+            _lastChangeMs = now;
+        }
+    }
+    xSemaphoreGive(_mutex);
+
+    xSemaphoreGive(_ioMutex);
+    return ok;
+}
+
+bool ConfigManager::_writeFiles(const AppConfig& snapshot) {
     // ⚠️ SECURITY ISSUE: Passwords stored in plain text. See KnownIssues.MD #ISSUE-004
-    // ⚠️ DATA INTEGRITY ISSUE: Non-atomic writes. See KnownIssues.MD #ISSUE-019
-    // TODO: Consider encryption for passwords and atomic write-rename pattern
-    StaticJsonDocument<1024> doc;
-    doc["wifi_ssid"] = config.wifi_ssid;
-    doc["wifi_password"] = config.wifi_password;
-    doc["hotspot_ssid"] = config.hotspot_ssid;
-    doc["hotspot_password"] = config.hotspot_password;
-    doc["mode"] = config.mode;
-    doc["kp"] = config.kp;
-    doc["ki"] = config.ki;
-    doc["kd"] = config.kd;
-    doc["yaw_offset"] = config.yaw_offset;
-    doc["pitch_offset"] = config.pitch_offset;
-    doc["roll_offset"] = config.roll_offset;
-    doc["flat_ref_yaw"] = config.flat_ref_yaw;
-    doc["flat_ref_pitch"] = config.flat_ref_pitch;
-    doc["flat_ref_roll"] = config.flat_ref_roll;
-
-    File file = LittleFS.open(_filename, "w");
+    // TODO: Consider encryption for passwords
+    StaticJsonDocument<CONFIG_JSON_CAPACITY> doc;
+    doc["wifi_ssid"] = snapshot.wifi_ssid;
+    doc["wifi_password"] = snapshot.wifi_password;
+    doc["hotspot_ssid"] = snapshot.hotspot_ssid;
+    doc["hotspot_password"] = snapshot.hotspot_password;
+    doc["mode"] = snapshot.mode;
+    writeGainsJson(snapshot, doc.as<JsonObject>());
+    writeServoJson(snapshot, doc.as<JsonObject>());
+    doc["estimator"] = snapshot.estimator;
+    writeImuJson(snapshot, doc.as<JsonObject>());
+    doc["yaw_offset"] = snapshot.yaw_offset;
+    doc["pitch_offset"] = snapshot.pitch_offset;
+    doc["roll_offset"] = snapshot.roll_offset;
+    doc["flat_ref_yaw"] = snapshot.flat_ref_yaw;
+    doc["flat_ref_pitch"] = snapshot.flat_ref_pitch;
+    doc["flat_ref_roll"] = snapshot.flat_ref_roll;
+
+    // Write-rename: a power loss leaves either the old or the new file, never a truncated one
+    File file = LittleFS.open(_tempFilename, "w");
     if (!file) {
-        Serial.println("Failed to open config file for writing");
+        LOG_ERROR(LOG_CONFIG_OPEN_FAILED);
         return false;
     }
+    size_t written = serializeJson(doc, file);
+    file.close();
+    if (written == 0 || !_replaceFile(_tempFilename, _filename)) {
+        LOG_ERROR(LOG_CONFIG_WRITE_FAILED);
+        LittleFS.remove(_tempFilename);
+        return false;
+    }
+
+    ConfigBackupRecord record;
+    memset(&record, 0, sizeof(record));
+    record.magic = CONFIG_BACKUP_MAGIC;
+    record.version = CONFIG_BACKUP_VERSION;
+    record.size = sizeof(record);
+    strncpy(record.wifi_ssid, snapshot.wifi_ssid.c_str(), sizeof(record.wifi_ssid) - 1);
+    strncpy(record.wifi_password, snapshot.wifi_password.c_str(), sizeof(record.wifi_password) - 1);
+    strncpy(record.hotspot_ssid, snapshot.hotspot_ssid.c_str(), sizeof(record.hotspot_ssid) - 1);
+    strncpy(record.hotspot_password, snapshot.hotspot_password.c_str(), sizeof(record.hotspot_password) - 1);
+    record.mode = snapshot.mode;
+    memcpy(record.gains, snapshot.gains, sizeof(record.gains));
+    record.gainSchedule = snapshot.gainSchedule;
+    memcpy(record.servo_endpoints, snapshot.servo_endpoints, sizeof(record.servo_endpoints));
+    record.servo_refresh_hz = snapshot.servo_refresh_hz;
+    memcpy(record.servo_calibration, snapshot.servo_calibration, sizeof(record.servo_calibration));
+    memcpy(record.output_filter, snapshot.output_filter, sizeof(record.output_filter));
+    record.estimator = snapshot.estimator;
+    record.imu_calibration = snapshot.imu_calibration;
+    record.yaw_offset = snapshot.yaw_offset;
+    record.pitch_offset = snapshot.pitch_offset;
+    record.roll_offset = snapshot.roll_offset;
+    record.flat_ref_yaw = snapshot.flat_ref_yaw;
+    record.flat_ref_pitch = snapshot.flat_ref_pitch;
+    record.flat_ref_roll = snapshot.flat_ref_roll;
+    record.crc = backupCrc(record);
 
-    serializeJson(doc, file);
+    file = LittleFS.open(_backupTempFilename, "w");
+    if (!file) {
+        LOG_ERROR(LOG_CONFIG_BACKUP_OPEN_FAILED);
+        return false;
+    }
+    written = file.write((const uint8_t*)&record, sizeof(record));
     file.close();
+    if (written != sizeof(record) || !_replaceFile(_backupTempFilename, _backupFilename)) {
+        LOG_ERROR(LOG_CONFIG_BACKUP_WRITE_FAILED);
+        LittleFS.remove(_backupTempFilename);
+        return false;
+    }
     return true;
 }
 
+bool ConfigManager::_replaceFile(const char* tempPath, const char* path) {
+    // littlefs renames over an existing file atomically. Should the VFS layer
+    // refuse, fall back to remove + rename; the other copy (JSON or backup)
+    // covers the short window where this file is missing.
+    if (LittleFS.rename(tempPath, path)) {
+        return true;
+    }
+    LittleFS.remove(path);
+    return LittleFS.rename(tempPath, path);
+}
+
+void ConfigManager::writeGainsJson(const AppConfig& config, JsonObject root) {
+    JsonObject gains = root.createNestedObject("gains");
+    for (int axis = 0; axis < AXIS_COUNT; axis++) {
+        JsonObject g = gains.createNestedObject(AXIS_NAMES[axis]);
+        g["kp"] = config.gains[axis].kp;
+        g["ki"] = config.gains[axis].ki;
+        g["kd"] = config.gains[axis].kd;
+    }
+
+    JsonArray schedule = root.createNestedArray("gain_schedule");
+    for (int i = 0; i < config.gainSchedule.count; i++) {
+        const GainSchedulePoint& p = config.gainSchedule.points[i];
+        JsonObject point = schedule.createNestedObject();
+        point["error"] = p.error;
+        point["kp"] = p.kpScale;
+        point["ki"] = p.kiScale;
+        point["kd"] = p.kdScale;
+    }
+}
+
+void ConfigManager::readGainsJson(JsonObjectConst root, AppConfig& config) {
+    // Legacy single gain set: applies to every axis
+    for (int axis = 0; axis < AXIS_COUNT; axis++) {
+        config.gains[axis].kp = root["kp"] | config.gains[axis].kp;
+        config.gains[axis].ki = root["ki"] | config.gains[axis].ki;
+        config.gains[axis].kd = root["kd"] | config.gains[axis].kd;
+    }
+
+    JsonObjectConst gains = root["gains"];
+    if (!gains.isNull()) {
+        for (int axis = 0; axis < AXIS_COUNT; axis++) {
+            JsonObjectConst g = gains[AXIS_NAMES[axis]];
+            if (g.isNull()) continue;
+            config.gains[axis].kp = g["kp"] | config.gains[axis].kp;
+            config.gains[axis].ki = g["ki"] | config.gains[axis].ki;
+            config.gains[axis].kd = g["kd"] | config.gains[axis].kd;
+        }
+    }
+
+    JsonArrayConst schedule = root["gain_schedule"];
+    if (!schedule.isNull()) {
+        GainSchedule parsed;
+        memset(&parsed, 0, sizeof(parsed));
+        for (JsonObjectConst point : schedule) {
+            if (parsed.count >= GainSchedule::MAX_POINTS) break;
+            GainSchedulePoint& p = parsed.points[parsed.count++];
+            p.error = fabsf(point["error"] | 0.0f);
+            p.kpScale = point["kp"] | 1.0f;
+            p.kiScale = point["ki"] | 1.0f;
+            p.kdScale = point["kd"] | 1.0f;
+        }
+        normalizeSchedule(parsed);
+        config.gainSchedule = parsed;
+    }
+}
+
+void ConfigManager::writeServoJson(const AppConfig& config, JsonObject root) {
+    JsonObject servo = root.createNestedObject("servo");
+    servo["refresh_hz"] = config.servo_refresh_hz;
+    for (int axis = 0; axis < AXIS_COUNT; axis++) {
+        JsonObject e = servo.createNestedObject(AXIS_NAMES[axis]);
+        e["min_us"] = config.servo_endpoints[axis].minUs;
+        e["max_us"] = config.servo_endpoints[axis].maxUs;
+        JsonArray points = e.createNestedArray("calibration");
+        const ServoCalibration& cal = config.servo_calibration[axis];
+        for (int i = 0; i < cal.count; i++) {
+            JsonObject point = points.createNestedObject();
+            point["angle"] = cal.angle[i];
+            point["us"] = cal.pulseUs[i];
+        }
+
+        const OutputFilterConfig& f = config.output_filter[axis];
+        JsonObject filter = e.createNestedObject("filter");
+        filter["lowpass"] = OUTPUT_LOWPASS_NAMES[f.lowpass];
+        filter["cutoff_hz"] = f.lowpassHz;
+        filter["q"] = f.lowpassQ;
+        filter["notch_hz"] = f.notchHz;
+        filter["notch_q"] = f.notchQ;
+        filter["slew_dps"] = f.slewRate;
+    }
+}
+
+void ConfigManager::readServoJson(JsonObjectConst root, AppConfig& config) {
+    JsonObjectConst servo = root["servo"];
+    if (servo.isNull()) {
+        return;
+    }
+
+    int refreshHz = servo["refresh_hz"] | config.servo_refresh_hz;
+    if (validRefreshRate(refreshHz)) {
+        config.servo_refresh_hz = refreshHz;
+    }
+
+    for (int axis = 0; axis < AXIS_COUNT; axis++) {
+        JsonObjectConst e = servo[AXIS_NAMES[axis]];
+        if (e.isNull()) continue;
+        ServoEndpoints endpoints = config.servo_endpoints[axis];
+        endpoints.minUs = e["min_us"] | endpoints.minUs;
+        endpoints.maxUs = e["max_us"] | endpoints.maxUs;
+        if (validEndpoints(endpoints)) {
+            config.servo_endpoints[axis] = endpoints;
+        }
+
+        JsonArrayConst points = e["calibration"];
+        if (!points.isNull() && points.size() <= ServoCalibration::MAX_POINTS) {
+            ServoCalibration cal;
+            cal.count = 0;
+            for (JsonObjectConst point : points) {
+                cal.angle[cal.count] = point["angle"] | -1.0f;
+                cal.pulseUs[cal.count] = point["us"] | 0.0f;
+                cal.count++;
+            }
+            if (validCalibration(cal)) {
+                config.servo_calibration[axis] = cal;
+            }
+        }
+
+        JsonObjectConst f = e["filter"];
+        if (!f.isNull()) {
+            OutputFilterConfig filter = config.output_filter[axis];
+            OutputLowpass lowpass = (OutputLowpass)filter.lowpass;
+            if (f.containsKey("lowpass") && !parseOutputLowpass(f["lowpass"].as<const char*>(), lowpass)) {
+                continue;
+            }
+            filter.lowpass = lowpass;
+            filter.lowpassHz = f["cutoff_hz"] | filter.lowpassHz;
+            filter.lowpassQ = f["q"] | filter.lowpassQ;
+            filter.notchHz = f["notch_hz"] | filter.notchHz;
+            filter.notchQ = f["notch_q"] | filter.notchQ;
+            filter.slewRate = f["slew_dps"] | filter.slewRate;
+            if (validOutputFilter(filter)) {
+                config.output_filter[axis] = filter;
+            }
+        }
+    }
+}
+
+void ConfigManager::writeImuJson(const AppConfig& config, JsonObject root) {
+    const ImuCalibration& cal = config.imu_calibration;
+    JsonObject imu = root.createNestedObject("imu");
+    JsonArray offset = imu.createNestedArray("accel_offset");
+    JsonArray scale = imu.createNestedArray("accel_scale");
+    for (int i = 0; i < 3; i++) {
+        offset.add(cal.accelOffset[i]);
+        scale.add(cal.accelScale[i]);
+    }
+    imu["temp_ref"] = cal.tempRef;
+    imu["temp_min"] = cal.tempMin;
+    imu["temp_max"] = cal.tempMax;
+    JsonArray gyro = imu.createNestedArray("gyro_temp");
+    for (int i = 0; i < 3; i++) {
+        JsonArray c = gyro.createNestedArray();
+        for (int k = 0; k < 3; k++) c.add(cal.gyroTemp[i][k]);
+    }
+}
+
+void ConfigManager::readImuJson(JsonObjectConst root, AppConfig& config) {
+    JsonObjectConst imu = root["imu"];
+    if (imu.isNull()) {
+        return;
+    }
+
+    ImuCalibration cal = config.imu_calibration;
+    JsonArrayConst offset = imu["accel_offset"];
+    JsonArrayConst scale = imu["accel_scale"];
+    JsonArrayConst gyro = imu["gyro_temp"];
+    for (int i = 0; i < 3; i++) {
+        cal.accelOffset[i] = offset[i] | cal.accelOffset[i];
+        cal.accelScale[i] = scale[i] | cal.accelScale[i];
+        for (int k = 0; k < 3; k++) {
+            cal.gyroTemp[i][k] = gyro[i][k] | cal.gyroTemp[i][k];
+        }
+    }
+    cal.tempRef = imu["temp_ref"] | cal.tempRef;
+    cal.tempMin = imu["temp_min"] | cal.tempMin;
+    cal.tempMax = imu["temp_max"] | cal.tempMax;
+    if (validImuCalibration(cal)) {
+        config.imu_calibration = cal;
+    }
+}
+
 AppConfig ConfigManager::getConfig() {
     xSemaphoreTake(_mutex, portMAX_DELAY);
     AppConfig c = config;
@@ -140,6 +627,95 @@ AppConfig ConfigManager::getConfig() {
 void ConfigManager::updateConfig(const AppConfig& newConfig) {
     xSemaphoreTake(_mutex, portMAX_DELAY);
     config = newConfig;
-    _saveConfigInternal();
+    _publishControlParams();
+    _markDirty();
+    xSemaphoreGive(_mutex);
+
+    if (_persistTask) {
+        xTaskNotifyGive(_persistTask);
+    }
+}
+
+ConfigPersistStats ConfigManager::getPersistStats() {
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    ConfigPersistStats stats = _persistStats;
+    stats.pending = _dirty;
     xSemaphoreGive(_mutex);
+    return stats;
+}
+
+void ConfigManager::_markDirty() {
+    uint32_t now = millis();
+    if (!_dirty) {
+        _dirty = true;
+        _dirtySinceMs = now;
+    }
+    _lastChangeMs = now;
+    _persistStats.requested++;
+}
+
+bool ConfigManager::_flushDue(uint32_t now) {
+    if (!_dirty || now - _lastFlushMs < CONFIG_SAVE_MIN_INTERVAL_MS) {
+        return false;
+    }
+    // Coalesce: wait for a slider drag or a burst of requests to settle, but
+    // never sit on a change for longer than CONFIG_SAVE_MAX_DELAY_MS
+    return now - _lastChangeMs >= CONFIG_SAVE_IDLE_MS || now - _dirtySinceMs >= CONFIG_SAVE_MAX_DELAY_MS;
+}
+
+void ConfigManager::persistTaskEntry(void* param) {
+    static_cast<ConfigManager*>(param)->persistLoop();
+}
+
+void ConfigManager::persistLoop() {
+    for (;;) {
+        xSemaphoreTake(_mutex, portMAX_DELAY);
+        bool dirty = _dirty;
+        bool due = _flushDue(millis());
+        xSemaphoreGive(_mutex);
+
+        if (due) {
+            flush();
+            continue;
+        }
+
+        // Sleep until the next change when idle, otherwise re-check the timers
+        ulTaskNotifyTake(pdTRUE, dirty ? pdMS_TO_TICKS(CONFIG_SAVE_POLL_MS) : portMAX_DELAY);
+    }
+}
+
+ControlParams ConfigManager::getControlParams() const {
+    ControlParams copy;
+    // A slot is only rewritten after the pointer has moved past it, so a
+    // copy that overlapped a write retries on the newer, complete slot
+    while (!_controlParams.load(std::memory_order_acquire)->tryRead(copy)) {
+    }
+    return copy;
+}
+
+void ConfigManager::_publishControlParams() {
+    uint32_t version = _controlVersion.load(std::memory_order_relaxed) + 1;
+    ControlParams params;
+    memset(&params, 0, sizeof(params));
+    params.version = version;
+    params.mode = config.mode;
+    memcpy(params.gains, config.gains, sizeof(params.gains));
+    params.gainSchedule = config.gainSchedule;
+    params.estimator = config.estimator;
+    params.imu_calibration = config.imu_calibration;
+    memcpy(params.servo_endpoints, config.servo_endpoints, sizeof(params.servo_endpoints));
+    memcpy(params.servo_calibration, config.servo_calibration, sizeof(params.servo_calibration));
+    memcpy(params.output_filter, config.output_filter, sizeof(params.output_filter));
+    params.servo_refresh_hz = config.servo_refresh_hz;
+    params.yaw_offset = config.yaw_offset;
+    params.pitch_offset = config.pitch_offset;
+    params.roll_offset = config.roll_offset;
+    params.flat_ref_yaw = config.flat_ref_yaw;
+    params.flat_ref_pitch = config.flat_ref_pitch;
+    params.flat_ref_roll = config.flat_ref_roll;
+
+    SeqLock<ControlParams>& slot = _controlSlots[version % CONTROL_PARAM_SLOTS];
+    slot.write(params);
+    _controlParams.store(&slot, std::memory_order_release);
+    _controlVersion.store(version, std::memory_order_release);
 }
@@ -2,7 +2,20 @@
 #include <Arduino.h>
 #include <ArduinoJson.h>
 #include <LittleFS.h>
+#include <atomic>
 #include "config.h"
+#include "../Domain/GainSchedule.h"
+#include "../Domain/ImuCalibration.h"
+#include "../Domain/OutputFilter.h"
+#include "../Domain/SeqLock.h"
+#include "../Domain/ServoCalibration.h"
+
+// Pulse widths a servo needs to reach SERVO_MIN_ANGLE and SERVO_MAX_ANGLE.
+// minUs > maxUs reverses the servo.
+struct ServoEndpoints {
+    float minUs;
+    float maxUs;
+};
 
 struct AppConfig {
     String wifi_ssid;
@@ -10,9 +23,16 @@ struct AppConfig {
     String hotspot_ssid;
     String hotspot_password;
     int mode;
-    float kp;
-    float ki;
-    float kd;
+    PidGains gains[AXIS_COUNT]; // Indexed by GimbalAxis
+    GainSchedule gainSchedule;
+    int estimator; // ESTIMATOR_COMPLEMENTARY or ESTIMATOR_MAHONY
+    ImuCalibration imu_calibration;
+
+    // Servo output
+    ServoEndpoints servo_endpoints[AXIS_COUNT];
+    ServoCalibration servo_calibration[AXIS_COUNT]; // Replaces the endpoints when count > 0
+    OutputFilterConfig output_filter[AXIS_COUNT];
+    int servo_refresh_hz;
 
     // Servo Trims/Offsets
     int yaw_offset;
@@ -25,20 +45,113 @@ struct AppConfig {
     float flat_ref_roll;
 };
 
+// The subset of AppConfig the control loop needs, as a plain POD with no
+// String members. Published immutably by ConfigManager; version increases on
+// every change so readers can skip work when nothing moved.
+struct ControlParams {
+    uint32_t version;
+    int mode;
+    PidGains gains[AXIS_COUNT];
+    GainSchedule gainSchedule;
+    int estimator;
+    ImuCalibration imu_calibration;
+    ServoEndpoints servo_endpoints[AXIS_COUNT];
+    ServoCalibration servo_calibration[AXIS_COUNT];
+    OutputFilterConfig output_filter[AXIS_COUNT];
+    int servo_refresh_hz;
+    int yaw_offset;
+    int pitch_offset;
+    int roll_offset;
+    float flat_ref_yaw;
+    float flat_ref_pitch;
+    float flat_ref_roll;
+};
+
+struct ConfigPersistStats {
+    uint32_t requested;   // updateConfig() calls since boot
+    uint32_t written;     // Flushes to flash; requested - written were coalesced
+    uint32_t failed;
+    uint32_t lastWriteMs; // Duration of the last flush
+    bool pending;         // Changes not yet on flash
+};
+
 class ConfigManager {
 public:
     ConfigManager();
     bool begin();
     bool loadConfig();
-    bool saveConfig();
+    bool saveConfig(); // Synchronous write; everything else goes through the persistence task
+    bool flush();      // Write now if there are unsaved changes
     AppConfig getConfig(); // Return by value
     void resetToDefaults();
+    // Applies immediately in RAM and never touches flash; the persistence task
+    // writes the change once edits settle (CONFIG_SAVE_* in config.h)
     void updateConfig(const AppConfig& newConfig);
+    ConfigPersistStats getPersistStats();
+
+    // PID gains in JSON, shared by config.json and /api/config:
+    //   "gains": {"yaw": {"kp", "ki", "kd"}, "pitch": {...}, "roll": {...}}
+    //   "gain_schedule": [{"error", "kp", "ki", "kd"}, ...] (scale factors; [] = off)
+    // Top-level "kp"/"ki"/"kd" (the pre-per-axis format) are read as values for
+    // every axis; "gains" entries override them.
+    static void writeGainsJson(const AppConfig& config, JsonObject root);
+    static void readGainsJson(JsonObjectConst root, AppConfig& config);
+
+    // Servo output in JSON:
+    //   "servo": {"refresh_hz", "yaw": {"min_us", "max_us", "calibration", "filter"}, "pitch": {...}, "roll": {...}}
+    //   "calibration": [{"angle", "us"}, ...] (ascending angles, monotone pulses; [] = off)
+    //   "filter": {"lowpass": "off"|"first_order"|"biquad", "cutoff_hz", "q", "notch_hz", "notch_q", "slew_dps"}
+    //   (notch_hz and slew_dps 0 = off)
+    // Out-of-range values are ignored and the previous setting is kept.
+    static void writeServoJson(const AppConfig& config, JsonObject root);
+    static void readServoJson(JsonObjectConst root, AppConfig& config);
+
+    // IMU calibration in JSON:
+    //   "imu": {"accel_offset": [x, y, z], "accel_scale": [x, y, z], "temp_ref", "temp_min", "temp_max",
+    //           "gyro_temp": [[c0, c1, c2] x, y, z]}
+    // Rejected as a whole if anything is out of range (see validImuCalibration).
+    static void writeImuJson(const AppConfig& config, JsonObject root);
+    static void readImuJson(JsonObjectConst root, AppConfig& config);
+    // Structurally valid and within the IMU_* limits of config.h
+    static bool validImuCalibration(const ImuCalibration& cal);
+
+    // Lock-free control parameter access for the real-time path. Checking the
+    // version is a single atomic load; copy the params only when it changed.
+    uint32_t getControlVersion() const { return _controlVersion.load(std::memory_order_acquire); }
+    ControlParams getControlParams() const;
 
 private:
     AppConfig config;
     const char* _filename = "/config.json";
-    SemaphoreHandle_t _mutex;
+    const char* _tempFilename = "/config.json.tmp";
+    const char* _backupFilename = "/config.bin"; // CRC-checked binary copy, used if the JSON is unreadable
+    const char* _backupTempFilename = "/config.bin.tmp";
+    SemaphoreHandle_t _mutex;   // Guards config and the dirty state; never held across flash I/O
+    SemaphoreHandle_t _ioMutex; // Serializes writers of the config files
+
+    TaskHandle_t _persistTask;
+    bool _dirty;
+    uint32_t _dirtySinceMs;
+    uint32_t _lastChangeMs;
+    uint32_t _lastFlushMs;
+    ConfigPersistStats _persistStats;
+
+    // Writers fill the next slot and swap the pointer; a slot is only reused
+    // after CONTROL_PARAM_SLOTS - 1 further config changes. Each slot is a
+    // SeqLock, so a reader still copying a slot that is being reused sees the
+    // overlap and retries on the newer slot instead of keeping a torn copy.
+    SeqLock<ControlParams> _controlSlots[CONTROL_PARAM_SLOTS];
+    std::atomic<const SeqLock<ControlParams>*> _controlParams;
+    std::atomic<uint32_t> _controlVersion; // Of the published slot; written under _mutex
+
+    bool _writeFiles(const AppConfig& snapshot); // Call with _ioMutex held
+    bool _readJson(AppConfig& out);
+    bool _readBackup(AppConfig& out);
+    bool _replaceFile(const char* tempPath, const char* path);
+    void _markDirty(); // Call with _mutex held
+    bool _flushDue(uint32_t now); // Call with _mutex held
+    void _publishControlParams(); // Call with _mutex held
 
-    bool _saveConfigInternal(); // Internal helper without lock
+    static void persistTaskEntry(void* param);
+    void persistLoop();
 };
@@ -0,0 +1,266 @@
+#include "ControlTask.h"
+#include "../Domain/EventLog.h"
+
+ControlTask* ControlTask::_instance = nullptr;
+
+ControlTask::ControlTask(ConfigManager& configManager, SensorManager& sensorManager, GimbalController& gimbalController,
+                         PerfMonitor& perfMonitor)
+    : _configManager(configManager),
+      _sensorManager(sensorManager),
+      _gimbalController(gimbalController),
+      _perf(perfMonitor),
+      _taskHandle(nullptr),
+      _timer(nullptr),
+      _rateHz(CONTROL_LOOP_RATE_HZ),
+      _periodUs(1000000 / CONTROL_LOOP_RATE_HZ),
+      _configVersion(0),
+      _cycleCount(0),
+      _overrunCount(0),
+      _lastDt(0)
+{
+    _calMutex = xSemaphoreCreateMutex();
+}
+
+bool ControlTask::begin(uint32_t rateHz) {
+    if (_taskHandle) {
+        return true; // Already running
+    }
+
+    _rateHz = constrain(rateHz, 1, CONTROL_LOOP_MAX_RATE_HZ);
+    _periodUs = 1000000 / _rateHz;
+    _instance = this;
+
+    _estimator.setComplementaryTimeConstant(ESTIMATOR_TAU);
+    _estimator.setMahonyGains(MAHONY_KP, MAHONY_KI);
+    const ImuRestSettings rest = {IMU_REST_WINDOW_S, IMU_REST_GYRO_STD_RAD_S, IMU_REST_ACCEL_STD_MS2,
+                                  IMU_REST_GRAVITY_TOL_MS2, IMU_BOOT_BIAS_WINDOWS, IMU_BOOT_TIMEOUT_S,
+                                  IMU_BIAS_TRACK_TAU_S, IMU_BIAS_MAX_STEP_RAD_S};
+    _imuCorrector.configure(rest, IMU_TEMP_BIN_MIN_C, IMU_TEMP_BIN_WIDTH_C);
+    refreshEstimatorConfig();
+    _perf.begin(_rateHz);
+
+    if (!_recorder.available()) {
+        void* buffer = psramFound() ? ps_malloc(FLIGHT_RECORDER_RECORDS * sizeof(FlightRecord)) : nullptr;
+        if (buffer) {
+            _recorder.begin(static_cast<FlightRecord*>(buffer), FLIGHT_RECORDER_RECORDS);
+            if (FLIGHT_RECORDER_ARM_AT_BOOT) {
+                _recorder.arm(defaultRecorderSettings());
+            }
+            Serial.printf("Flight recorder: %u records in PSRAM (%.0f s)\n", FLIGHT_RECORDER_RECORDS,
+                          (float)FLIGHT_RECORDER_RECORDS / _rateHz);
+        } else {
+            Serial.println("Flight recorder disabled: no PSRAM");
+        }
+    }
+
+    BaseType_t created = xTaskCreatePinnedToCore(
+        taskEntry, "control", CONTROL_TASK_STACK, this,
+        CONTROL_TASK_PRIORITY, &_taskHandle, CONTROL_TASK_CORE);
+
+    if (created != pdPASS) {
+        Serial.println("Failed to create control task");
+        _taskHandle = nullptr;
+        return false;
+    }
+
+    Serial.printf("Control task started: %u Hz on core %d\n", _rateHz, CONTROL_TASK_CORE);
+    return true;
+}
+
+uint32_t ControlTask::getStackHighWaterMark() const {
+    // ESP-IDF counts the stack in bytes
+    return _taskHandle ? uxTaskGetStackHighWaterMark(_taskHandle) : 0;
+}
+
+void ControlTask::taskEntry(void* param) {
+    static_cast<ControlTask*>(param)->run();
+}
+
+void IRAM_ATTR ControlTask::onTimer() {
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    vTaskNotifyGiveFromISR(_instance->_taskHandle, &higherPriorityTaskWoken);
+    if (higherPriorityTaskWoken) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+void ControlTask::run() {
+    _taskHandle = xTaskGetCurrentTaskHandle();
+
+    // Attach the timer from inside the task so its ISR is allocated on the
+    // same core as the control loop. 80 MHz APB / 80 = 1 us per tick.
+    _timer = timerBegin(CONTROL_TIMER_NUM, 80, true);
+    timerAttachInterrupt(_timer, &ControlTask::onTimer, true);
+    timerAlarmWrite(_timer, _periodUs, true);
+    timerAlarmEnable(_timer);
+
+    uint32_t lastUs = micros();
+
+    for (;;) {
+        // Each timer tick gives one notification; more than one pending means
+        // the previous cycle overran its period.
+        uint32_t pending = ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        bool overran = pending > 1;
+        if (overran) {
+            _overrunCount += pending - 1;
+        }
+
+        uint32_t cycleStart = PerfMonitor::now();
+        uint32_t nowUs = micros();
+        uint32_t elapsedUs = nowUs - lastUs;
+        float dt = elapsedUs / 1000000.0f;
+        lastUs = nowUs;
+        if (_cycleCount > 0) {
+            _perf.recordUs(PerfStage::JITTER, elapsedUs > _periodUs ? elapsedUs - _periodUs : _periodUs - elapsedUs);
+        }
+
+        runCycle(dt, nowUs, overran);
+        _perf.recordCycles(PerfStage::CYCLE, cycleStart);
+
+        // Pick up estimator and IMU calibration changes as soon as the config is republished
+        if (_configManager.getControlVersion() != _configVersion) {
+            refreshEstimatorConfig();
+        }
+
+        _lastDt = dt;
+        _cycleCount++;
+    }
+}
+
+void ControlTask::runCycle(float dt, uint32_t nowUs, bool overran) {
+    // Null unless the flight recorder is armed; the stages below fill it in
+    uint32_t recordStart = PerfMonitor::now();
+    FlightRecord* record = _recorder.prepare();
+    if (record) {
+        memset(record, 0, sizeof(*record));
+        record->timeUs = nowUs;
+        record->dtUs = (uint16_t)min(dt * 1e6f + 0.5f, 65535.0f);
+        record->flags = overran ? FLIGHT_FLAG_OVERRUN : 0;
+    }
+    uint32_t recordCycles = PerfMonitor::now() - recordStart;
+
+    // Sense
+    if (_sensorManager.isAvailable()) {
+        uint32_t start = PerfMonitor::now();
+        _sensorManager.update();
+        RawImuFrame frames[MPU6050_RING_SIZE];
+        size_t count = _sensorManager.readFrames(frames, MPU6050_RING_SIZE);
+        _perf.recordCycles(PerfStage::SENSOR, start);
+
+        if (record && count > 0) {
+            const RawImuFrame& newest = frames[count - 1];
+            record->samples = (uint8_t)count;
+            record->accel[0] = newest.accelX;
+            record->accel[1] = newest.accelY;
+            record->accel[2] = newest.accelZ;
+            record->gyro[0] = newest.gyroX;
+            record->gyro[1] = newest.gyroY;
+            record->gyro[2] = newest.gyroZ;
+            record->temperature = toFlightCentis(MPU6050Fifo::tempToC(newest.temp));
+        }
+
+        // Estimate: correct and filter every queued sample at the sensor rate
+        start = PerfMonitor::now();
+        float samplePeriod = _sensorManager.getSamplePeriod();
+        bool windowClosed = false;
+        if (count > 0) {
+            _imuCorrector.beginCycle(MPU6050Fifo::tempToC(frames[count - 1].temp));
+        }
+        for (size_t i = 0; i < count; i++) {
+            ImuSample sample = SensorManager::toImuSample(frames[i]);
+            windowClosed |= _imuCorrector.apply(sample, samplePeriod);
+            _estimator.update(sample, samplePeriod);
+        }
+        if (windowClosed) {
+            _imuStatus.write(_imuCorrector.status());
+        }
+        _perf.recordCycles(PerfStage::ESTIMATE, start);
+    }
+
+    // PID + actuate. Stabilization waits for the boot bias capture, which
+    // would otherwise see the loop's own corrections.
+    uint32_t start = PerfMonitor::now();
+    AttitudeEstimate estimate = _estimator.getEstimate();
+    estimate.valid = estimate.valid && _imuCorrector.settled();
+    _gimbalController.update(dt, estimate, record);
+    _perf.recordCycles(PerfStage::CONTROL, start);
+
+    // Timed as one stage with the slot setup above: backdate the start by it
+    start = PerfMonitor::now();
+    _recorder.commit();
+    _perf.recordCycles(PerfStage::RECORD, start - recordCycles);
+}
+
+FlightRecorderSettings ControlTask::defaultRecorderSettings() const {
+    uint32_t cycles = FLIGHT_RECORDER_SATURATION_MS * _rateHz / 1000;
+    return {FLIGHT_RECORDER_TRIGGERS, FLIGHT_RECORDER_PRE_TRIGGER_PCT,
+            (uint16_t)constrain(cycles, 1u, 65535u), FLIGHT_RECORDER_ERROR_DEG};
+}
+
+void ControlTask::refreshEstimatorConfig() {
+    ControlParams params = _configManager.getControlParams();
+    _configVersion = params.version;
+    int type = params.estimator;
+    _estimator.setType(type == ESTIMATOR_COMPLEMENTARY ? EstimatorType::COMPLEMENTARY : EstimatorType::MAHONY);
+    _imuCorrector.setCalibration(params.imu_calibration);
+}
+
+void ControlTask::startAccelCalibration() {
+    xSemaphoreTake(_calMutex, portMAX_DELAY);
+    _accelCalibration.start();
+    xSemaphoreGive(_calMutex);
+}
+
+CalibrationCapture ControlTask::captureAccelFace() {
+    ImuCorrectorStatus imu = getImuStatus();
+    xSemaphoreTake(_calMutex, portMAX_DELAY);
+    if (!_accelCalibration.active()) {
+        xSemaphoreGive(_calMutex);
+        return CAL_CAPTURE_INACTIVE;
+    }
+    CalibrationCapture result = imu.atRest ? _accelCalibration.capture(imu.restAccel) : CAL_CAPTURE_REJECTED;
+    ImuCalibration cal = _configManager.getConfig().imu_calibration;
+    if (result == CAL_CAPTURE_DONE && (!_accelCalibration.solve(cal) || !ConfigManager::validImuCalibration(cal))) {
+        _accelCalibration.start();
+        result = CAL_CAPTURE_REJECTED;
+    }
+    xSemaphoreGive(_calMutex);
+
+    if (result == CAL_CAPTURE_DONE) {
+        AppConfig config = _configManager.getConfig();
+        memcpy(config.imu_calibration.accelOffset, cal.accelOffset, sizeof(cal.accelOffset));
+        memcpy(config.imu_calibration.accelScale, cal.accelScale, sizeof(cal.accelScale));
+        _configManager.updateConfig(config);
+        LOG_INFO(LOG_ACCEL_CALIBRATION_STORED, cal.accelOffset[0], cal.accelOffset[1], cal.accelOffset[2],
+                 cal.accelScale[0], cal.accelScale[1], cal.accelScale[2]);
+    }
+    return result;
+}
+
+void ControlTask::cancelAccelCalibration() {
+    xSemaphoreTake(_calMutex, portMAX_DELAY);
+    _accelCalibration.cancel();
+    xSemaphoreGive(_calMutex);
+}
+
+AccelCalibrationStatus ControlTask::getAccelCalibrationStatus() {
+    xSemaphoreTake(_calMutex, portMAX_DELAY);
+    AccelCalibrationStatus status = {_accelCalibration.active(), _accelCalibration.captured(),
+                                     _accelCalibration.lastFace()};
+    xSemaphoreGive(_calMutex);
+    return status;
+}
+
+int ControlTask::fitGyroTemperature() {
+    ImuCorrectorStatus imu = getImuStatus();
+    AppConfig config = _configManager.getConfig();
+    ImuCalibration cal = config.imu_calibration;
+    int bins = fitGyroTempPolynomial(imu.table, IMU_TEMP_FIT_MIN_WINDOWS, IMU_TEMP_FIT_MIN_SPAN_C, cal);
+    if (bins == 0 || !ConfigManager::validImuCalibration(cal)) {
+        return 0;
+    }
+    config.imu_calibration = cal;
+    _configManager.updateConfig(config);
+    LOG_INFO(LOG_GYRO_TEMPERATURE_STORED, bins, cal.tempMin, cal.tempMax);
+    return bins;
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <Arduino.h>
+#include "../Domain/GimbalController.h"
+#include "../Domain/AttitudeEstimator.h"
+#include "../Domain/FlightRecorder.h"
+#include "../Domain/ImuCalibration.h"
+#include "../Domain/SeqLock.h"
+#include "ConfigManager.h"
+#include "PerfMonitor.h"
+#include "../Infrastructure/SensorManager.h"
+#include "config.h"
+
+struct AccelCalibrationStatus {
+    bool active;
+    uint8_t captured; // Bit per AccelFace
+    int lastFace;     // -1 before the first capture
+};
+
+// Real-time control loop: sense -> estimate -> PID -> actuate.
+// Runs in its own task pinned to CONTROL_TASK_CORE and is woken by a hardware
+// timer ISR, so WiFi/BLE/web work in loop() cannot add jitter to stabilization.
+class ControlTask {
+public:
+    ControlTask(ConfigManager& configManager, SensorManager& sensorManager, GimbalController& gimbalController,
+                PerfMonitor& perfMonitor);
+    bool begin(uint32_t rateHz = CONTROL_LOOP_RATE_HZ);
+
+    uint32_t getRateHz() const { return _rateHz; }
+    uint32_t getCycleCount() const { return _cycleCount; }
+    uint32_t getOverrunCount() const { return _overrunCount; }
+    float getLastDt() const { return _lastDt; }
+    // Least free stack the task has had, in bytes; 0 before it starts
+    uint32_t getStackHighWaterMark() const;
+
+    // IMU calibration, from any task. The corrector itself runs in the
+    // control task and publishes its state after every rest window.
+    ImuCorrectorStatus getImuStatus() const { return _imuStatus.read(); }
+    void startAccelCalibration();
+    // Takes the newest still window. REJECTED while moving, off a face, or
+    // when the six faces give an out-of-range result (the session restarts).
+    // DONE stores the offsets and scales in config.
+    CalibrationCapture captureAccelFace();
+    void cancelAccelCalibration();
+    AccelCalibrationStatus getAccelCalibrationStatus();
+    // Fits the gyro temperature polynomial to the bins collected at rest and
+    // stores it. Returns the bins used; 0 = not enough temperature range yet.
+    int fitGyroTemperature();
+
+    // Flight recorder fed by the control task every cycle while armed; arm,
+    // trigger, status and downloads from the web task. Unavailable without
+    // PSRAM.
+    FlightRecorder& getFlightRecorder() { return _recorder; }
+    // FLIGHT_RECORDER_* defaults at the current loop rate
+    FlightRecorderSettings defaultRecorderSettings() const;
+
+private:
+    ConfigManager& _configManager;
+    SensorManager& _sensorManager;
+    GimbalController& _gimbalController;
+    PerfMonitor& _perf;
+    AttitudeEstimator _estimator;
+    ImuCorrector _imuCorrector;
+    SeqLock<ImuCorrectorStatus> _imuStatus;
+    AccelCalibrationSession _accelCalibration;
+    SemaphoreHandle_t _calMutex; // Guards _accelCalibration (web requests)
+    FlightRecorder _recorder;
+    TaskHandle_t _taskHandle;
+    hw_timer_t* _timer;
+    uint32_t _rateHz;
+    uint32_t _periodUs;
+    uint32_t _configVersion; // ControlParams version the estimator and IMU calibration were last read from
+
+    volatile uint32_t _cycleCount;
+    volatile uint32_t _overrunCount; // Ticks that arrived while a cycle was still running
+    volatile float _lastDt;
+
+    static ControlTask* _instance; // Timer ISR has no user argument in the Arduino 2.x API
+
+    static void taskEntry(void* param);
+    static void IRAM_ATTR onTimer();
+    void run();
+    void runCycle(float dt, uint32_t nowUs, bool overran);
+    void refreshEstimatorConfig();
+};
@@ -0,0 +1,92 @@
+#include "LogTask.h"
+#include "WebManager.h"
+
+LogTask::LogTask(EventLog& log)
+    : _log(log),
+      _webManager(nullptr),
+      _taskHandle(nullptr),
+      _reportedDropped(0)
+{}
+
+bool LogTask::begin() {
+    if (_taskHandle) {
+        return true; // Already running
+    }
+    BaseType_t created = xTaskCreatePinnedToCore(
+        taskEntry, "log", LOG_TASK_STACK, this,
+        LOG_TASK_PRIORITY, &_taskHandle, LOG_TASK_CORE);
+    if (created != pdPASS) {
+        Serial.println("Failed to create log task");
+        _taskHandle = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void LogTask::setWebManager(WebManager* webManager) {
+    _webManager = webManager;
+}
+
+void LogTask::taskEntry(void* param) {
+    static_cast<LogTask*>(param)->run();
+}
+
+void LogTask::run() {
+    for (;;) {
+        drain();
+        vTaskDelay(pdMS_TO_TICKS(LOG_DRAIN_INTERVAL_MS));
+    }
+}
+
+void LogTask::drain() {
+    File file; // Opened by the first line that goes to flash, closed after the pass
+    LogRecord record;
+    while (_log.read(record)) {
+        emit(record, file);
+    }
+
+    uint32_t dropped = _log.getDroppedCount();
+    if (dropped != _reportedDropped) {
+        record.timeMs = logNowMs();
+        record.message = LOG_DROPPED;
+        record.level = LOG_LEVEL_WARN;
+        record.argCount = 1;
+        record.args[0] = logArg((unsigned)(dropped - _reportedDropped));
+        _reportedDropped = dropped;
+        emit(record, file);
+    }
+
+    if (file) {
+        file.close();
+    }
+}
+
+void LogTask::emit(const LogRecord& record, File& file) {
+    char line[LOG_LINE_LENGTH];
+    size_t len = formatLogLine(record, line, sizeof(line) - 1);
+    line[len++] = '\n';
+
+    Serial.write((const uint8_t*)line, len);
+    if (_webManager) {
+        _webManager->sendLogLine(line, len - 1);
+    }
+    if (record.level >= LOG_FILE_LEVEL) {
+        appendToFile(file, line, len);
+    }
+}
+
+void LogTask::appendToFile(File& file, const char* line, size_t len) {
+    if (!file) {
+        file = LittleFS.open(LOG_FILE_PATH, "a");
+    }
+    if (file && file.size() + len > LOG_FILE_MAX_BYTES) {
+        // Keep one previous file; the oldest lines go
+        file.close();
+        LittleFS.remove(LOG_FILE_OLD_PATH);
+        LittleFS.rename(LOG_FILE_PATH, LOG_FILE_OLD_PATH);
+        file = LittleFS.open(LOG_FILE_PATH, "w");
+    }
+    if (file) {
+        file.write((const uint8_t*)line, len);
+    }
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <Arduino.h>
+#include <LittleFS.h>
+#include "../Domain/EventLog.h"
+#include "config.h"
+
+class WebManager;
+
+// Writes out the EventLog from a low-priority task, so the tasks that log
+// never wait on the UART, flash or network. Every LOG_DRAIN_INTERVAL_MS it
+// formats the queued records and sends each line to Serial and the /ws/log
+// WebSocket, and lines from LOG_FILE_LEVEL up to LOG_FILE_PATH (kept to two
+// files of LOG_FILE_MAX_BYTES). Records dropped on a full ring are reported
+// as a LOG_DROPPED line.
+class LogTask {
+public:
+    explicit LogTask(EventLog& log);
+    // After LittleFS is mounted. Messages logged before are held in the ring
+    // (up to LOG_RING_RECORDS) and written out on the first pass.
+    bool begin();
+    void setWebManager(WebManager* webManager);
+
+private:
+    EventLog& _log;
+    WebManager* _webManager;
+    TaskHandle_t _taskHandle;
+    uint32_t _reportedDropped;
+
+    static void taskEntry(void* param);
+    void run();
+    void drain();
+    void emit(const LogRecord& record, File& file);
+    static void appendToFile(File& file, const char* line, size_t len);
+};
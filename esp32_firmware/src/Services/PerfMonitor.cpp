@@ -0,0 +1,40 @@
+#include "PerfMonitor.h"
+
+PerfMonitor::PerfMonitor()
+    : _cyclesPerUs(240)
+{}
+
+void PerfMonitor::begin(uint32_t controlRateHz) {
+    _cyclesPerUs = getCpuFrequencyMhz();
+    if (_cyclesPerUs == 0) _cyclesPerUs = 1;
+
+    // Jitter and stage budgets are fractions of the control period; the
+    // broadcast has the whole WebSocket interval
+    uint32_t periodUs = 1000000 / controlRateHz;
+    _histograms[(int)PerfStage::JITTER].setDeadline(periodUs * PERF_JITTER_BUDGET_PCT / 100);
+    _histograms[(int)PerfStage::SENSOR].setDeadline(periodUs / 2);
+    _histograms[(int)PerfStage::ESTIMATE].setDeadline(periodUs / 4);
+    _histograms[(int)PerfStage::CONTROL].setDeadline(periodUs / 4);
+    _histograms[(int)PerfStage::RECORD].setDeadline(periodUs / 20);
+    _histograms[(int)PerfStage::CYCLE].setDeadline(periodUs);
+    _histograms[(int)PerfStage::BROADCAST].setDeadline(WEBSOCKET_UPDATE_RATE * 1000UL);
+}
+
+const char* PerfMonitor::stageName(PerfStage stage) {
+    switch (stage) {
+        case PerfStage::JITTER: return "jitter";
+        case PerfStage::SENSOR: return "sensor";
+        case PerfStage::ESTIMATE: return "estimate";
+        case PerfStage::CONTROL: return "control";
+        case PerfStage::RECORD: return "record";
+        case PerfStage::CYCLE: return "cycle";
+        case PerfStage::BROADCAST: return "broadcast";
+        default: return "unknown";
+    }
+}
+
+void PerfMonitor::reset() {
+    for (int i = 0; i < (int)PerfStage::COUNT; i++) {
+        _histograms[i].requestReset();
+    }
+}
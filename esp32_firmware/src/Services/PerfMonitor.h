@@ -0,0 +1,44 @@
+#pragma once
+#include <Arduino.h>
+#include "../Domain/LatencyHistogram.h"
+#include "config.h"
+
+// Stages of the control path that are timed. Each stage has a single writer:
+// everything except BROADCAST is recorded by the control task, BROADCAST by loop().
+enum class PerfStage : uint8_t {
+    JITTER = 0,   // |measured period - nominal period| of each control tick
+    SENSOR,       // FIFO drain + frame copy
+    ESTIMATE,     // Attitude filter over all queued frames
+    CONTROL,      // GimbalController::update (PID + servo write)
+    RECORD,       // Flight recorder slot setup and commit
+    CYCLE,        // Whole control cycle; deadline is the loop period
+    BROADCAST,    // WebManager::broadcastStatus
+    COUNT
+};
+
+// Cycle-counter based timing of the control path, exported via /api/perf and
+// the WebSocket "perf" message.
+class PerfMonitor {
+public:
+    PerfMonitor();
+    void begin(uint32_t controlRateHz);
+
+    // CPU cycle counter of the calling core. Start and stop a measurement on
+    // the same task; both control and loop tasks are pinned to core 1.
+    static inline uint32_t now() { return ESP.getCycleCount(); }
+
+    void recordCycles(PerfStage stage, uint32_t startCycles) {
+        recordUs(stage, (now() - startCycles) / _cyclesPerUs);
+    }
+    void recordUs(PerfStage stage, uint32_t us) {
+        _histograms[(int)stage].record(us);
+    }
+
+    LatencyStats getStats(PerfStage stage) const { return _histograms[(int)stage].getStats(); }
+    static const char* stageName(PerfStage stage);
+    void reset();
+
+private:
+    LatencyHistogram _histograms[(int)PerfStage::COUNT];
+    uint32_t _cyclesPerUs;
+};
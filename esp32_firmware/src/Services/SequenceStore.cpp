@@ -0,0 +1,295 @@
+#include "SequenceStore.h"
+#include "../Domain/EventLog.h"
+#include <esp_rom_crc.h>
+
+// On-flash layout of /sequences.bin, little-endian:
+//   SequenceFileHeader, then `count` records of
+//   SequenceRecordHeader, name (nameLength bytes, no terminator),
+//   SequenceKeyframeRecord[count], uint32 CRC32 of the record bytes before it
+static const uint32_t SEQUENCE_FILE_MAGIC = 0x51455347; // "GSEQ"
+static const uint8_t SEQUENCE_FILE_VERSION = 1;
+
+struct __attribute__((packed)) SequenceFileHeader {
+    uint32_t magic;
+    uint8_t version;
+    uint8_t count;
+};
+
+struct __attribute__((packed)) SequenceRecordHeader {
+    uint8_t shape;
+    uint8_t count;
+    uint8_t nameLength;
+};
+
+struct __attribute__((packed)) SequenceKeyframeRecord {
+    uint16_t timeCs;                    // 10 ms units
+    int16_t positionCdeg[AXIS_COUNT];   // 0.01 deg
+};
+
+static_assert(sizeof(SequenceFileHeader) == 6 && sizeof(SequenceRecordHeader) == 3 &&
+              sizeof(SequenceKeyframeRecord) == 8, "SequenceStore::MAX_FILE_BYTES assumes these sizes");
+
+// Checks a sequence and rounds it to the stored resolution. Times must stay
+// strictly ascending after rounding.
+static bool roundSequence(const MotionSequence& in, MotionSequence& out) {
+    size_t nameLength = strnlen(in.name, sizeof(in.name));
+    if (nameLength == 0 || nameLength > SEQUENCE_NAME_MAX) {
+        return false;
+    }
+    if ((in.shape != TRAJ_SCURVE && in.shape != TRAJ_SPLINE) ||
+        in.count < 1 || in.count > Trajectory::MAX_KEYFRAMES) {
+        return false;
+    }
+
+    memset(&out, 0, sizeof(out));
+    memcpy(out.name, in.name, nameLength);
+    out.shape = in.shape;
+    out.count = in.count;
+    float previous = 0;
+    for (int i = 0; i < in.count; i++) {
+        const TrajectoryKeyframe& k = in.keyframes[i];
+        if (!(k.time > 0 && k.time <= SEQUENCE_MAX_TIME_S)) {
+            return false;
+        }
+        float time = roundf(k.time * 100) / 100.0f;
+        if (!(time > previous)) {
+            return false;
+        }
+        out.keyframes[i].time = previous = time;
+        for (int axis = 0; axis < AXIS_COUNT; axis++) {
+            float p = k.position[axis];
+            if (!(p >= SERVO_MIN_ANGLE && p <= SERVO_MAX_ANGLE)) {
+                return false;
+            }
+            out.keyframes[i].position[axis] = roundf(p * 100) / 100.0f;
+        }
+    }
+    return true;
+}
+
+SequenceStore::SequenceStore(GimbalController& gimbalController)
+    : _gimbalController(gimbalController),
+      _count(0)
+{
+    _mutex = xSemaphoreCreateMutex();
+    _ioMutex = xSemaphoreCreateMutex();
+}
+
+void SequenceStore::begin() {
+    if (LittleFS.exists(_tempFilename)) LittleFS.remove(_tempFilename);
+    xSemaphoreTake(_ioMutex, portMAX_DELAY);
+    bool loaded = load();
+    xSemaphoreGive(_ioMutex);
+    if (loaded) {
+        Serial.printf("Loaded %d motion sequence(s)\n", _count);
+    }
+}
+
+bool SequenceStore::load() {
+    if (!LittleFS.exists(_filename)) {
+        return false;
+    }
+    File file = LittleFS.open(_filename, "r");
+    if (!file) {
+        return false;
+    }
+    size_t size = file.read(_image, sizeof(_image));
+    file.close();
+
+    SequenceFileHeader header;
+    if (size < sizeof(header)) {
+        Serial.println("Sequence file is invalid");
+        return false;
+    }
+    memcpy(&header, _image, sizeof(header));
+    if (header.magic != SEQUENCE_FILE_MAGIC || header.version != SEQUENCE_FILE_VERSION) {
+        Serial.println("Sequence file is invalid");
+        return false;
+    }
+
+    // Keep every record up to the first damaged one
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    _count = 0;
+    size_t pos = sizeof(header);
+    for (int i = 0; i < header.count && _count < SEQUENCE_POOL_SIZE; i++) {
+        SequenceRecordHeader record;
+        if (pos + sizeof(record) > size) break;
+        memcpy(&record, _image + pos, sizeof(record));
+        size_t length = sizeof(record) + record.nameLength + record.count * sizeof(SequenceKeyframeRecord);
+        uint32_t crc;
+        if (pos + length + sizeof(crc) > size) break;
+        memcpy(&crc, _image + pos + length, sizeof(crc));
+        if (crc != esp_rom_crc32_le(0, _image + pos, length)) {
+            Serial.printf("Sequence record %d is corrupt, dropping it and the rest\n", i);
+            break;
+        }
+
+        MotionSequence decoded;
+        memset(&decoded, 0, sizeof(decoded));
+        if (record.nameLength <= SEQUENCE_NAME_MAX && record.count <= Trajectory::MAX_KEYFRAMES) {
+            const uint8_t* p = _image + pos + sizeof(record);
+            memcpy(decoded.name, p, record.nameLength);
+            p += record.nameLength;
+            decoded.shape = (TrajectoryShape)record.shape;
+            decoded.count = record.count;
+            for (int k = 0; k < record.count; k++, p += sizeof(SequenceKeyframeRecord)) {
+                SequenceKeyframeRecord frame;
+                memcpy(&frame, p, sizeof(frame));
+                decoded.keyframes[k].time = frame.timeCs / 100.0f;
+                for (int axis = 0; axis < AXIS_COUNT; axis++) {
+                    decoded.keyframes[k].position[axis] = frame.positionCdeg[axis] / 100.0f;
+                }
+            }
+        }
+        if (!roundSequence(decoded, _pool[_count]) || find(_pool[_count].name) >= 0) {
+            Serial.printf("Sequence record %d is invalid, skipped\n", i);
+        } else {
+            _count++;
+        }
+        pos += length + sizeof(crc);
+    }
+    xSemaphoreGive(_mutex);
+    return true;
+}
+
+size_t SequenceStore::encode() {
+    SequenceFileHeader header = {SEQUENCE_FILE_MAGIC, SEQUENCE_FILE_VERSION, (uint8_t)_count};
+    memcpy(_image, &header, sizeof(header));
+    size_t pos = sizeof(header);
+    for (int i = 0; i < _count; i++) {
+        const MotionSequence& s = _pool[i];
+        size_t start = pos;
+        SequenceRecordHeader record = {(uint8_t)s.shape, s.count, (uint8_t)strlen(s.name)};
+        memcpy(_image + pos, &record, sizeof(record));
+        pos += sizeof(record);
+        memcpy(_image + pos, s.name, record.nameLength);
+        pos += record.nameLength;
+        for (int k = 0; k < s.count; k++) {
+            SequenceKeyframeRecord frame;
+            frame.timeCs = (uint16_t)lroundf(s.keyframes[k].time * 100);
+            for (int axis = 0; axis < AXIS_COUNT; axis++) {
+                frame.positionCdeg[axis] = (int16_t)lroundf(s.keyframes[k].position[axis] * 100);
+            }
+            memcpy(_image + pos, &frame, sizeof(frame));
+            pos += sizeof(frame);
+        }
+        uint32_t crc = esp_rom_crc32_le(0, _image + start, pos - start);
+        memcpy(_image + pos, &crc, sizeof(crc));
+        pos += sizeof(crc);
+    }
+    return pos;
+}
+
+bool SequenceStore::writeImage(size_t size) {
+    File file = LittleFS.open(_tempFilename, "w");
+    if (!file) {
+        LOG_ERROR(LOG_SEQUENCE_OPEN_FAILED);
+        return false;
+    }
+    size_t written = file.write(_image, size);
+    file.close();
+
+    // Same replace as ConfigManager: rename, or remove + rename where the
+    // filesystem refuses to rename over an existing file
+    bool replaced = false;
+    if (written == size) {
+        replaced = LittleFS.rename(_tempFilename, _filename);
+        if (!replaced) {
+            LittleFS.remove(_filename);
+            replaced = LittleFS.rename(_tempFilename, _filename);
+        }
+    }
+    if (!replaced) {
+        LOG_ERROR(LOG_SEQUENCE_WRITE_FAILED);
+        LittleFS.remove(_tempFilename);
+        return false;
+    }
+    return true;
+}
+
+SequenceSaveResult SequenceStore::save(const MotionSequence& sequence) {
+    MotionSequence rounded;
+    if (!roundSequence(sequence, rounded)) {
+        return SEQUENCE_INVALID;
+    }
+
+    xSemaphoreTake(_ioMutex, portMAX_DELAY);
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    int slot = find(rounded.name);
+    if (slot < 0) {
+        if (_count >= SEQUENCE_POOL_SIZE) {
+            xSemaphoreGive(_mutex);
+            xSemaphoreGive(_ioMutex);
+            return SEQUENCE_POOL_FULL;
+        }
+        slot = _count++;
+    }
+    _pool[slot] = rounded;
+    size_t size = encode();
+    xSemaphoreGive(_mutex);
+
+    bool written = writeImage(size);
+    xSemaphoreGive(_ioMutex);
+    return written ? SEQUENCE_SAVED : SEQUENCE_WRITE_FAILED;
+}
+
+SequenceRemoveResult SequenceStore::remove(const char* name) {
+    xSemaphoreTake(_ioMutex, portMAX_DELAY);
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    int slot = find(name);
+    if (slot < 0) {
+        xSemaphoreGive(_mutex);
+        xSemaphoreGive(_ioMutex);
+        return SEQUENCE_NOT_FOUND;
+    }
+    for (int i = slot; i < _count - 1; i++) _pool[i] = _pool[i + 1];
+    _count--;
+    size_t size = encode();
+    xSemaphoreGive(_mutex);
+
+    bool written = writeImage(size);
+    xSemaphoreGive(_ioMutex);
+    return written ? SEQUENCE_REMOVED : SEQUENCE_REMOVE_WRITE_FAILED;
+}
+
+bool SequenceStore::get(const char* name, MotionSequence& out) {
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    int slot = find(name);
+    if (slot >= 0) out = _pool[slot];
+    xSemaphoreGive(_mutex);
+    return slot >= 0;
+}
+
+bool SequenceStore::getAt(int index, MotionSequence& out) {
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    bool found = index >= 0 && index < _count;
+    if (found) out = _pool[index];
+    xSemaphoreGive(_mutex);
+    return found;
+}
+
+int SequenceStore::count() {
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    int n = _count;
+    xSemaphoreGive(_mutex);
+    return n;
+}
+
+bool SequenceStore::play(const char* name, float* plannedDuration) {
+    MotionSequence sequence;
+    if (!get(name, sequence)) {
+        return false;
+    }
+    // Stored sequences were validated on save and load, so planning cannot fail
+    return _gimbalController.startTrajectory(sequence.keyframes, sequence.count, sequence.shape, plannedDuration);
+}
+
+int SequenceStore::find(const char* name) const {
+    if (!name) {
+        return -1;
+    }
+    for (int i = 0; i < _count; i++) {
+        if (strcmp(_pool[i].name, name) == 0) return i;
+    }
+    return -1;
+}
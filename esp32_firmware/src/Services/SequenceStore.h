@@ -0,0 +1,75 @@
+#pragma once
+#include <Arduino.h>
+#include <LittleFS.h>
+#include "config.h"
+#include "../Domain/GimbalController.h"
+#include "../Domain/Trajectory.h"
+
+// A named keyframe trajectory stored on the device. Times are seconds from
+// the start of playback, positions are absolute degrees.
+struct MotionSequence {
+    char name[SEQUENCE_NAME_MAX + 1];
+    TrajectoryShape shape;
+    uint8_t count;
+    TrajectoryKeyframe keyframes[Trajectory::MAX_KEYFRAMES];
+};
+
+enum SequenceSaveResult {
+    SEQUENCE_SAVED,
+    SEQUENCE_INVALID,       // Bad name, count, times or positions
+    SEQUENCE_POOL_FULL,     // New name and all SEQUENCE_POOL_SIZE slots in use
+    SEQUENCE_WRITE_FAILED   // Kept in RAM but not on flash
+};
+
+enum SequenceRemoveResult {
+    SEQUENCE_REMOVED,
+    SEQUENCE_NOT_FOUND,
+    SEQUENCE_REMOVE_WRITE_FAILED // Gone from RAM but still on flash until the next write
+};
+
+// Named motion sequences in a fixed pool of SEQUENCE_POOL_SIZE slots, loaded
+// from /sequences.bin at boot. Playing one copies it into the controller's
+// trajectory, which the control task then runs on its own clock, so only the
+// short play command travels over the network.
+//
+// On flash each sequence is a variable-length record: keyframe times in
+// 10 ms units and positions in 0.01 deg as 16-bit integers, plus a CRC32.
+// Saved keyframes are rounded to that resolution in RAM as well, so the pool
+// always matches the file.
+class SequenceStore {
+public:
+    SequenceStore(GimbalController& gimbalController);
+    void begin(); // After ConfigManager::begin() has mounted LittleFS
+
+    // Adds or replaces by name and rewrites the file (synchronously; saves
+    // are rare, explicit user actions)
+    SequenceSaveResult save(const MotionSequence& sequence);
+    SequenceRemoveResult remove(const char* name);
+    bool get(const char* name, MotionSequence& out);
+    bool getAt(int index, MotionSequence& out); // index < count()
+    int count();
+
+    // Starts the sequence from the current position. False if there is no
+    // sequence by that name.
+    bool play(const char* name, float* plannedDuration = nullptr);
+
+    // File header plus every slot at its largest; layout in SequenceStore.cpp
+    static const size_t MAX_FILE_BYTES =
+        6 + SEQUENCE_POOL_SIZE * (3 + SEQUENCE_NAME_MAX + Trajectory::MAX_KEYFRAMES * 8 + 4);
+
+private:
+    GimbalController& _gimbalController;
+    const char* _filename = "/sequences.bin";
+    const char* _tempFilename = "/sequences.bin.tmp";
+
+    MotionSequence _pool[SEQUENCE_POOL_SIZE]; // Slots 0.._count-1 in use
+    int _count;
+    SemaphoreHandle_t _mutex;   // Guards the pool; never held across flash I/O
+    SemaphoreHandle_t _ioMutex; // Serializes writers of the file and guards _image
+    uint8_t _image[MAX_FILE_BYTES];
+
+    int find(const char* name) const; // Call with _mutex held
+    bool load();
+    size_t encode();                  // Pool into _image; call with both mutexes held
+    bool writeImage(size_t size);     // Call with _ioMutex held
+};
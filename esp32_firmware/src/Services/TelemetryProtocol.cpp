@@ -0,0 +1,56 @@
+#include "TelemetryProtocol.h"
+#include <string.h>
+#include <math.h>
+
+namespace {
+int16_t toFixed(float value, float scale) {
+    float scaled = roundf(value * scale);
+    if (scaled > 32767.0f) return 32767;
+    if (scaled < -32768.0f) return -32768;
+    return (int16_t)scaled;
+}
+
+const size_t BLE_EVENT_MAX_TEXT = 32;
+}
+
+size_t TelemetryEncoder::encodeStatus(const TelemetrySnapshot& snapshot, uint8_t* out) {
+    TelemetryHeader header = {TELEMETRY_MAGIC, TELEMETRY_PROTOCOL_VERSION, TELEMETRY_FRAME_STATUS, 0};
+    memcpy(out, &header, sizeof(header));
+    size_t len = sizeof(header);
+
+    TelemetryStatusV1 status;
+    status.timeMs = snapshot.timeMs;
+    status.seq = _seq++;
+    status.mode = snapshot.mode;
+    status.flags = snapshot.flags;
+    for (int i = 0; i < 3; i++) {
+        status.position[i] = toFixed(snapshot.position[i], TELEMETRY_ANGLE_SCALE);
+        status.accel[i] = toFixed(snapshot.accel[i], TELEMETRY_ACCEL_SCALE);
+        status.gyro[i] = toFixed(snapshot.gyro[i], TELEMETRY_GYRO_SCALE);
+    }
+    memcpy(out + len, &status, sizeof(status));
+    len += sizeof(status);
+
+    if (snapshot.attitudeValid) {
+        int16_t attitude[3];
+        for (int i = 0; i < 3; i++) {
+            attitude[i] = toFixed(snapshot.attitude[i], TELEMETRY_ANGLE_SCALE);
+        }
+        out[len++] = TELEMETRY_SECTION_ATTITUDE;
+        out[len++] = sizeof(attitude);
+        memcpy(out + len, attitude, sizeof(attitude));
+        len += sizeof(attitude);
+    }
+
+    if (snapshot.bleEvent && snapshot.bleEvent[0]) {
+        size_t textLen = strnlen(snapshot.bleEvent, BLE_EVENT_MAX_TEXT);
+        out[len++] = TELEMETRY_SECTION_BLE_EVENT;
+        out[len++] = (uint8_t)(sizeof(uint32_t) + textLen);
+        memcpy(out + len, &snapshot.bleEventAgeMs, sizeof(uint32_t));
+        len += sizeof(uint32_t);
+        memcpy(out + len, snapshot.bleEvent, textLen);
+        len += textLen;
+    }
+
+    return len;
+}
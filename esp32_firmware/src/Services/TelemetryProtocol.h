@@ -0,0 +1,84 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// Compact binary WebSocket telemetry, negotiated with {"cmd":"hello","binary":true}.
+// Pure C++ (no Arduino dependencies) so frames can be produced and checked on the host.
+//
+// Frame layout, all fields little-endian:
+//   TelemetryHeader        4 bytes
+//   TelemetryStatusV1     26 bytes
+//   sections              repeated [uint8 id][uint8 len][len bytes]
+//   padding               zero bytes up to the end of the frame
+// Decoders stop at section id 0 (padding) and skip ids they do not know, so
+// sections can be added without bumping TELEMETRY_PROTOCOL_VERSION. Changing
+// the fixed structs does.
+
+#define TELEMETRY_MAGIC 0x47            // 'G'
+#define TELEMETRY_PROTOCOL_VERSION 1
+#define TELEMETRY_FRAME_STATUS 1
+
+// TelemetryStatusV1::flags
+#define TELEMETRY_FLAG_SENSOR_AVAILABLE 0x01
+#define TELEMETRY_FLAG_BT_CONNECTED     0x02
+#define TELEMETRY_FLAG_BT_ADVERTISING   0x04
+
+// Optional section ids (0 marks the start of padding)
+#define TELEMETRY_SECTION_END       0
+#define TELEMETRY_SECTION_ATTITUDE  1   // int16 roll, pitch, yaw in 0.01 deg
+#define TELEMETRY_SECTION_BLE_EVENT 2   // uint32 age_ms, then the event text (not terminated)
+
+// Fixed-point scales
+#define TELEMETRY_ANGLE_SCALE 100.0f    // 0.01 deg
+#define TELEMETRY_ACCEL_SCALE 100.0f    // 0.01 m/s^2
+#define TELEMETRY_GYRO_SCALE 1000.0f    // 0.001 rad/s
+
+#define TELEMETRY_MAX_FRAME 96
+
+// The ESP32 and every browser platform are little-endian, so the structs are
+// copied as-is.
+struct __attribute__((packed)) TelemetryHeader {
+    uint8_t magic;
+    uint8_t version;
+    uint8_t type;
+    uint8_t reserved;
+};
+
+struct __attribute__((packed)) TelemetryStatusV1 {
+    uint32_t timeMs;
+    uint16_t seq;
+    uint8_t mode;
+    uint8_t flags;
+    int16_t position[3];  // yaw, pitch, roll
+    int16_t accel[3];     // x, y, z
+    int16_t gyro[3];      // x, y, z
+};
+
+static_assert(sizeof(TelemetryHeader) == 4, "TelemetryHeader must be 4 bytes");
+static_assert(sizeof(TelemetryStatusV1) == 26, "TelemetryStatusV1 must be 26 bytes");
+
+// Values to encode, in engineering units
+struct TelemetrySnapshot {
+    uint32_t timeMs;
+    uint8_t mode;
+    uint8_t flags;
+    float position[3];
+    float accel[3];
+    float gyro[3];
+    bool attitudeValid;
+    float attitude[3];     // roll, pitch, yaw
+    const char* bleEvent;  // nullptr or empty to omit
+    uint32_t bleEventAgeMs;
+};
+
+class TelemetryEncoder {
+public:
+    TelemetryEncoder() : _seq(0) {}
+
+    // Writes one status frame into out (at least TELEMETRY_MAX_FRAME bytes)
+    // and returns its length.
+    size_t encodeStatus(const TelemetrySnapshot& snapshot, uint8_t* out);
+
+private:
+    uint16_t _seq;
+};
@@ -1,14 +1,61 @@
 #include "WebManager.h"
 #include "BluetoothManager.h"
+#include <esp_heap_caps.h>
+#include "../Domain/EventLog.h"
 
-WebManager::WebManager(ConfigManager& configManager, GimbalController& gimbalController, SensorManager& sensorManager)
+// Reads up to Trajectory::MAX_KEYFRAMES {"t", "yaw", "pitch", "roll"}
+// keyframes. An axis left out holds the previous keyframe's value, or
+// `start` for the first keyframe; with no `start` the first keyframe must
+// give every axis. Returns the count, or 0 if the array is empty, too long or
+// incomplete. Times are checked later by the planner or the store.
+static int readKeyframes(JsonArrayConst frames, const float* start, TrajectoryKeyframe* out) {
+    if (frames.isNull() || frames.size() == 0 || frames.size() > Trajectory::MAX_KEYFRAMES) {
+        return 0;
+    }
+    float previous[AXIS_COUNT] = {};
+    int count = 0;
+    for (JsonObjectConst frame : frames) {
+        TrajectoryKeyframe& k = out[count];
+        k.time = frame["t"] | 0.0f;
+        for (int axis = 0; axis < AXIS_COUNT; axis++) {
+            JsonVariantConst value = frame[AXIS_NAMES[axis]];
+            if (count == 0 && !start && !value.is<float>()) {
+                return 0;
+            }
+            float position = count == 0 && !value.is<float>() ? start[axis] : (value | previous[axis]);
+            k.position[axis] = constrain(position, SERVO_MIN_ANGLE, SERVO_MAX_ANGLE);
+            previous[axis] = k.position[axis];
+        }
+        count++;
+    }
+    return count;
+}
+
+static TrajectoryShape readShape(JsonVariantConst shape) {
+    return strcmp(shape | "spline", "scurve") == 0 ? TRAJ_SCURVE : TRAJ_SPLINE;
+}
+
+WebManager::WebManager(ConfigManager& configManager, GimbalController& gimbalController, SensorManager& sensorManager,
+                       PerfMonitor& perfMonitor, SequenceStore& sequenceStore, ControlTask& controlTask)
     : _configManager(configManager),
       _gimbalController(gimbalController),
       _sensorManager(sensorManager),
+      _perf(perfMonitor),
+      _sequenceStore(sequenceStore),
+      _controlTask(controlTask),
       _bluetoothManager(nullptr),
       _server(HTTP_PORT),
-      _ws("/ws")
-{}
+      _ws("/ws"),
+      _logWs("/ws/log"),
+      _clients(),
+      _lastSlowSectionMs(0),
+      _lastBroadcastHeap(0),
+      _logLinesSkipped(0),
+      _kernelBenchState(KERNEL_BENCH_IDLE),
+      _kernelBenchIterations(0)
+{
+    _clientsMutex = xSemaphoreCreateMutex();
+}
 
 void WebManager::begin() {
     // ⚠️ SECURITY ISSUE: WebSocket has no authentication. See KnownIssues.MD #ISSUE-005
@@ -17,6 +64,9 @@ void WebManager::begin() {
         this->onWebSocketEvent(server, client, type, arg, data, len);
     });
     _server.addHandler(&_ws);
+    // Log lines only; anything a client sends is ignored
+    _server.addHandler(&_logWs);
+    _bufferPool.begin();
 
     // Serve static files
     _server.serveStatic("/", LittleFS, "/").setDefaultFile("index.html");
@@ -24,16 +74,17 @@ void WebManager::begin() {
     // API Endpoints
     _server.on("/api/config", HTTP_GET, [this](AsyncWebServerRequest *request) {
         AppConfig config = _configManager.getConfig();
-        StaticJsonDocument<1024> doc;
+        StaticJsonDocument<CONFIG_JSON_CAPACITY> doc;
         doc["wifi_ssid"] = config.wifi_ssid;
         // doc["wifi_password"] = config.wifi_password; // Security risk to send back password
         doc["hotspot_ssid"] = config.hotspot_ssid;
         // Do not expose hotspot password; instead, indicate whether a password is set
         doc["hotspot_password_set"] = !config.hotspot_password.isEmpty();
         doc["mode"] = config.mode;
-        doc["kp"] = config.kp;
-        doc["ki"] = config.ki;
-        doc["kd"] = config.kd;
+        ConfigManager::writeGainsJson(config, doc.as<JsonObject>());
+        ConfigManager::writeServoJson(config, doc.as<JsonObject>());
+        doc["estimator"] = config.estimator;
+        ConfigManager::writeImuJson(config, doc.as<JsonObject>());
         doc["yaw_offset"] = config.yaw_offset;
         doc["pitch_offset"] = config.pitch_offset;
         doc["roll_offset"] = config.roll_offset;
@@ -54,7 +105,7 @@ void WebManager::begin() {
                 return;
             }
 
-            StaticJsonDocument<1024> doc;
+            StaticJsonDocument<CONFIG_JSON_CAPACITY> doc;
             DeserializationError error = deserializeJson(doc, data, len);
             if (error) {
                 request->send(400, "application/json", "{\"error\":\"Invalid JSON\"}");
@@ -67,9 +118,17 @@ void WebManager::begin() {
             if(doc.containsKey("hotspot_ssid")) config.hotspot_ssid = doc["hotspot_ssid"].as<String>();
             if(doc.containsKey("hotspot_password")) config.hotspot_password = doc["hotspot_password"].as<String>();
 
-            if(doc.containsKey("kp")) config.kp = doc["kp"];
-            if(doc.containsKey("ki")) config.ki = doc["ki"];
-            if(doc.containsKey("kd")) config.kd = doc["kd"];
+            // Per-axis "gains", "gain_schedule", or legacy kp/ki/kd for all axes
+            ConfigManager::readGainsJson(doc.as<JsonObjectConst>(), config);
+            ConfigManager::readServoJson(doc.as<JsonObjectConst>(), config);
+            if(doc.containsKey("estimator")) {
+                int estimator = doc["estimator"];
+                if (estimator == ESTIMATOR_COMPLEMENTARY || estimator == ESTIMATOR_MAHONY) {
+                    config.estimator = estimator;
+                }
+            }
+
+            ConfigManager::readImuJson(doc.as<JsonObjectConst>(), config);
 
             if(doc.containsKey("yaw_offset")) config.yaw_offset = doc["yaw_offset"];
             if(doc.containsKey("pitch_offset")) config.pitch_offset = doc["pitch_offset"];
@@ -100,36 +159,861 @@ void WebManager::begin() {
         request->send(200, "application/json", response);
     });
     
+    // Control kernel microbenchmark. POST starts it in the background, GET
+    // reports progress and the result. Registered before /api/perf, whose
+    // handler would otherwise also match this URL as a sub-path.
+    _server.on("/api/perf/kernel", HTTP_POST, [this](AsyncWebServerRequest *request) {
+        if (_kernelBenchState.load(std::memory_order_acquire) == KERNEL_BENCH_RUNNING) {
+            request->send(409, "application/json", "{\"error\":\"Benchmark already running\"}");
+            return;
+        }
+        uint32_t iterations = KERNEL_BENCH_ITERATIONS;
+        if (request->hasParam("iterations")) {
+            iterations = constrain(request->getParam("iterations")->value().toInt(), 100, KERNEL_BENCH_MAX_ITERATIONS);
+        }
+        if (!startKernelBenchmark(iterations)) {
+            request->send(500, "application/json", "{\"error\":\"Failed to start benchmark task\"}");
+            return;
+        }
+        sendKernelBenchStatus(request, 202);
+    });
+
+    _server.on("/api/perf/kernel", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        sendKernelBenchStatus(request, 200);
+    });
+
+    // Control-path latency histograms
+    _server.on("/api/perf", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        StaticJsonDocument<3072> doc;
+        fillPerf(doc.to<JsonObject>());
+
+        String response;
+        serializeJson(doc, response);
+        request->send(200, "application/json", response);
+    });
+
+    _server.on("/api/perf/reset", HTTP_POST, [this](AsyncWebServerRequest *request) {
+        _perf.reset();
+        request->send(200, "application/json", "{\"status\":\"ok\"}");
+    });
+
     // Set Flat Reference Endpoint
     _server.on("/api/set-flat-reference", HTTP_POST, [this](AsyncWebServerRequest *request) {
         _gimbalController.setFlatReference();
         request->send(200, "application/json", "{\"status\":\"ok\",\"message\":\"Flat reference set to current position\"}");
     });
     
-    // Run Self Test Endpoint
+    // Self-test. It runs in the control task; poll GET for progress and the
+    // result. /cancel is registered first because the /api/self-test
+    // handlers would also match it.
+    _server.on("/api/self-test/cancel", HTTP_POST, [this](AsyncWebServerRequest *request) {
+        _gimbalController.cancelSelfTest();
+        sendSelfTestStatus(request);
+    });
+
     _server.on("/api/self-test", HTTP_POST, [this](AsyncWebServerRequest *request) {
-        _gimbalController.runSelfTest();
-        request->send(200, "application/json", "{\"status\":\"ok\",\"message\":\"Self-test started - check serial console for results\"}");
+        StaticJsonDocument<96> doc;
+        doc["status"] = "ok";
+        doc["duration_s"] = _gimbalController.startSelfTest();
+        String response;
+        serializeJson(doc, response);
+        request->send(200, "application/json", response);
+    });
+
+    _server.on("/api/self-test", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        sendSelfTestStatus(request);
+    });
+
+    // Keyframe trajectories. /stop is registered first because the
+    // /api/trajectory handlers would also match it.
+    _server.on("/api/trajectory/stop", HTTP_POST, [this](AsyncWebServerRequest *request) {
+        _gimbalController.stopMove();
+        request->send(200, "application/json", "{\"status\":\"ok\"}");
+    });
+
+    _server.on("/api/trajectory", HTTP_POST, [](AsyncWebServerRequest *request){}, NULL,
+        [this](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+            if (index != 0 || len != total) {
+                request->send(400, "application/json", "{\"error\":\"Request body must be sent in a single chunk\"}");
+                return;
+            }
+            StaticJsonDocument<TRAJECTORY_JSON_CAPACITY> doc;
+            if (deserializeJson(doc, data, len)) {
+                request->send(400, "application/json", "{\"error\":\"Invalid JSON\"}");
+                return;
+            }
+
+            // Axes left out of the first keyframe hold the current position
+            TrajectoryKeyframe keyframes[Trajectory::MAX_KEYFRAMES];
+            GimbalPosition current = _gimbalController.getCurrentPosition();
+            float start[AXIS_COUNT] = {current.yaw, current.pitch, current.roll};
+            int count = readKeyframes(doc["keyframes"], start, keyframes);
+            if (count == 0) {
+                request->send(400, "application/json", "{\"error\":\"keyframes must hold 1-16 entries\"}");
+                return;
+            }
+            TrajectoryShape shape = readShape(doc["shape"]);
+            float duration = 0;
+            if (!_gimbalController.startTrajectory(keyframes, count, shape, &duration)) {
+                request->send(400, "application/json", "{\"error\":\"Keyframe times must be positive and ascending\"}");
+                return;
+            }
+
+            StaticJsonDocument<128> response;
+            response["status"] = "ok";
+            response["duration_s"] = duration;
+            response["slowed"] = duration > keyframes[count - 1].time * 1.0001f;
+            String body;
+            serializeJson(response, body);
+            request->send(200, "application/json", body);
+    });
+
+    _server.on("/api/trajectory", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        GimbalState state = _gimbalController.getState();
+        StaticJsonDocument<128> doc;
+        doc["active"] = state.moveActive;
+        doc["progress"] = state.moveProgress;
+        doc["duration_s"] = state.moveDuration;
+
+        String response;
+        serializeJson(doc, response);
+        request->send(200, "application/json", response);
+    });
+
+    // Stored motion sequences. /play is registered first because the
+    // /api/sequences handlers would also match it.
+    _server.on("/api/sequences/play", HTTP_POST, [](AsyncWebServerRequest *request){}, NULL,
+        [this](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+            StaticJsonDocument<128> doc;
+            if (index != 0 || len != total || deserializeJson(doc, data, len)) {
+                request->send(400, "application/json", "{\"error\":\"Invalid JSON\"}");
+                return;
+            }
+            float duration = 0;
+            if (!_sequenceStore.play(doc["name"].as<const char*>(), &duration)) {
+                request->send(404, "application/json", "{\"error\":\"No sequence with that name\"}");
+                return;
+            }
+
+            StaticJsonDocument<96> response;
+            response["status"] = "ok";
+            response["duration_s"] = duration;
+            String body;
+            serializeJson(response, body);
+            request->send(200, "application/json", body);
+    });
+
+    _server.on("/api/sequences", HTTP_POST, [](AsyncWebServerRequest *request){}, NULL,
+        [this](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+            if (index != 0 || len != total) {
+                request->send(400, "application/json", "{\"error\":\"Request body must be sent in a single chunk\"}");
+                return;
+            }
+            StaticJsonDocument<TRAJECTORY_JSON_CAPACITY> doc;
+            if (deserializeJson(doc, data, len)) {
+                request->send(400, "application/json", "{\"error\":\"Invalid JSON\"}");
+                return;
+            }
+
+            const char* name = doc["name"] | "";
+            size_t nameLength = strlen(name);
+            if (nameLength == 0 || nameLength > SEQUENCE_NAME_MAX) {
+                request->send(400, "application/json", "{\"error\":\"name must be 1-15 characters\"}");
+                return;
+            }
+            // Playback starts wherever the gimbal is, so the first keyframe
+            // has to give every axis
+            MotionSequence sequence;
+            strlcpy(sequence.name, name, sizeof(sequence.name));
+            sequence.shape = readShape(doc["shape"]);
+            sequence.count = readKeyframes(doc["keyframes"], nullptr, sequence.keyframes);
+            if (sequence.count == 0) {
+                request->send(400, "application/json",
+                              "{\"error\":\"keyframes must hold 1-16 entries and the first must set yaw, pitch and roll\"}");
+                return;
+            }
+
+            switch (_sequenceStore.save(sequence)) {
+                case SEQUENCE_SAVED:
+                    request->send(200, "application/json", "{\"status\":\"ok\"}");
+                    break;
+                case SEQUENCE_POOL_FULL:
+                    request->send(507, "application/json", "{\"error\":\"All sequence slots are in use\"}");
+                    break;
+                case SEQUENCE_WRITE_FAILED:
+                    request->send(500, "application/json", "{\"error\":\"Saved until reboot only: writing flash failed\"}");
+                    break;
+                default:
+                    request->send(400, "application/json",
+                                  "{\"error\":\"Keyframe times must be positive, ascending and at most 655 s\"}");
+                    break;
+            }
+    });
+
+    _server.on("/api/sequences", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        // ?name= returns one sequence with its keyframes, otherwise a summary of all
+        if (request->hasParam("name")) {
+            MotionSequence sequence;
+            if (!_sequenceStore.get(request->getParam("name")->value().c_str(), sequence)) {
+                request->send(404, "application/json", "{\"error\":\"No sequence with that name\"}");
+                return;
+            }
+            StaticJsonDocument<TRAJECTORY_JSON_CAPACITY> doc;
+            doc["name"] = sequence.name;
+            doc["shape"] = sequence.shape == TRAJ_SCURVE ? "scurve" : "spline";
+            JsonArray frames = doc.createNestedArray("keyframes");
+            for (int i = 0; i < sequence.count; i++) {
+                JsonObject frame = frames.createNestedObject();
+                frame["t"] = sequence.keyframes[i].time;
+                for (int axis = 0; axis < AXIS_COUNT; axis++) {
+                    frame[AXIS_NAMES[axis]] = sequence.keyframes[i].position[axis];
+                }
+            }
+            String response;
+            serializeJson(doc, response);
+            request->send(200, "application/json", response);
+            return;
+        }
+
+        StaticJsonDocument<1024> doc;
+        JsonArray list = doc.createNestedArray("sequences");
+        MotionSequence sequence;
+        for (int i = 0; _sequenceStore.getAt(i, sequence); i++) {
+            JsonObject entry = list.createNestedObject();
+            entry["name"] = sequence.name;
+            entry["shape"] = sequence.shape == TRAJ_SCURVE ? "scurve" : "spline";
+            entry["keyframes"] = sequence.count;
+            entry["duration_s"] = sequence.keyframes[sequence.count - 1].time;
+        }
+        doc["free"] = SEQUENCE_POOL_SIZE - list.size();
+
+        String response;
+        serializeJson(doc, response);
+        request->send(200, "application/json", response);
+    });
+
+    _server.on("/api/sequences", HTTP_DELETE, [this](AsyncWebServerRequest *request) {
+        if (!request->hasParam("name")) {
+            request->send(404, "application/json", "{\"error\":\"No sequence with that name\"}");
+            return;
+        }
+        switch (_sequenceStore.remove(request->getParam("name")->value().c_str())) {
+            case SEQUENCE_REMOVED:
+                request->send(200, "application/json", "{\"status\":\"ok\"}");
+                break;
+            case SEQUENCE_REMOVE_WRITE_FAILED:
+                request->send(500, "application/json", "{\"error\":\"Removed until reboot only: writing flash failed\"}");
+                break;
+            default:
+                request->send(404, "application/json", "{\"error\":\"No sequence with that name\"}");
+                break;
+        }
+    });
+
+    // Guided servo calibration. The sub-paths are registered first because
+    // the /api/calibration/servo handler would also match them.
+    _server.on("/api/calibration/servo/start", HTTP_POST, [](AsyncWebServerRequest *request){}, NULL,
+        [this](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+            StaticJsonDocument<128> doc;
+            GimbalAxis axis;
+            if (index != 0 || len != total || deserializeJson(doc, data, len) ||
+                !parseAxisName(doc["axis"].as<const char*>(), axis)) {
+                request->send(400, "application/json", "{\"error\":\"axis must be yaw, pitch or roll\"}");
+                return;
+            }
+            if (!_gimbalController.startServoCalibration(axis)) {
+                request->send(409, "application/json", "{\"error\":\"Calibration needs manual mode\"}");
+                return;
+            }
+            sendCalibrationStatus(request, "started");
+    });
+
+    _server.on("/api/calibration/servo/jog", HTTP_POST, [](AsyncWebServerRequest *request){}, NULL,
+        [this](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+            StaticJsonDocument<128> doc;
+            if (index != 0 || len != total || deserializeJson(doc, data, len)) {
+                request->send(400, "application/json", "{\"error\":\"Invalid JSON\"}");
+                return;
+            }
+            // Absolute "pulse_us" or relative "delta_us"
+            float current = _gimbalController.getServoCalibrationStatus().pulseUs;
+            float pulse = doc["pulse_us"] | (current + (doc["delta_us"] | 0.0f));
+            if (!_gimbalController.jogServoCalibration(pulse)) {
+                request->send(409, "application/json", "{\"error\":\"No calibration running\"}");
+                return;
+            }
+            sendCalibrationStatus(request, nullptr);
+    });
+
+    _server.on("/api/calibration/servo/capture", HTTP_POST, [this](AsyncWebServerRequest *request) {
+        switch (_gimbalController.captureServoCalibrationPoint()) {
+            case CAL_CAPTURE_NEXT:
+                sendCalibrationStatus(request, "captured");
+                break;
+            case CAL_CAPTURE_DONE:
+                sendCalibrationStatus(request, "saved");
+                break;
+            case CAL_CAPTURE_REJECTED:
+                request->send(409, "application/json",
+                              "{\"error\":\"Pulse must keep moving in the same direction as the previous points\"}");
+                break;
+            default:
+                request->send(409, "application/json", "{\"error\":\"No calibration running\"}");
+                break;
+        }
+    });
+
+    _server.on("/api/calibration/servo/cancel", HTTP_POST, [this](AsyncWebServerRequest *request) {
+        _gimbalController.cancelServoCalibration();
+        sendCalibrationStatus(request, "cancelled");
+    });
+
+    _server.on("/api/calibration/servo", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        sendCalibrationStatus(request, nullptr);
+    });
+
+    // IMU calibration. The sub-paths are registered first because the
+    // /api/calibration/imu handler would also match them.
+    _server.on("/api/calibration/imu/accel/start", HTTP_POST, [this](AsyncWebServerRequest *request) {
+        _controlTask.startAccelCalibration();
+        sendImuStatus(request, "started");
+    });
+
+    _server.on("/api/calibration/imu/accel/capture", HTTP_POST, [this](AsyncWebServerRequest *request) {
+        if (_controlTask.getAccelCalibrationStatus().active && !_controlTask.getImuStatus().atRest) {
+            request->send(409, "application/json", "{\"error\":\"Hold the unit still on one face\"}");
+            return;
+        }
+        switch (_controlTask.captureAccelFace()) {
+            case CAL_CAPTURE_NEXT:
+                sendImuStatus(request, "captured");
+                break;
+            case CAL_CAPTURE_DONE:
+                sendImuStatus(request, "saved");
+                break;
+            case CAL_CAPTURE_REJECTED:
+                request->send(409, "application/json",
+                              "{\"error\":\"No axis is vertical, or the faces gave an out-of-range result (restarted)\"}");
+                break;
+            default:
+                request->send(409, "application/json", "{\"error\":\"No calibration running\"}");
+                break;
+        }
+    });
+
+    _server.on("/api/calibration/imu/accel/cancel", HTTP_POST, [this](AsyncWebServerRequest *request) {
+        _controlTask.cancelAccelCalibration();
+        sendImuStatus(request, "cancelled");
+    });
+
+    _server.on("/api/calibration/imu/temperature", HTTP_POST, [this](AsyncWebServerRequest *request) {
+        if (_controlTask.fitGyroTemperature() == 0) {
+            request->send(409, "application/json",
+                          "{\"error\":\"Not enough temperature range collected at rest yet\"}");
+            return;
+        }
+        sendImuStatus(request, "saved");
+    });
+
+    _server.on("/api/calibration/imu", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        sendImuStatus(request, nullptr);
+    });
+
+    // Relay autotune. The sub-paths are registered first because the
+    // /api/autotune handlers would also match them.
+    _server.on("/api/autotune/accept", HTTP_POST, [](AsyncWebServerRequest *request){}, NULL,
+        [this](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+            StaticJsonDocument<96> doc;
+            AutotuneRule rule = AUTOTUNE_DEFAULT_RULE;
+            if (index != 0 || len != total || deserializeJson(doc, data, len) ||
+                (doc.containsKey("rule") && !parseAutotuneRule(doc["rule"].as<const char*>(), rule))) {
+                request->send(400, "application/json", "{\"error\":\"Unknown rule\"}");
+                return;
+            }
+            int accepted = _gimbalController.acceptAutotune(rule);
+            if (accepted == 0) {
+                request->send(409, "application/json", "{\"error\":\"No axis has finished tuning\"}");
+                return;
+            }
+
+            StaticJsonDocument<96> response;
+            response["status"] = "ok";
+            response["rule"] = AUTOTUNE_RULE_NAMES[rule];
+            response["accepted"] = accepted;
+            String body;
+            serializeJson(response, body);
+            request->send(200, "application/json", body);
+    });
+
+    _server.on("/api/autotune/cancel", HTTP_POST, [this](AsyncWebServerRequest *request) {
+        _gimbalController.cancelAutotune();
+        sendAutotuneStatus(request, AUTOTUNE_DEFAULT_RULE);
+    });
+
+    _server.on("/api/autotune", HTTP_POST, [](AsyncWebServerRequest *request){}, NULL,
+        [this](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+            StaticJsonDocument<128> doc;
+            if (index != 0 || len != total || deserializeJson(doc, data, len)) {
+                request->send(400, "application/json", "{\"error\":\"Invalid JSON\"}");
+                return;
+            }
+            // Without "axes" every axis is tuned
+            bool axes[AXIS_COUNT] = {true, true, true};
+            JsonArrayConst list = doc["axes"];
+            if (!list.isNull()) {
+                for (int i = 0; i < AXIS_COUNT; i++) axes[i] = false;
+                for (JsonVariantConst name : list) {
+                    GimbalAxis axis;
+                    if (!parseAxisName(name.as<const char*>(), axis)) {
+                        request->send(400, "application/json", "{\"error\":\"axes must hold yaw, pitch or roll\"}");
+                        return;
+                    }
+                    axes[axis] = true;
+                }
+            }
+            if (!_gimbalController.startAutotune(axes)) {
+                request->send(409, "application/json",
+                              "{\"error\":\"Autotune needs auto mode, an attitude estimate and at least one axis\"}");
+                return;
+            }
+            sendAutotuneStatus(request, AUTOTUNE_DEFAULT_RULE);
+    });
+
+    _server.on("/api/autotune", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        AutotuneRule rule = AUTOTUNE_DEFAULT_RULE;
+        if (request->hasParam("rule")) {
+            parseAutotuneRule(request->getParam("rule")->value().c_str(), rule);
+        }
+        sendAutotuneStatus(request, rule);
+    });
+
+    // Flight recorder. Requests are applied by the control task within a
+    // cycle, so the status returned may still show the previous state.
+    _server.on("/api/recorder/arm", HTTP_POST, [](AsyncWebServerRequest *request){}, NULL,
+        [this](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+            FlightRecorder& recorder = _controlTask.getFlightRecorder();
+            if (!recorder.available()) {
+                request->send(503, "application/json", "{\"error\":\"Flight recorder needs PSRAM\"}");
+                return;
+            }
+            StaticJsonDocument<256> doc;
+            if (index != 0 || len != total || deserializeJson(doc, data, len)) {
+                request->send(400, "application/json", "{\"error\":\"Invalid JSON\"}");
+                return;
+            }
+            // Omitted fields keep the FLIGHT_RECORDER_* defaults
+            FlightRecorderSettings settings = _controlTask.defaultRecorderSettings();
+            JsonArrayConst triggers = doc["triggers"];
+            if (!triggers.isNull()) {
+                settings.triggers = 0;
+                for (JsonVariantConst name : triggers) {
+                    FlightTrigger trigger;
+                    if (!parseFlightTrigger(name.as<const char*>(), trigger)) {
+                        request->send(400, "application/json",
+                                      "{\"error\":\"triggers must hold manual, error or saturation\"}");
+                        return;
+                    }
+                    settings.triggers |= 1 << trigger;
+                }
+            }
+            int pre = doc["pre_trigger_pct"] | (int)settings.preTriggerPct;
+            float errorDeg = doc["error_deg"] | settings.errorDeg;
+            int saturationMs = doc["saturation_ms"] | FLIGHT_RECORDER_SATURATION_MS;
+            if (pre < 0 || pre > 100 || !(errorDeg > 0) || saturationMs < 1 || saturationMs > 10000) {
+                request->send(400, "application/json",
+                              "{\"error\":\"pre_trigger_pct 0-100, error_deg > 0, saturation_ms 1-10000\"}");
+                return;
+            }
+            settings.preTriggerPct = pre;
+            settings.errorDeg = errorDeg;
+            settings.saturationCycles = max(1, (int)(saturationMs * _controlTask.getRateHz() / 1000));
+            recorder.arm(settings);
+            sendRecorderStatus(request, "armed");
+    });
+
+    _server.on("/api/recorder/trigger", HTTP_POST, [this](AsyncWebServerRequest *request) {
+        if (_controlTask.getFlightRecorder().status().state != FLIGHT_ARMED) {
+            request->send(409, "application/json", "{\"error\":\"Recorder is not armed\"}");
+            return;
+        }
+        _controlTask.getFlightRecorder().trigger();
+        sendRecorderStatus(request, "triggered");
+    });
+
+    _server.on("/api/recorder/disarm", HTTP_POST, [this](AsyncWebServerRequest *request) {
+        _controlTask.getFlightRecorder().disarm();
+        sendRecorderStatus(request, "disarmed");
+    });
+
+    // Header, then the records oldest first, copied from PSRAM a few at a
+    // time as the TCP window allows. Re-arming during the download ends it
+    // early; the decoder notices the short file.
+    _server.on("/api/recorder/download", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        FlightRecorder& recorder = _controlTask.getFlightRecorder();
+        FlightRecorderStatus status = recorder.status();
+        if (status.state != FLIGHT_CAPTURED) {
+            request->send(409, "application/json", "{\"error\":\"No capture to download\"}");
+            return;
+        }
+        FlightCaptureHeader header = makeFlightCaptureHeader(status, _controlTask.getRateHz(),
+                                                             MPU6050Fifo::ACCEL_LSB_PER_G,
+                                                             MPU6050Fifo::GYRO_LSB_PER_DPS);
+        const uint32_t generation = status.generation;
+        const size_t totalBytes = sizeof(header) + (size_t)header.count * sizeof(FlightRecord);
+
+        AsyncWebServerResponse* response = request->beginChunkedResponse("application/octet-stream",
+            [&recorder, header, generation, totalBytes](uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+                size_t filled = 0;
+                if (index < sizeof(header)) {
+                    filled = min(maxLen, sizeof(header) - index);
+                    memcpy(buffer, reinterpret_cast<const uint8_t*>(&header) + index, filled);
+                }
+                FlightRecord chunk[FLIGHT_RECORDER_CHUNK_RECORDS];
+                while (filled < maxLen && index + filled < totalBytes) {
+                    size_t offset = index + filled - sizeof(header);
+                    size_t first = offset / sizeof(FlightRecord);
+                    size_t skip = offset % sizeof(FlightRecord);
+                    size_t wanted = (maxLen - filled + skip + sizeof(FlightRecord) - 1) / sizeof(FlightRecord);
+                    size_t n = recorder.read(generation, first, chunk, min(wanted, (size_t)FLIGHT_RECORDER_CHUNK_RECORDS));
+                    if (n == 0) {
+                        break; // Re-armed: end the download here
+                    }
+                    size_t bytes = min(n * sizeof(FlightRecord) - skip, maxLen - filled);
+                    memcpy(buffer + filled, reinterpret_cast<const uint8_t*>(chunk) + skip, bytes);
+                    filled += bytes;
+                }
+                return filled;
+            });
+        response->addHeader("Content-Disposition", "attachment; filename=\"flight.gfr\"");
+        request->send(response);
+    });
+
+    _server.on("/api/recorder", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        sendRecorderStatus(request, nullptr);
     });
 
     _server.begin();
 }
 
+void WebManager::sendRecorderStatus(AsyncWebServerRequest* request, const char* result) {
+    FlightRecorderStatus status = _controlTask.getFlightRecorder().status();
+    uint32_t rateHz = _controlTask.getRateHz();
+    StaticJsonDocument<512> doc;
+    if (result) doc["result"] = result;
+    doc["available"] = status.capacity > 0;
+    doc["state"] = FLIGHT_STATE_NAMES[status.state];
+    doc["capacity"] = status.capacity;
+    doc["count"] = status.count;
+    doc["seconds"] = (float)status.count / rateHz;
+    doc["rate_hz"] = rateHz;
+    doc["generation"] = status.generation;
+    if (status.state == FLIGHT_TRIGGERED || status.state == FLIGHT_CAPTURED) {
+        doc["cause"] = FLIGHT_TRIGGER_NAMES[status.cause];
+    }
+    if (status.state == FLIGHT_CAPTURED) {
+        doc["trigger_index"] = status.triggerIndex;
+    }
+    JsonArray triggers = doc.createNestedArray("triggers");
+    for (int i = 0; i < FLIGHT_TRIGGER_COUNT; i++) {
+        if (status.settings.triggers & (1 << i)) triggers.add(FLIGHT_TRIGGER_NAMES[i]);
+    }
+    doc["pre_trigger_pct"] = status.settings.preTriggerPct;
+    doc["error_deg"] = status.settings.errorDeg;
+    doc["saturation_ms"] = status.settings.saturationCycles * 1000 / rateHz;
+
+    String response;
+    serializeJson(doc, response);
+    request->send(200, "application/json", response);
+}
+
+void WebManager::sendCalibrationStatus(AsyncWebServerRequest* request, const char* result) {
+    ServoCalibrationStatus status = _gimbalController.getServoCalibrationStatus();
+    StaticJsonDocument<768> doc;
+    if (result) doc["result"] = result;
+    doc["active"] = status.active;
+    doc["axis"] = AXIS_NAMES[status.axis];
+    doc["points"] = status.points;
+    doc["target_angle"] = status.targetAngle;
+    doc["pulse_us"] = status.pulseUs;
+    JsonArray captured = doc.createNestedArray("captured");
+    for (int i = 0; i < status.captured.count; i++) {
+        JsonObject point = captured.createNestedObject();
+        point["angle"] = status.captured.angle[i];
+        point["us"] = status.captured.pulseUs[i];
+    }
+
+    String response;
+    serializeJson(doc, response);
+    request->send(200, "application/json", response);
+}
+
+void WebManager::sendSelfTestStatus(AsyncWebServerRequest* request) {
+    SelfTestStatus status = _gimbalController.getSelfTestStatus();
+    StaticJsonDocument<1024> doc;
+    doc["active"] = status.active;
+    doc["phase"] = SELF_TEST_PHASE_NAMES[status.phase];
+    doc["axis"] = AXIS_NAMES[status.axis];
+    doc["progress"] = status.progress;
+    doc["duration_s"] = status.duration;
+    doc["complete"] = status.result.complete;
+    JsonObject axes = doc.createNestedObject("axes");
+    for (int i = 0; i < AXIS_COUNT; i++) {
+        const AxisStepResult& r = status.result.axes[i];
+        if (!r.tested) continue;
+        JsonObject axis = axes.createNestedObject(AXIS_NAMES[i]);
+        axis["measured"] = r.measured;
+        axis["responded"] = r.responded;
+        // Timings only mean something once the camera has actually moved
+        if (r.responded) {
+            axis["gain"] = r.gain;
+            axis["rise_s"] = r.riseTime;
+            axis["settling_s"] = r.settlingTime;
+            axis["overshoot_pct"] = r.overshootPct;
+        } else if (r.measured) {
+            axis["gain"] = r.gain;
+        }
+    }
+
+    String response;
+    serializeJson(doc, response);
+    request->send(200, "application/json", response);
+}
+
+static const char* const KERNEL_BENCH_STATE_NAMES[] = {"idle", "running", "done"};
+
+bool WebManager::startKernelBenchmark(uint32_t iterations) {
+    ControlParams params = _configManager.getControlParams();
+    memcpy(_kernelBenchGains, params.gains, sizeof(_kernelBenchGains));
+    _kernelBenchShaping = _gimbalController.getPidShaping();
+    _kernelBenchIterations = iterations;
+    _kernelBenchState.store(KERNEL_BENCH_RUNNING, std::memory_order_release);
+
+    BaseType_t created = xTaskCreatePinnedToCore(
+        kernelBenchEntry, "kernelbench", KERNEL_BENCH_TASK_STACK, this,
+        KERNEL_BENCH_TASK_PRIORITY, nullptr, KERNEL_BENCH_TASK_CORE);
+    if (created != pdPASS) {
+        _kernelBenchState.store(KERNEL_BENCH_IDLE, std::memory_order_release);
+        return false;
+    }
+    return true;
+}
+
+void WebManager::kernelBenchEntry(void* param) {
+    WebManager* self = static_cast<WebManager*>(param);
+    self->_kernelBenchResult = runKernelBenchmark(self->_kernelBenchShaping, self->_kernelBenchGains,
+                                                  1.0f / CONTROL_LOOP_RATE_HZ, self->_kernelBenchIterations,
+                                                  []() -> uint32_t { return PerfMonitor::now(); });
+    self->_kernelBenchState.store(KERNEL_BENCH_DONE, std::memory_order_release);
+    vTaskDelete(nullptr);
+}
+
+void WebManager::sendKernelBenchStatus(AsyncWebServerRequest* request, int code) {
+    uint8_t state = _kernelBenchState.load(std::memory_order_acquire);
+    StaticJsonDocument<256> doc;
+    doc["state"] = KERNEL_BENCH_STATE_NAMES[state];
+    doc["iterations"] = _kernelBenchIterations;
+    if (state == KERNEL_BENCH_DONE) {
+        const KernelBenchmarkResult& r = _kernelBenchResult;
+        uint32_t mhz = getCpuFrequencyMhz();
+        doc["scalar_cycles"] = r.scalarTicks;
+        doc["kernel_cycles"] = r.kernelTicks;
+        doc["scalar_us"] = r.scalarTicks / mhz;
+        doc["kernel_us"] = r.kernelTicks / mhz;
+        doc["speedup"] = r.kernelTicks > 0 ? r.scalarTicks / r.kernelTicks : 0;
+        doc["max_difference_deg"] = r.maxDifference;
+    }
+
+    String response;
+    serializeJson(doc, response);
+    request->send(code, "application/json", response);
+}
+
+void WebManager::sendAutotuneStatus(AsyncWebServerRequest* request, AutotuneRule rule) {
+    AutotuneStatus status = _gimbalController.getAutotuneStatus();
+    StaticJsonDocument<1024> doc;
+    doc["active"] = status.active;
+    doc["axis"] = AXIS_NAMES[status.axis];
+    doc["testing"] = status.testing;
+    doc["rule"] = AUTOTUNE_RULE_NAMES[rule];
+    JsonObject axes = doc.createNestedObject("axes");
+    for (int i = 0; i < AXIS_COUNT; i++) {
+        const AxisAutotuneResult& r = status.axes[i];
+        JsonObject axis = axes.createNestedObject(AXIS_NAMES[i]);
+        axis["status"] = AUTOTUNE_STATUS_NAMES[r.status];
+        axis["cycles"] = r.cycles;
+        JsonObject current = axis.createNestedObject("current");
+        current["kp"] = status.current[i].kp;
+        current["ki"] = status.current[i].ki;
+        current["kd"] = status.current[i].kd;
+        if (r.status != AUTOTUNE_DONE) continue;
+        axis["ku"] = r.ku;
+        axis["tu"] = r.tu;
+        axis["amplitude_deg"] = r.amplitude;
+        PidGains gains = tuneFromRelay(r.ku, r.tu, rule);
+        JsonObject proposed = axis.createNestedObject("proposed");
+        proposed["kp"] = gains.kp;
+        proposed["ki"] = gains.ki;
+        proposed["kd"] = gains.kd;
+    }
+
+    String response;
+    serializeJson(doc, response);
+    request->send(200, "application/json", response);
+}
+
+void WebManager::sendImuStatus(AsyncWebServerRequest* request, const char* result) {
+    ImuCorrectorStatus imu = _controlTask.getImuStatus();
+    AccelCalibrationStatus accel = _controlTask.getAccelCalibrationStatus();
+    StaticJsonDocument<3072> doc;
+    if (result) doc["result"] = result;
+    doc["settled"] = imu.settled;
+    doc["bias_locked"] = imu.biasLocked;
+    doc["at_rest"] = imu.atRest;
+    doc["rest_windows"] = imu.restWindows;
+    doc["windows"] = imu.windows;
+    doc["temperature_c"] = imu.temperature;
+    JsonArray bias = doc.createNestedArray("gyro_bias");
+    JsonArray residual = doc.createNestedArray("gyro_residual");
+    JsonArray restAccel = doc.createNestedArray("rest_accel");
+    for (int i = 0; i < 3; i++) {
+        bias.add(imu.bias[i]);
+        residual.add(imu.residual[i]);
+        restAccel.add(imu.restAccel[i]);
+    }
+
+    JsonObject session = doc.createNestedObject("accel");
+    session["active"] = accel.active;
+    if (accel.lastFace >= 0) session["last_face"] = ACCEL_FACE_NAMES[accel.lastFace];
+    JsonArray faces = session.createNestedArray("captured");
+    for (int f = 0; f < ACCEL_FACE_COUNT; f++) {
+        if (accel.captured & (1 << f)) faces.add(ACCEL_FACE_NAMES[f]);
+    }
+
+    JsonArray bins = doc.createNestedArray("temp_bins");
+    for (int b = 0; b < ImuTempTable::BINS; b++) {
+        const ImuTempBin& bin = imu.table.bin[b];
+        if (bin.windows == 0) continue;
+        JsonObject entry = bins.createNestedObject();
+        entry["temp_c"] = bin.temp;
+        entry["windows"] = bin.windows;
+        JsonArray gyro = entry.createNestedArray("gyro");
+        for (int i = 0; i < 3; i++) gyro.add(bin.bias[i]);
+    }
+
+    String response;
+    serializeJson(doc, response);
+    request->send(200, "application/json", response);
+}
+
 void WebManager::setBluetoothManager(BluetoothManager* bluetoothManager) {
     _bluetoothManager = bluetoothManager;
 }
 
 void WebManager::handle() {
     _ws.cleanupClients();
+    _logWs.cleanupClients();
+}
+
+void WebManager::sendLogLine(const char* line, size_t len) {
+    if (_logWs.count() == 0) {
+        return;
+    }
+    // Drop the line rather than queue behind a slow client
+    if (!_logWs.availableForWriteAll()) {
+        _logLinesSkipped++;
+        return;
+    }
+    _logWs.textAll(line, len);
 }
 
 void WebManager::onWebSocketEvent(AsyncWebSocket *server, AsyncWebSocketClient *client, AwsEventType type, void *arg, uint8_t *data, size_t len) {
-    if (type == WS_EVT_DATA) {
-        handleWebSocketMessage(arg, data, len);
+    if (type == WS_EVT_CONNECT) {
+        if (!addClient(client->id())) {
+            client->close();
+        }
+    } else if (type == WS_EVT_DISCONNECT) {
+        removeClient(client->id());
+    } else if (type == WS_EVT_DATA) {
+        handleWebSocketMessage(client, arg, data, len);
+    }
+}
+
+bool WebManager::addClient(uint32_t id) {
+    bool added = false;
+    xSemaphoreTake(_clientsMutex, portMAX_DELAY);
+    for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+        if (_clients[i].id == 0) {
+            WsClient& c = _clients[i];
+            c = WsClient();
+            c.id = id;
+            c.binary = false;
+            c.fields = WS_FIELD_ALL;
+            c.requestedIntervalMs = WEBSOCKET_UPDATE_RATE;
+            c.intervalMs = WEBSOCKET_UPDATE_RATE;
+            added = true;
+            break;
+        }
+    }
+    xSemaphoreGive(_clientsMutex);
+    return added;
+}
+
+void WebManager::removeClient(uint32_t id) {
+    xSemaphoreTake(_clientsMutex, portMAX_DELAY);
+    for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+        if (_clients[i].id == id) {
+            _clients[i].id = 0;
+        }
     }
+    xSemaphoreGive(_clientsMutex);
 }
 
-void WebManager::handleWebSocketMessage(void *arg, uint8_t *data, size_t len) {
+uint8_t WebManager::parseFields(JsonVariant fields) {
+    if (!fields.is<JsonArray>()) {
+        return WS_FIELD_ALL;
+    }
+
+    uint8_t mask = 0;
+    for (JsonVariant field : fields.as<JsonArray>()) {
+        const char* name = field.as<const char*>();
+        if (!name) continue;
+        if (strcmp(name, "position") == 0) mask |= WS_FIELD_POSITION;
+        else if (strcmp(name, "attitude") == 0) mask |= WS_FIELD_ATTITUDE;
+        else if (strcmp(name, "sensors") == 0) mask |= WS_FIELD_SENSORS;
+        else if (strcmp(name, "hardware") == 0) mask |= WS_FIELD_HARDWARE;
+    }
+    return mask;
+}
+
+void WebManager::handleHello(AsyncWebSocketClient *client, JsonDocument& doc) {
+    bool binary = doc["binary"] | false;
+    int maxRate = binary ? TELEMETRY_MAX_RATE_HZ : WS_JSON_MAX_RATE_HZ;
+    int rateHz = doc["rate"] | (binary ? TELEMETRY_DEFAULT_RATE_HZ : 1000 / WEBSOCKET_UPDATE_RATE);
+    rateHz = constrain(rateHz, 1, maxRate);
+    uint8_t fields = parseFields(doc["fields"]);
+
+    xSemaphoreTake(_clientsMutex, portMAX_DELAY);
+    for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+        WsClient& c = _clients[i];
+        if (c.id == client->id()) {
+            c.binary = binary;
+            c.fields = fields;
+            c.requestedIntervalMs = 1000 / rateHz;
+            c.intervalMs = c.requestedIntervalMs;
+            c.skipStreak = 0;
+            c.sendStreak = 0;
+        }
+    }
+    xSemaphoreGive(_clientsMutex);
+
+    // Acknowledge so the client knows which format to expect
+    char reply[112];
+    snprintf(reply, sizeof(reply), "{\"type\":\"hello\",\"protocol\":%d,\"binary\":%s,\"rate\":%d,\"fields\":%u}",
+             TELEMETRY_PROTOCOL_VERSION, binary ? "true" : "false", rateHz, fields);
+    client->text(reply);
+}
+
+void WebManager::handleWebSocketMessage(AsyncWebSocketClient *client, void *arg, uint8_t *data, size_t len) {
     // ⚠️ SECURITY ISSUE: No input validation. See KnownIssues.MD #ISSUE-006
     // ⚠️ SECURITY ISSUE: No rate limiting. See KnownIssues.MD #ISSUE-007
     // TODO: Add input validation and rate limiting
@@ -149,7 +1033,9 @@ void WebManager::handleWebSocketMessage(void *arg, uint8_t *data, size_t len) {
         }
 
         const char* cmd = cmdVar.as<const char*>();
-        if (strcmp(cmd, "setPosition") == 0) {
+        if (strcmp(cmd, "hello") == 0 || strcmp(cmd, "subscribe") == 0) {
+            handleHello(client, doc);
+        } else if (strcmp(cmd, "setPosition") == 0) {
             if (doc.containsKey("yaw") && doc.containsKey("pitch") && doc.containsKey("roll")) {
                 _gimbalController.setManualPosition(doc["yaw"], doc["pitch"], doc["roll"]);
             }
@@ -166,6 +1052,11 @@ void WebManager::handleWebSocketMessage(void *arg, uint8_t *data, size_t len) {
                 endPos.roll = doc["endRoll"];
                 _gimbalController.startTimedMove(doc["duration"], endPos);
             }
+        } else if (strcmp(cmd, "play") == 0) {
+            // Stored sequence; timing comes from the control task, not from further messages
+            _sequenceStore.play(doc["name"].as<const char*>());
+        } else if (strcmp(cmd, "stopMove") == 0) {
+            _gimbalController.stopMove();
         } else if (strcmp(cmd, "setAutoTarget") == 0) {
             if (doc.containsKey("yaw") && doc.containsKey("pitch") && doc.containsKey("roll")) {
                 _gimbalController.setAutoTarget(doc["yaw"], doc["pitch"], doc["roll"]);
@@ -175,7 +1066,7 @@ void WebManager::handleWebSocketMessage(void *arg, uint8_t *data, size_t len) {
         } else if (strcmp(cmd, "setFlatReference") == 0) {
             _gimbalController.setFlatReference();
         } else if (strcmp(cmd, "runSelfTest") == 0) {
-            _gimbalController.runSelfTest();
+            _gimbalController.startSelfTest();
         } else if (strcmp(cmd, "setPhoneGyro") == 0) {
             // Handle phone gyroscope rate data (rad/s)
             if (doc.containsKey("gx") && doc.containsKey("gy") && doc.containsKey("gz")) {
@@ -217,30 +1108,322 @@ void WebManager::handleWebSocketMessage(void *arg, uint8_t *data, size_t len) {
     }
 }
 
-void WebManager::broadcastStatus() {
-    StaticJsonDocument<1024> doc;
-    GimbalPosition pos = _gimbalController.getCurrentPosition();
+int WebManager::collectDueClients(bool binary, uint32_t now, DueClient* out) {
+    int count = 0;
+    xSemaphoreTake(_clientsMutex, portMAX_DELAY);
+    for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+        WsClient& c = _clients[i];
+        if (c.id != 0 && c.binary == binary && now - c.lastSentMs >= c.intervalMs) {
+            c.lastSentMs = now;
+            out[count++] = {c.id, c.fields, false, false};
+        }
+    }
+    xSemaphoreGive(_clientsMutex);
+    return count;
+}
+
+bool WebManager::clientCanTake(AsyncWebSocketClient* client, size_t len) {
+    if (client->status() != WS_CONNECTED || client->queueIsFull()) {
+        return false;
+    }
+
+    // If the TCP send buffer cannot take this frame now, it would sit in the
+    // client's queue behind older frames and be stale by the time it arrives
+    AsyncClient* tcp = client->client();
+    return tcp && tcp->space() >= len + WS_FRAME_OVERHEAD;
+}
+
+void WebManager::deliver(AsyncWebSocketMessageBuffer* buffer, bool binary, DueClient* due, int count, uint8_t fields) {
+    for (int i = 0; i < count; i++) {
+        if (due[i].fields != fields) continue;
+        due[i].handled = true;
+        if (!buffer) continue; // Pool exhausted; not this client's fault, so no back-off
+
+        AsyncWebSocketClient* client = _ws.client(due[i].id);
+        if (!client || !clientCanTake(client, buffer->length())) {
+            continue;
+        }
+
+        // One buffer per client queue; see WsBufferPool for why they are not shared
+        AsyncWebSocketMessageBuffer* own = _bufferPool.acquireFor(buffer);
+        if (!own) continue;
+        if (binary) {
+            client->binary(own);
+        } else {
+            client->text(own);
+        }
+        due[i].sent = true;
+    }
+}
+
+void WebManager::updateClientRates(const DueClient* due, int count) {
+    xSemaphoreTake(_clientsMutex, portMAX_DELAY);
+    for (int i = 0; i < count; i++) {
+        for (int j = 0; j < WS_MAX_CLIENTS; j++) {
+            WsClient& c = _clients[j];
+            if (c.id != due[i].id) continue;
+
+            if (due[i].sent) {
+                c.sent++;
+                c.skipStreak = 0;
+                // Ease back towards the requested rate once the link keeps up
+                if (c.intervalMs > c.requestedIntervalMs && ++c.sendStreak >= WS_RECOVER_SENDS) {
+                    c.intervalMs = max(c.requestedIntervalMs, c.intervalMs / 2);
+                    c.sendStreak = 0;
+                }
+            } else {
+                c.skipped++;
+                c.sendStreak = 0;
+                // Halve the rate for a client that keeps falling behind
+                if (++c.skipStreak >= WS_BACKOFF_SKIPS) {
+                    c.intervalMs = min((uint32_t)WS_MAX_INTERVAL_MS, c.intervalMs * 2);
+                    c.skipStreak = 0;
+                }
+            }
+        }
+    }
+    xSemaphoreGive(_clientsMutex);
+}
+
+TelemetrySnapshot WebManager::captureSnapshot(uint32_t now) {
+    GimbalState state = _gimbalController.getState();
+    const GimbalPosition& pos = state.position;
+    const AttitudeEstimate& attitude = state.attitude;
     SensorData sensors = _sensorManager.getData();
 
-    doc["mode"] = _gimbalController.getMode();
-    doc["position"]["yaw"] = pos.yaw;
-    doc["position"]["pitch"] = pos.pitch;
-    doc["position"]["roll"] = pos.roll;
-
-    doc["sensors"]["accel"]["x"] = sensors.accelX;
-    doc["sensors"]["accel"]["y"] = sensors.accelY;
-    doc["sensors"]["accel"]["z"] = sensors.accelZ;
-    doc["sensors"]["gyro"]["x"] = sensors.gyroX;
-    doc["sensors"]["gyro"]["y"] = sensors.gyroY;
-    doc["sensors"]["gyro"]["z"] = sensors.gyroZ;
-    
-    doc["hardware"]["sensor_available"] = _sensorManager.isAvailable();
-    doc["hardware"]["bluetooth_connected"] = _bluetoothManager ? _bluetoothManager->isConnected() : false;
-    doc["hardware"]["bluetooth_advertising"] = _bluetoothManager ? _bluetoothManager->isAdvertising() : false;
-    doc["hardware"]["bluetooth_last_event"] = _bluetoothManager ? _bluetoothManager->getLastEvent() : "";
-    doc["hardware"]["bluetooth_last_event_age_ms"] = _bluetoothManager ? _bluetoothManager->getLastEventAgeMs() : 0;
-
-    String output;
-    serializeJson(doc, output);
-    _ws.textAll(output);
+    TelemetrySnapshot snapshot;
+    snapshot.timeMs = now;
+    snapshot.mode = (uint8_t)state.mode;
+    snapshot.flags = 0;
+    if (_sensorManager.isAvailable()) snapshot.flags |= TELEMETRY_FLAG_SENSOR_AVAILABLE;
+    if (_bluetoothManager && _bluetoothManager->isConnected()) snapshot.flags |= TELEMETRY_FLAG_BT_CONNECTED;
+    if (_bluetoothManager && _bluetoothManager->isAdvertising()) snapshot.flags |= TELEMETRY_FLAG_BT_ADVERTISING;
+    snapshot.position[0] = pos.yaw;
+    snapshot.position[1] = pos.pitch;
+    snapshot.position[2] = pos.roll;
+    snapshot.accel[0] = sensors.accelX;
+    snapshot.accel[1] = sensors.accelY;
+    snapshot.accel[2] = sensors.accelZ;
+    snapshot.gyro[0] = sensors.gyroX;
+    snapshot.gyro[1] = sensors.gyroY;
+    snapshot.gyro[2] = sensors.gyroZ;
+    snapshot.attitudeValid = attitude.valid;
+    snapshot.attitude[0] = attitude.roll;
+    snapshot.attitude[1] = attitude.pitch;
+    snapshot.attitude[2] = attitude.yaw;
+    snapshot.bleEvent = _bluetoothManager ? _bluetoothManager->getLastEvent() : "";
+    snapshot.bleEventAgeMs = _bluetoothManager ? _bluetoothManager->getLastEventAgeMs() : 0;
+    return snapshot;
+}
+
+void WebManager::broadcastStatus() {
+    uint32_t now = millis();
+    DueClient due[WS_MAX_CLIENTS];
+    int dueCount = collectDueClients(false, now, due);
+    if (dueCount == 0) {
+        return;
+    }
+
+    uint32_t start = PerfMonitor::now();
+    size_t freeBefore = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    TelemetrySnapshot snapshot = captureSnapshot(now);
+
+    // Serialize once per distinct field set, for every client that asked for it
+    for (int i = 0; i < dueCount; i++) {
+        if (due[i].handled) continue;
+        uint8_t fields = due[i].fields;
+
+        StaticJsonDocument<1024> doc;
+        doc["mode"] = snapshot.mode;
+
+        if (fields & WS_FIELD_POSITION) {
+            doc["position"]["yaw"] = snapshot.position[0];
+            doc["position"]["pitch"] = snapshot.position[1];
+            doc["position"]["roll"] = snapshot.position[2];
+        }
+
+        if ((fields & WS_FIELD_ATTITUDE) && snapshot.attitudeValid) {
+            doc["attitude"]["roll"] = snapshot.attitude[0];
+            doc["attitude"]["pitch"] = snapshot.attitude[1];
+            doc["attitude"]["yaw"] = snapshot.attitude[2];
+        }
+
+        if (fields & WS_FIELD_SENSORS) {
+            doc["sensors"]["accel"]["x"] = snapshot.accel[0];
+            doc["sensors"]["accel"]["y"] = snapshot.accel[1];
+            doc["sensors"]["accel"]["z"] = snapshot.accel[2];
+            doc["sensors"]["gyro"]["x"] = snapshot.gyro[0];
+            doc["sensors"]["gyro"]["y"] = snapshot.gyro[1];
+            doc["sensors"]["gyro"]["z"] = snapshot.gyro[2];
+        }
+
+        if (fields & WS_FIELD_HARDWARE) {
+            doc["hardware"]["sensor_available"] = (snapshot.flags & TELEMETRY_FLAG_SENSOR_AVAILABLE) != 0;
+            doc["hardware"]["bluetooth_connected"] = (snapshot.flags & TELEMETRY_FLAG_BT_CONNECTED) != 0;
+            doc["hardware"]["bluetooth_advertising"] = (snapshot.flags & TELEMETRY_FLAG_BT_ADVERTISING) != 0;
+            doc["hardware"]["bluetooth_last_event"] = snapshot.bleEvent;
+            doc["hardware"]["bluetooth_last_event_age_ms"] = snapshot.bleEventAgeMs;
+        }
+
+        deliver(serializeToPool(doc), false, due, dueCount, fields);
+    }
+
+    updateClientRates(due, dueCount);
+    // The pool keeps payloads off the heap, but AsyncWebSocket still allocates a
+    // message and a queue node per client per frame; report what that costs
+    _lastBroadcastHeap = (int32_t)(freeBefore - heap_caps_get_free_size(MALLOC_CAP_8BIT));
+    _perf.recordCycles(PerfStage::BROADCAST, start);
+}
+
+AsyncWebSocketMessageBuffer* WebManager::serializeToPool(JsonDocument& doc) {
+    size_t len = measureJson(doc);
+    AsyncWebSocketMessageBuffer* buffer = _bufferPool.acquire(len);
+    if (!buffer) {
+        return nullptr;
+    }
+
+    // Serialize straight into the shared buffer; JSON allows trailing whitespace
+    char* out = (char*)buffer->get();
+    serializeJson(doc, out, buffer->length() + 1);
+    memset(out + len, ' ', buffer->length() - len);
+    return buffer;
+}
+
+void WebManager::broadcastTelemetry() {
+    uint32_t now = millis();
+    DueClient due[WS_MAX_CLIENTS];
+    int dueCount = collectDueClients(true, now, due);
+    if (dueCount == 0) {
+        return;
+    }
+
+    TelemetrySnapshot snapshot = captureSnapshot(now);
+
+    // Text fields change rarely; only spend bytes on them about once a second
+    bool slowSections = now - _lastSlowSectionMs >= TELEMETRY_SLOW_SECTION_MS;
+    if (slowSections) {
+        _lastSlowSectionMs = now;
+    }
+
+    for (int i = 0; i < dueCount; i++) {
+        if (due[i].handled) continue;
+        uint8_t fields = due[i].fields;
+
+        // Position, sensors and flags are in the fixed struct; fields select the sections
+        TelemetrySnapshot view = snapshot;
+        view.attitudeValid = snapshot.attitudeValid && (fields & WS_FIELD_ATTITUDE);
+        if (!slowSections || !(fields & WS_FIELD_HARDWARE)) {
+            view.bleEvent = nullptr;
+        }
+
+        uint8_t frame[TELEMETRY_MAX_FRAME];
+        size_t len = _telemetryEncoder.encodeStatus(view, frame);
+        AsyncWebSocketMessageBuffer* buffer = _bufferPool.acquire(len, TELEMETRY_FRAME_SIZE_CLASS);
+        if (buffer) {
+            memcpy(buffer->get(), frame, len);
+            memset(buffer->get() + len, TELEMETRY_SECTION_END, buffer->length() - len);
+        }
+        deliver(buffer, true, due, dueCount, fields);
+    }
+
+    updateClientRates(due, dueCount);
+}
+
+void WebManager::fillPerf(JsonObject perf) {
+    perf["cpu_mhz"] = getCpuFrequencyMhz();
+
+    JsonObject heap = perf.createNestedObject("heap");
+    heap["free"] = ESP.getFreeHeap();
+    heap["min_free"] = ESP.getMinFreeHeap();
+    heap["largest_block"] = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+    heap["ws_pool_allocs"] = _bufferPool.getAllocationCount();
+    heap["ws_pool_exhausted"] = _bufferPool.getExhaustedCount();
+    heap["ws_broadcast_heap"] = _lastBroadcastHeap;
+
+    CommandStats commands = _gimbalController.getCommandStats();
+    JsonObject cmd = perf.createNestedObject("commands");
+    cmd["posted"] = commands.posted;
+    cmd["superseded"] = commands.superseded;
+    cmd["dropped"] = commands.dropped;
+
+    ConfigPersistStats persist = _configManager.getPersistStats();
+    JsonObject cfg = perf.createNestedObject("config");
+    cfg["save_requests"] = persist.requested;
+    cfg["writes"] = persist.written;
+    cfg["write_failures"] = persist.failed;
+    cfg["last_write_ms"] = persist.lastWriteMs;
+    cfg["pending"] = persist.pending;
+
+    JsonObject stack = perf.createNestedObject("stack");
+    stack["control_size"] = CONTROL_TASK_STACK;
+    stack["control_free_min"] = _controlTask.getStackHighWaterMark();
+
+    JsonObject log = perf.createNestedObject("log");
+    log["written"] = eventLog.getWrittenCount();
+    log["dropped"] = eventLog.getDroppedCount();
+    log["ws_skipped"] = _logLinesSkipped;
+
+    WsClient clients[WS_MAX_CLIENTS];
+    xSemaphoreTake(_clientsMutex, portMAX_DELAY);
+    memcpy(clients, _clients, sizeof(clients));
+    xSemaphoreGive(_clientsMutex);
+
+    JsonArray clientStats = perf.createNestedArray("clients");
+    for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+        if (clients[i].id == 0) continue;
+        JsonObject c = clientStats.createNestedObject();
+        c["id"] = clients[i].id;
+        c["binary"] = clients[i].binary;
+        c["fields"] = clients[i].fields;
+        c["requested_hz"] = 1000 / clients[i].requestedIntervalMs;
+        c["effective_hz"] = 1000.0f / clients[i].intervalMs;
+        c["sent"] = clients[i].sent;
+        c["skipped"] = clients[i].skipped;
+    }
+
+    JsonObject stages = perf.createNestedObject("stages");
+    for (int i = 0; i < (int)PerfStage::COUNT; i++) {
+        PerfStage stage = (PerfStage)i;
+        LatencyStats stats = _perf.getStats(stage);
+        JsonObject s = stages.createNestedObject(PerfMonitor::stageName(stage));
+        s["count"] = stats.count;
+        s["min_us"] = stats.min;
+        s["p50_us"] = stats.p50;
+        s["p99_us"] = stats.p99;
+        s["max_us"] = stats.max;
+        s["deadline_us"] = stats.deadline;
+        s["missed"] = stats.missedDeadlines;
+    }
+}
+
+void WebManager::broadcastPerf() {
+    uint32_t ids[WS_MAX_CLIENTS];
+    int count = 0;
+    xSemaphoreTake(_clientsMutex, portMAX_DELAY);
+    for (int i = 0; i < WS_MAX_CLIENTS; i++) {
+        if (_clients[i].id != 0) ids[count++] = _clients[i].id;
+    }
+    xSemaphoreGive(_clientsMutex);
+    if (count == 0) {
+        return;
+    }
+
+    StaticJsonDocument<3072> doc;
+    doc["type"] = "perf";
+    fillPerf(doc.createNestedObject("perf"));
+
+    AsyncWebSocketMessageBuffer* buffer = serializeToPool(doc);
+    if (!buffer) {
+        return;
+    }
+    for (int i = 0; i < count; i++) {
+        AsyncWebSocketClient* client = _ws.client(ids[i]);
+        if (!client || !clientCanTake(client, buffer->length())) {
+            continue;
+        }
+        AsyncWebSocketMessageBuffer* own = _bufferPool.acquireFor(buffer);
+        if (own) {
+            client->text(own);
+        }
+    }
 }
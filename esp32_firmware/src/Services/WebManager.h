@@ -3,8 +3,15 @@
 #include <AsyncTCP.h>
 #include <LittleFS.h>
 #include <ArduinoJson.h>
+#include <atomic>
 #include "ConfigManager.h"
+#include "ControlTask.h"
+#include "PerfMonitor.h"
+#include "SequenceStore.h"
+#include "TelemetryProtocol.h"
+#include "WsBufferPool.h"
 #include "../Domain/GimbalController.h"
+#include "../Domain/KernelBenchmark.h"
 #include "../Infrastructure/SensorManager.h"
 
 // Forward declaration
@@ -12,20 +19,89 @@ class BluetoothManager;
 
 class WebManager {
 public:
-    WebManager(ConfigManager& configManager, GimbalController& gimbalController, SensorManager& sensorManager);
+    WebManager(ConfigManager& configManager, GimbalController& gimbalController, SensorManager& sensorManager,
+               PerfMonitor& perfMonitor, SequenceStore& sequenceStore, ControlTask& controlTask);
     void begin();
     void handle();
-    void broadcastStatus();
+    // Call every loop(); each client is served at its own subscribed rate
+    void broadcastStatus();    // JSON clients
+    void broadcastTelemetry(); // Binary clients
+    void broadcastPerf();
     void setBluetoothManager(BluetoothManager* bluetoothManager);
+    // From the log task: one formatted line to every /ws/log client
+    void sendLogLine(const char* line, size_t len);
 
 private:
     ConfigManager& _configManager;
     GimbalController& _gimbalController;
     SensorManager& _sensorManager;
+    PerfMonitor& _perf;
+    SequenceStore& _sequenceStore;
+    ControlTask& _controlTask;
     BluetoothManager* _bluetoothManager;
     AsyncWebServer _server;
     AsyncWebSocket _ws;
+    AsyncWebSocket _logWs;
+
+    // Per-connection subscription, keyed by AsyncWebSocketClient::id().
+    // Written from the AsyncTCP task, read from loop(), so guarded by _clientsMutex.
+    struct WsClient {
+        uint32_t id;                  // 0 = free slot
+        bool binary;
+        uint8_t fields;               // WS_FIELD_* the client subscribed to
+        uint32_t requestedIntervalMs;
+        uint32_t intervalMs;          // Effective; stretched while the client is backed up
+        uint32_t lastSentMs;
+        uint16_t skipStreak;
+        uint16_t sendStreak;
+        uint32_t sent;
+        uint32_t skipped;             // Frames dropped because the client was backed up
+    };
+    WsClient _clients[WS_MAX_CLIENTS];
+    SemaphoreHandle_t _clientsMutex;
+    TelemetryEncoder _telemetryEncoder;
+    uint32_t _lastSlowSectionMs;
+    WsBufferPool _bufferPool;
+    int32_t _lastBroadcastHeap;    // Free-heap drop across the last broadcastStatus(), in bytes
+    uint32_t _logLinesSkipped;     // Log lines not sent because a /ws/log client was backed up
+
+    // Kernel benchmark. It runs in a one-shot low-priority task so the web
+    // task keeps serving; the task fills in the result before setting DONE.
+    enum KernelBenchState : uint8_t { KERNEL_BENCH_IDLE, KERNEL_BENCH_RUNNING, KERNEL_BENCH_DONE };
+    std::atomic<uint8_t> _kernelBenchState;
+    uint32_t _kernelBenchIterations;
+    PIDShaping _kernelBenchShaping;
+    PidGains _kernelBenchGains[AXIS_COUNT];
+    KernelBenchmarkResult _kernelBenchResult;
+
+    // A client whose frame is due this tick
+    struct DueClient {
+        uint32_t id;
+        uint8_t fields;
+        bool handled;
+        bool sent;
+    };
 
     void onWebSocketEvent(AsyncWebSocket *server, AsyncWebSocketClient *client, AwsEventType type, void *arg, uint8_t *data, size_t len);
-    void handleWebSocketMessage(void *arg, uint8_t *data, size_t len);
+    void handleWebSocketMessage(AsyncWebSocketClient *client, void *arg, uint8_t *data, size_t len);
+    void handleHello(AsyncWebSocketClient *client, JsonDocument& doc);
+    bool addClient(uint32_t id);
+    void removeClient(uint32_t id);
+    static uint8_t parseFields(JsonVariant fields);
+
+    int collectDueClients(bool binary, uint32_t now, DueClient* out);
+    bool clientCanTake(AsyncWebSocketClient* client, size_t len);
+    void deliver(AsyncWebSocketMessageBuffer* buffer, bool binary, DueClient* due, int count, uint8_t fields);
+    void updateClientRates(const DueClient* due, int count);
+    TelemetrySnapshot captureSnapshot(uint32_t now);
+    AsyncWebSocketMessageBuffer* serializeToPool(JsonDocument& doc);
+    void fillPerf(JsonObject perf);
+    void sendCalibrationStatus(AsyncWebServerRequest* request, const char* result);
+    void sendSelfTestStatus(AsyncWebServerRequest* request);
+    void sendAutotuneStatus(AsyncWebServerRequest* request, AutotuneRule rule);
+    void sendImuStatus(AsyncWebServerRequest* request, const char* result);
+    void sendRecorderStatus(AsyncWebServerRequest* request, const char* result);
+    bool startKernelBenchmark(uint32_t iterations);
+    static void kernelBenchEntry(void* param);
+    void sendKernelBenchStatus(AsyncWebServerRequest* request, int code);
 };
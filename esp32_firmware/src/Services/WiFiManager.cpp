@@ -1,5 +1,6 @@
 #include "WiFiManager.h"
 #include "config.h"
+#include "../Domain/EventLog.h"
 
 WiFiManagerService::WiFiManagerService(ConfigManager& configManager) : _configManager(configManager) {}
 
@@ -55,8 +56,14 @@ void WiFiManagerService::begin() {
 void WiFiManagerService::handle() {
     // Reconnection logic could go here
     if (!_isAPMode && WiFi.status() != WL_CONNECTED) {
-        Serial.println("WiFi Lost, reconnecting...");
+        if (!_reconnecting) {
+            LOG_WARN(LOG_WIFI_LOST); // Once per outage, not every loop()
+            _reconnecting = true;
+        }
         WiFi.reconnect();
+    } else if (_reconnecting) {
+        LOG_INFO(LOG_WIFI_RECONNECTED);
+        _reconnecting = false;
     }
 }
 
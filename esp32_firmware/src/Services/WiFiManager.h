@@ -13,4 +13,5 @@ public:
 private:
     ConfigManager& _configManager;
     bool _isAPMode = false;
+    bool _reconnecting = false; // Station link lost and not back yet
 };
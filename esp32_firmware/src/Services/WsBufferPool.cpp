@@ -0,0 +1,68 @@
+#include "WsBufferPool.h"
+#include <atomic>
+#include <string.h>
+
+WsBufferPool::WsBufferPool()
+    : _buffers(),
+      _allocations(0),
+      _exhausted(0)
+{}
+
+WsBufferPool::~WsBufferPool() {
+    for (int i = 0; i < WS_BUFFER_POOL_SIZE; i++) {
+        delete _buffers[i];
+    }
+}
+
+void WsBufferPool::begin() {
+    for (int i = 0; i < WS_BUFFER_POOL_SIZE; i++) {
+        if (!_buffers[i]) {
+            _buffers[i] = new AsyncWebSocketMessageBuffer(WS_BUFFER_SIZE_CLASS);
+        }
+    }
+}
+
+AsyncWebSocketMessageBuffer* WsBufferPool::acquire(size_t len, size_t sizeClass) {
+    size_t size = roundUp(len, sizeClass);
+    AsyncWebSocketMessageBuffer* spare = nullptr;
+
+    for (int i = 0; i < WS_BUFFER_POOL_SIZE; i++) {
+        AsyncWebSocketMessageBuffer* buffer = _buffers[i];
+        if (!buffer || buffer->count() != 0) {
+            continue; // Still queued to its client
+        }
+        // Order the caller's writes after the AsyncTCP task's last read of the frame
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (buffer->length() == size) {
+            return buffer;
+        }
+        if (!spare) {
+            spare = buffer;
+        }
+    }
+
+    if (!spare) {
+        _exhausted++;
+        return nullptr;
+    }
+
+    // No free buffer of this size class; resize one (the only heap allocation)
+    if (!spare->reserve(size)) {
+        return nullptr;
+    }
+    _allocations++;
+    return spare;
+}
+
+AsyncWebSocketMessageBuffer* WsBufferPool::acquireFor(AsyncWebSocketMessageBuffer* frame) {
+    if (frame->count() == 0) {
+        return frame;
+    }
+
+    // Already a multiple of its size class, so ask for exactly that length
+    AsyncWebSocketMessageBuffer* copy = acquire(frame->length(), 1);
+    if (copy && copy != frame) {
+        memcpy(copy->get(), frame->get(), frame->length());
+    }
+    return copy;
+}
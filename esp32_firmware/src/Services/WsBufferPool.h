@@ -0,0 +1,48 @@
+#pragma once
+#include <ESPAsyncWebServer.h>
+#include "config.h"
+
+// Preallocated WebSocket payload buffers.
+// A frame is serialized once into a pooled AsyncWebSocketMessageBuffer and
+// copied into another pooled buffer for each further client, so broadcasting
+// neither builds a String nor allocates payload memory in steady state. Buffers
+// are not created with AsyncWebSocket::makeBuffer(), so the library never frees
+// them; a buffer is reused once the client queue that held it has sent it
+// (count() == 0).
+//
+// The library's reference count is a plain counter: the loop task raises it
+// when a frame is queued and the AsyncTCP task lowers it when the frame is sent.
+// Sharing one buffer between clients would let those updates overlap and lose
+// one, leaking the buffer or rewriting it while still queued. Queueing each
+// buffer to exactly one client keeps the count at 0 or 1, written by one task
+// at a time, and acquire() only runs on the loop task.
+//
+// AsyncWebSocketMessageBuffer cannot shrink without reallocating, so buffer
+// lengths are rounded up to a size class and callers pad the tail
+// (spaces for JSON, zero bytes for binary frames). Payloads of a steady size
+// keep landing in the same class and reuse a buffer without reallocating.
+class WsBufferPool {
+public:
+    WsBufferPool();
+    ~WsBufferPool();
+    void begin();
+
+    // Free buffer whose length() is len rounded up to sizeClass, or nullptr
+    // if every buffer is still queued to a client.
+    AsyncWebSocketMessageBuffer* acquire(size_t len, size_t sizeClass = WS_BUFFER_SIZE_CLASS);
+    // Buffer to queue frame to one more client: frame itself until it is queued,
+    // then a pooled copy. nullptr if the pool is exhausted.
+    AsyncWebSocketMessageBuffer* acquireFor(AsyncWebSocketMessageBuffer* frame);
+
+    uint32_t getAllocationCount() const { return _allocations; } // Buffer (re)allocations since boot
+    uint32_t getExhaustedCount() const { return _exhausted; }     // acquire() calls with no free buffer
+
+    static size_t roundUp(size_t len, size_t sizeClass) {
+        return (len + sizeClass - 1) / sizeClass * sizeClass;
+    }
+
+private:
+    AsyncWebSocketMessageBuffer* _buffers[WS_BUFFER_POOL_SIZE];
+    uint32_t _allocations;
+    uint32_t _exhausted;
+};
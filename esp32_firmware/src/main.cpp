@@ -4,6 +4,11 @@
 #include "Services/WebManager.h"
 #include "Services/BluetoothManager.h"
 #include "Services/LEDStatusManager.h"
+#include "Services/LogTask.h"
+#include "Services/ControlTask.h"
+#include "Services/PerfMonitor.h"
+#include "Services/SequenceStore.h"
+#include "Domain/EventLog.h"
 #include "Domain/GimbalController.h"
 #include "Infrastructure/SensorManager.h"
 #include "config.h"
@@ -13,9 +18,13 @@ ConfigManager configManager;
 WiFiManagerService wifiManager(configManager);
 SensorManager sensorManager;
 GimbalController gimbalController(configManager);
-WebManager webManager(configManager, gimbalController, sensorManager);
+PerfMonitor perfMonitor;
+SequenceStore sequenceStore(gimbalController);
+ControlTask controlTask(configManager, sensorManager, gimbalController, perfMonitor);
+WebManager webManager(configManager, gimbalController, sensorManager, perfMonitor, sequenceStore, controlTask);
 BluetoothManager bluetoothManager(gimbalController);
 LEDStatusManager ledStatus;
+LogTask logTask(eventLog);
 
 // Button state tracking
 unsigned long buttonPressStart = 0;
@@ -71,15 +80,15 @@ void handleButton() {
             longPressHandled = false;
         } else if (!longPressHandled && (currentTime - buttonPressStart) >= BUTTON_LONG_PRESS_MS) {
             // Long press detected
-            Serial.println("Long press detected - Running self-test");
-            gimbalController.runSelfTest();
+            LOG_INFO(LOG_BUTTON_SELF_TEST);
+            gimbalController.startSelfTest();
             longPressHandled = true;
         }
     } else {
         if (buttonPressed && !longPressHandled) {
             // Button released after short press
             if ((currentTime - buttonPressStart) >= BUTTON_DEBOUNCE_MS) {
-                Serial.println("Short press detected - Setting flat reference");
+                LOG_INFO(LOG_BUTTON_FLAT_REFERENCE);
                 gimbalController.setFlatReference();
             }
         }
@@ -87,6 +96,29 @@ void handleButton() {
     }
 }
 
+// The self-test runs in the control task; report it once it has finished
+void reportSelfTest() {
+    static bool wasActive = false;
+    bool active = gimbalController.getState().selfTestActive;
+    if (wasActive && !active) {
+        SelfTestStatus status = gimbalController.getSelfTestStatus();
+        LOG_INFO(LOG_SELF_TEST_DONE, status.result.complete ? "complete" : "cancelled", status.result.duration);
+        for (int i = 0; i < AXIS_COUNT; i++) {
+            const AxisStepResult& r = status.result.axes[i];
+            if (!r.tested) continue;
+            if (!r.measured) {
+                LOG_INFO(LOG_SELF_TEST_NO_ATTITUDE, AXIS_NAMES[i]);
+            } else if (!r.responded) {
+                LOG_WARN(LOG_SELF_TEST_NO_RESPONSE, AXIS_NAMES[i], r.gain);
+            } else {
+                LOG_INFO(LOG_SELF_TEST_AXIS, AXIS_NAMES[i], r.gain, r.riseTime * 1000.0f, r.settlingTime * 1000.0f,
+                         r.overshootPct);
+            }
+        }
+    }
+    wasActive = active;
+}
+
 void setup() {
     Serial.begin(115200);
     delay(100); // Give serial time to initialize
@@ -121,6 +153,13 @@ void setup() {
         ledStatus.setStatus(LEDStatus::OK); // Green for all systems operational
     }
     
+    // Run-time messages are queued and written out by the log task, which
+    // also appends to a file, so it starts once LittleFS is mounted
+    logTask.begin();
+
+    // Stored motion sequences (LittleFS is mounted by the config system)
+    sequenceStore.begin();
+
     // Initialize WiFi
     wifiManager.begin();
     
@@ -133,16 +172,25 @@ void setup() {
     // Connect Bluetooth Manager to Web Manager
     webManager.setBluetoothManager(&bluetoothManager);
 
+    // Stream log lines to /ws/log
+    logTask.setWebManager(&webManager);
+
+    // Start the real-time control loop (sensor, PID and servos)
+    if (!controlTask.begin(CONTROL_LOOP_RATE_HZ)) {
+        Serial.println("CRITICAL: Control task failed to start!");
+        ledStatus.setStatus(LEDStatus::ERROR);
+    }
+
     Serial.println("System Ready!");
 }
 
 void loop() {
+    // Only non-real-time services run here; sensing and servo control live
+    // in ControlTask so network hiccups cannot disturb stabilization.
     unsigned long currentTime = millis();
-    static unsigned long lastSensorUpdate = 0;
-    static unsigned long lastServoUpdate = 0;
-    static unsigned long lastWSUpdate = 0;
     static unsigned long lastButtonCheck = 0;
     static unsigned long lastBTUpdate = 0;
+    static unsigned long lastPerfUpdate = 0;
     
     // Update LED status (handles flashing)
     ledStatus.update();
@@ -154,45 +202,18 @@ void loop() {
     // Handle button input
     if (currentTime - lastButtonCheck >= 10) { // Check button every 10ms
         handleButton();
+        reportSelfTest();
         lastButtonCheck = currentTime;
     }
     
-    // Update Sensors
-    if (currentTime - lastSensorUpdate >= SENSOR_UPDATE_RATE) {
-        if (hwStatus.sensorAvailable) {
-            sensorManager.update();
-        }
-        lastSensorUpdate = currentTime;
-    }
-    
-    // Update Servos / Control Loop
-    if (currentTime - lastServoUpdate >= SERVO_UPDATE_RATE) {
-        // Initialize lastServoUpdate on first use to avoid a large initial dt
-        float dt;
-        if (lastServoUpdate == 0) {
-            dt = SERVO_UPDATE_RATE / 1000.0; // Use the expected update rate for first iteration
-        } else {
-            dt = (currentTime - lastServoUpdate) / 1000.0;
-        }
+    // WebSocket status; each client is paced by its own subscription
+    webManager.broadcastStatus();
+    webManager.broadcastTelemetry();
 
-        // Get Gyro Data for PID (Simplified)
-        // Note: gyro returns rad/s. Multiply by dt to get delta angle in radians.
-        // Convert to degrees for consistency with servo (0-180).
-        float gyroYaw = 0, gyroPitch = 0, gyroRoll = 0;
-        if (hwStatus.sensorAvailable) {
-            gyroYaw = sensorManager.getGyroYaw() * dt * 57.2958;
-            gyroPitch = sensorManager.getGyroPitch() * dt * 57.2958;
-            gyroRoll = sensorManager.getGyroRoll() * dt * 57.2958;
-        }
-
-        gimbalController.update(dt, gyroYaw, gyroPitch, gyroRoll);
-        lastServoUpdate = currentTime;
-    }
-    
-    // WebSocket Broadcast
-    if (currentTime - lastWSUpdate >= WEBSOCKET_UPDATE_RATE) {
-        webManager.broadcastStatus();
-        lastWSUpdate = currentTime;
+    // Latency histograms for the web UI
+    if (currentTime - lastPerfUpdate >= PERF_BROADCAST_INTERVAL_MS) {
+        webManager.broadcastPerf();
+        lastPerfUpdate = currentTime;
     }
     
     // Bluetooth Status Update